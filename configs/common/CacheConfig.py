@@ -42,6 +42,7 @@
 
 import m5
 from m5.objects import *
+from m5.util import warn
 from gem5.isas import ISA
 from gem5.runtime import get_runtime_isa
 
@@ -105,6 +106,77 @@ def _get_cache_opts(level, options):
     return opts
 
 
+def _config_warm_checkpoints(options, system):
+    # caches checkpoint their contents, and the snoop filters the lines
+    # they track, so that restored caches are warm
+    if not getattr(options, "warm_cache_checkpoints", False):
+        return
+    for obj in system.descendants():
+        if isinstance(obj, (BaseCache, SnoopFilter)):
+            obj.checkpoint_contents = True
+
+
+def _config_prefetch_warming(options, system):
+    # atomic accesses train the prefetchers during fast-forward
+    if not getattr(options, "prefetch_warming", False):
+        return
+    for obj in system.descendants():
+        if isinstance(obj, BaseCache):
+            obj.prefetch_warming = True
+
+
+def _config_prefetch_issue(options, system):
+    # prefetch issue arbitration of every cache
+    batch = getattr(options, "prefetch_issue_batch", None)
+    share = getattr(options, "prefetch_mshr_share", None)
+    for obj in system.descendants():
+        if isinstance(obj, BaseCache):
+            if batch is not None:
+                obj.prefetch_issue_batch = batch
+            if share is not None:
+                obj.prefetch_mshr_share = share
+
+
+def _partitioned(options):
+    return getattr(options, "partition_eventqs", "off") != "off"
+
+
+def _connect_partition(
+    options, cpu, i, cached_ports, cached_in, uncached_in, uncached_out
+):
+    # the core and its private caches are the partition of event queue
+    # i + 1, which reaches the shared memory system on event queue 0
+    # through QuantumBridges; the single mode keeps the bridges, and so
+    # the timing, on event queue 0
+    core_eventq = i + 1 if options.partition_eventqs == "parallel" else 0
+    cpu.eventq_index = core_eventq
+
+    def bridge(mem_side_eventq, cpu_side_eventq):
+        return QuantumBridge(
+            eventq_index=mem_side_eventq,
+            cpu_side_eventq_index=cpu_side_eventq,
+            delay=options.partition_quantum,
+        )
+
+    bridges = []
+    for p in cached_ports:
+        b = bridge(0, core_eventq)
+        exec("cpu.%s = b.cpu_side_port" % p)
+        b.mem_side_port = cached_in
+        bridges.append(b)
+    for p in cpu._uncached_interrupt_request_ports:
+        b = bridge(0, core_eventq)
+        exec("cpu.%s = b.cpu_side_port" % p)
+        b.mem_side_port = uncached_in
+        bridges.append(b)
+    for p in cpu._uncached_interrupt_response_ports:
+        b = bridge(core_eventq, 0)
+        exec("cpu.%s = b.mem_side_port" % p)
+        b.cpu_side_port = uncached_out
+        bridges.append(b)
+    cpu.partition_bridges = bridges
+
+
 def config_cache(options, system):
     if options.external_memory_system and (options.caches or options.l2cache):
         print("External caches and internal caches are exclusive options.\n")
@@ -224,19 +296,19 @@ def config_cache(options, system):
                 system.cpu[i].dcache.prefetcher.degree = getattr(options, "stride_degree", 4)
                 system.cpu[i].dcache.prefetcher.stream_ahead_dist = getattr(options, "dmp_stream_ahead_dist", 64)
                 system.cpu[i].dcache.prefetcher.indir_range = getattr(options, "dmp_indir_range", 4)
+                system.cpu[i].dcache.prefetcher.chain_depth = getattr(options, "dmp_chain_depth", 3)
+                system.cpu[i].dcache.prefetcher.notify_latency = getattr(options, "dmp_notify_latency", 0)
+                system.cpu[i].dcache.prefetcher.match_width = getattr(options, "dmp_match_width", 0)
+                system.cpu[i].dcache.prefetcher.pf_gen_width = getattr(options, "dmp_pf_gen_width", 0)
 
                 # system.l2.prefetcher.queue_size = 1024*1024*16
                 # system.l2.prefetcher.max_prefetch_requests_with_pending_translation = 1024
                 system.l2.prefetcher.queue_size = 64
                 system.l2.prefetcher.max_prefetch_requests_with_pending_translation = 64
 
-                if options.dmp_init_bench:
-                    system.cpu[i].dcache.prefetcher.index_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][0]
-                    system.cpu[i].dcache.prefetcher.target_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][1]
-                    system.cpu[i].dcache.prefetcher.range_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][2]
+                if options.dmp_hint_file:
+                    system.cpu[i].dcache.prefetcher.hint_file = options.dmp_hint_file
+                system.cpu[i].dcache.prefetcher.record_hints = options.dmp_record_hints
 
             # enable VA for all prefetcher
             if options.l1d_hwp_type:
@@ -278,6 +350,9 @@ def config_cache(options, system):
         if options.tlb_size:
             system.cpu[i].mmu.dtb.size = getattr(options, "tlb_size", 64)
             system.cpu[i].mmu.stage2_dtb.size = getattr(options, "tlb_size", 64) // 2
+        if getattr(options, "tlb_assoc", 0):
+            system.cpu[i].mmu.dtb.assoc = options.tlb_assoc
+            system.cpu[i].mmu.dtb.replacement_policy = LRURP()
 
         system.cpu[i].mmu.dtb.can_serialize = True
 
@@ -286,7 +361,7 @@ def config_cache(options, system):
 
         system.cpu[i].createInterruptController()
         if options.l2cache:
-            assert(i==0) # only support single core 
+            # the shared L2 DMP observes every core, helpers are per core
             if options.l2_hwp_type == "StridePrefetcher":
                 system.l2.prefetcher.degree = getattr(options, "stride_degree", 4)
 
@@ -302,15 +377,27 @@ def config_cache(options, system):
                 if options.dmp_notify == "l2":
                     system.l2.prefetcher.set_probe_obj(system.cpu[i].dcache, system.l2, system.l2)
 
-                if options.l1d_hwp_type == "StridePrefetcher":
+                if options.l1d_hwp_type == "StridePrefetcher" and \
+                        _partitioned(options):
+                    # the helpers are called directly, across partitions
+                    warn("L1 StridePrefetcher of cpu%d is no L2 DMP helper "
+                         "with --partition-eventqs." % i)
+                    system.l2.prefetcher.degree = getattr(options, "stride_degree", 4)
+                elif options.l1d_hwp_type == "StridePrefetcher":
                     print("Add L1 StridePrefetcher as L2 DMP helper.")
-                    system.l2.prefetcher.set_pf_helper(system.cpu[i].dcache.prefetcher)
+                    system.l2.prefetcher.set_pf_helper(
+                        system.cpu[i].dcache.prefetcher, i
+                    )
                 else:
                     system.l2.prefetcher.degree = getattr(options, "stride_degree", 4)
 
                 system.l2.prefetcher.stream_ahead_dist = getattr(options, "dmp_stream_ahead_dist", 64)
                 system.l2.prefetcher.range_ahead_dist = getattr(options, "dmp_range_ahead_dist", 0)
                 system.l2.prefetcher.indir_range = getattr(options, "dmp_indir_range", 4)
+                system.l2.prefetcher.chain_depth = getattr(options, "dmp_chain_depth", 3)
+                system.l2.prefetcher.notify_latency = getattr(options, "dmp_notify_latency", 0)
+                system.l2.prefetcher.match_width = getattr(options, "dmp_match_width", 0)
+                system.l2.prefetcher.pf_gen_width = getattr(options, "dmp_pf_gen_width", 0)
 
                 system.l2.prefetcher.auto_detect = True
 
@@ -319,13 +406,9 @@ def config_cache(options, system):
                 system.l2.prefetcher.queue_size = 64
                 system.l2.prefetcher.max_prefetch_requests_with_pending_translation = 64
 
-                if options.dmp_init_bench:
-                    system.l2.prefetcher.index_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][0]
-                    system.l2.prefetcher.target_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][1]
-                    system.l2.prefetcher.range_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][2]
+                if options.dmp_hint_file:
+                    system.l2.prefetcher.hint_file = options.dmp_hint_file
+                system.l2.prefetcher.record_hints = options.dmp_record_hints
 
             # enable VA for all prefetcher
             if options.l2_hwp_type:
@@ -335,17 +418,29 @@ def config_cache(options, system):
                 system.l2.prefetcher.stats_pc_list = monitor_pc_list 
                 # system.l2.prefetcher.latency = 15
                 system.l2.prefetcher.latency = 17
-                if system.cpu[i].mmu.dtb:
+                # a prefetcher holds a single TLB, use the one of core 0
+                if i == 0 and system.cpu[i].mmu.dtb:
                     print("Adding DTLB to L2 prefetcher.")
                     system.l2.prefetcher.registerTLB(system.cpu[i].mmu.dtb)
 
             system.l2.stats_pc_list = monitor_pc_list
 
-            system.cpu[i].connectAllPorts(
-                system.tol2bus.cpu_side_ports,
-                system.membus.cpu_side_ports,
-                system.membus.mem_side_ports,
-            )
+            if _partitioned(options):
+                _connect_partition(
+                    options,
+                    system.cpu[i],
+                    i,
+                    system.cpu[i]._cached_ports,
+                    system.tol2bus.cpu_side_ports,
+                    system.membus.cpu_side_ports,
+                    system.membus.mem_side_ports,
+                )
+            else:
+                system.cpu[i].connectAllPorts(
+                    system.tol2bus.cpu_side_ports,
+                    system.membus.cpu_side_ports,
+                    system.membus.mem_side_ports,
+                )
         elif options.external_memory_system:
             system.cpu[i].connectUncachedPorts(
                 system.membus.cpu_side_ports, system.membus.mem_side_ports
@@ -353,6 +448,10 @@ def config_cache(options, system):
         else:
             system.cpu[i].connectBus(system.membus)
 
+    _config_warm_checkpoints(options, system)
+    _config_prefetch_warming(options, system)
+    _config_prefetch_issue(options, system)
+
     return system
 
 def config_three_level_cache(options, system):
@@ -438,6 +537,9 @@ def config_three_level_cache(options, system):
         if options.tlb_size:
             system.cpu[i].mmu.dtb.size = getattr(options, "tlb_size", 64)
             system.cpu[i].mmu.stage2_dtb.size = getattr(options, "tlb_size", 64) // 2
+        if getattr(options, "tlb_assoc", 0):
+            system.cpu[i].mmu.dtb.assoc = options.tlb_assoc
+            system.cpu[i].mmu.dtb.replacement_policy = LRURP()
 
         system.cpu[i].mmu.dtb.can_serialize = True
 
@@ -458,21 +560,23 @@ def config_three_level_cache(options, system):
                 system.cpu[i].l2.prefetcher.degree = getattr(options, "stride_degree", 4)
 
             if options.l2_hwp_type == "DiffMatchingPrefetcher":
-                system.cpu[i].l2.prefetcher.set_probe_obj(system.cpu[i].dcache, system.cpu[i].l2)
+                system.cpu[i].l2.prefetcher.set_probe_obj(
+                    system.cpu[i].dcache, system.cpu[i].l2, system.cpu[i].l2
+                )
                 system.cpu[i].l2.prefetcher.degree = getattr(options, "stride_degree", 4)
 
                 system.cpu[i].l2.prefetcher.stream_ahead_dist = getattr(options, "dmp_stream_ahead_dist", 64)
                 system.cpu[i].l2.prefetcher.indir_range = getattr(options, "dmp_indir_range", 4)
+                system.cpu[i].l2.prefetcher.chain_depth = getattr(options, "dmp_chain_depth", 3)
+                system.cpu[i].l2.prefetcher.notify_latency = getattr(options, "dmp_notify_latency", 0)
+                system.cpu[i].l2.prefetcher.match_width = getattr(options, "dmp_match_width", 0)
+                system.cpu[i].l2.prefetcher.pf_gen_width = getattr(options, "dmp_pf_gen_width", 0)
                 #system.l2.prefetcher.queue_size = 1024*1024*16
                 #system.l2.prefetcher.max_prefetch_requests_with_pending_translation = 1024
 
-                if options.dmp_init_bench:
-                    system.cpu[i].l2.prefetcher.index_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][0]
-                    system.cpu[i].l2.prefetcher.target_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][1]
-                    system.cpu[i].l2.prefetcher.range_pc_init = \
-                        ObjectList.dmp_bench_init_pc[ObjectList.dmp_bench_list[options.dmp_init_bench]][2]
+                if options.dmp_hint_file:
+                    system.cpu[i].l2.prefetcher.hint_file = options.dmp_hint_file
+                system.cpu[i].l2.prefetcher.record_hints = options.dmp_record_hints
                 
 
 
@@ -485,17 +589,37 @@ def config_three_level_cache(options, system):
 
             system.cpu[i].tol2bus = L2XBar(clk_domain=system.cpu_clk_domain)
             system.cpu[i].l2.cpu_side = system.cpu[i].tol2bus.mem_side_ports
-            system.cpu[i].l2.mem_side = system.tol3bus.cpu_side_ports
 
-            system.cpu[i].connectAllPorts(
-                system.cpu[i].tol2bus.cpu_side_ports,
-                system.membus.cpu_side_ports,
-                system.membus.mem_side_ports
-            )
+            if _partitioned(options):
+                # the private L2 is in the partition of its core
+                system.cpu[i].connectCachedPorts(
+                    system.cpu[i].tol2bus.cpu_side_ports
+                )
+                _connect_partition(
+                    options,
+                    system.cpu[i],
+                    i,
+                    ["l2.mem_side"],
+                    system.tol3bus.cpu_side_ports,
+                    system.membus.cpu_side_ports,
+                    system.membus.mem_side_ports,
+                )
+            else:
+                system.cpu[i].l2.mem_side = system.tol3bus.cpu_side_ports
+
+                system.cpu[i].connectAllPorts(
+                    system.cpu[i].tol2bus.cpu_side_ports,
+                    system.membus.cpu_side_ports,
+                    system.membus.mem_side_ports
+                )
         
         else:
             system.cpu[i].connectBus(system.membus)
 
+    _config_warm_checkpoints(options, system)
+    _config_prefetch_warming(options, system)
+    _config_prefetch_issue(options, system)
+
     return system
 
 # ExternalSlave provides a "port", but when that port connects to a cache,
@@ -386,11 +386,83 @@ def addCommonOptions(parser):
         help="Size of indirect prefetch range, limited by Cache blkSize",
     )
     parser.add_argument(
-        "--dmp-init-bench",
+        "--dmp-chain-depth",
+        default=3,
+        action="store",
+        type=int,
+        help="Number of chained indirect levels DMP prefetches ahead",
+    )
+    parser.add_argument(
+        "--dmp-notify-latency",
+        default=0,
+        action="store",
+        type=int,
+        help="Cycles between a probe and its handling by DMP",
+    )
+    parser.add_argument(
+        "--dmp-match-width",
+        default=0,
+        action="store",
+        type=int,
+        help="Probes DMP matches per cycle, 0 for no limit",
+    )
+    parser.add_argument(
+        "--dmp-pf-gen-width",
+        default=0,
+        action="store",
+        type=int,
+        help="Indirect prefetches DMP generates per cycle, 0 for no limit",
+    )
+    parser.add_argument(
+        "--dmp-hint-file",
         default=None,
-        choices=ObjectList.dmp_bench_list.keys(),
         type=str,
-        help="Bench name in order to init DMP indirect pattern"
+        help="File of index/target/range PCs to init DMP tables with, "
+        "e.g. written by a run with --dmp-record-hints"
+    )
+    parser.add_argument(
+        "--prefetch-warming",
+        action="store_true",
+        help="Train the prefetchers on the accesses of atomic CPUs, e.g. "
+        "while fast-forwarding, without issuing prefetches"
+    )
+    parser.add_argument(
+        "--prefetch-issue-batch",
+        default=None,
+        action="store",
+        type=int,
+        help="Queued prefetches the caches check per issue slot, "
+        "dropping the redundant ones",
+    )
+    parser.add_argument(
+        "--prefetch-mshr-share",
+        default=None,
+        action="store",
+        type=int,
+        help="MSHRs prefetches may occupy ahead of ready demand misses",
+    )
+    parser.add_argument(
+        "--partition-eventqs",
+        default="off",
+        choices=["off", "single", "parallel"],
+        help="Simulate each core with its private caches on its own event "
+        "queue and host thread (parallel), bridged to the shared caches "
+        "like the parallel mode but on a single event queue (single), "
+        "or not at all (off)",
+    )
+    parser.add_argument(
+        "--partition-quantum",
+        default="1ns",
+        action="store",
+        type=str,
+        help="Synchronization quantum of the partitions, which is also "
+        "the latency of the bridges between them",
+    )
+    parser.add_argument(
+        "--dmp-record-hints",
+        action="store_true",
+        help="Write the PCs of the relations learned by DMP to "
+        "<prefetcher>.hints in the output directory at exit"
     )
     parser.add_argument(
         "--dmp-notify", 
@@ -406,6 +478,13 @@ def addCommonOptions(parser):
         type=int,
         help="Size of first stage ArmTLB"
     )
+    parser.add_argument(
+        "--tlb-assoc",
+        default=0,
+        action="store",
+        type=int,
+        help="Associativity of first stage ArmTLB, 0 for fully associative"
+    )
     parser.add_argument(
         "--sample-stats",
         action="store",
@@ -675,6 +754,12 @@ def addCommonOptions(parser):
         type=int,
         help="checkpoint and exit when active cpu count is reached",
     )
+    parser.add_argument(
+        "--warm-cache-checkpoints",
+        action="store_true",
+        help="save the cache contents in checkpoints and restore them, "
+        "instead of restoring the caches cold",
+    )
     parser.add_argument(
         "--restore-with-cpu",
         action="store",
@@ -682,6 +767,24 @@ def addCommonOptions(parser):
         choices=ObjectList.cpu_list.get_names(),
         help="cpu type for restoring from a checkpoint",
     )
+    parser.add_argument(
+        "--sweep",
+        action="store",
+        type=str,
+        default=None,
+        help="JSON file of sweep points, {name: {param path: value}}. "
+        "The checkpoint is restored once, then a child is forked per "
+        "point, which changes the given parameters of the instantiated "
+        "objects (e.g. system.l2.prefetcher.degree, system.l2.mshrs) and "
+        "runs to completion in <outdir>/<name>",
+    )
+    parser.add_argument(
+        "--sweep-jobs",
+        action="store",
+        type=int,
+        default=0,
+        help="Sweep points simulated at once, 0 for all the host cores",
+    )
 
     # CPU Switching - default switch model goes from a checkpoint
     # to a timing simple CPU with caches to warm up, then to detailed CPU for
@@ -490,6 +490,85 @@ def repeatSwitch(testsys, repeat_switch_cpu_list, maxtick, switch_freq):
             return exit_event
 
 
+def applySweepPoint(root, overrides):
+    """Change parameters of the instantiated objects, given as
+    {"system.l2.prefetcher.degree": value}. Only the parameters the C++
+    objects accept through setRuntimeParam can be changed, the others
+    (e.g. the prefetcher type or the replacement policy) are fixed once
+    the objects are created."""
+    for path, value in overrides.items():
+        obj_path, _, param = path.rpartition(".")
+        obj = root
+        for name in obj_path.split(".") if obj_path else []:
+            name, _, index = name.partition("[")
+            obj = getattr(obj, name)
+            if index:
+                obj = obj[int(index.rstrip("]"))]
+        if not hasattr(obj.getCCObject(), "setRuntimeParam"):
+            fatal("%s can't be changed after instantiation", path)
+        if isinstance(value, bool):
+            value = "true" if value else "false"
+        if not obj.getCCObject().setRuntimeParam(param, str(value)):
+            fatal(
+                "%s can't be set to %s after instantiation, sweep it "
+                "with separate runs",
+                path,
+                value,
+            )
+        print("Sweep: %s = %s" % (path, value))
+
+
+def forkSweep(options, root):
+    """Fork a child per point of the --sweep file once the checkpoint
+    is restored. The memories of the children share the parent pages
+    copy-on-write. Returns the name of the point in the children, with
+    its parameters applied, and exits in the parent once all the
+    children completed."""
+    import json
+    import os
+
+    with open(options.sweep) as f:
+        points = json.load(f)
+    if not points:
+        fatal("No sweep points in %s", options.sweep)
+    if options.take_checkpoints or options.checkpoint_at_end:
+        fatal("--sweep can't be used while taking checkpoints")
+    if not m5.listenersDisabled():
+        fatal("--sweep forks the simulator, disable the listeners")
+    for obj in root.descendants():
+        # writes to a shared backstore would be seen by every child
+        if isinstance(obj, System) and obj.shared_backstore:
+            fatal("--sweep can't be used with a shared backstore")
+
+    jobs = options.sweep_jobs or os.cpu_count()
+    outdir = m5.options.outdir
+    running = {}
+    failed = []
+
+    def reap():
+        pid, status = os.wait()
+        name = running.pop(pid)
+        if not os.WIFEXITED(status) or os.WEXITSTATUS(status) != 0:
+            failed.append(name)
+        print("Sweep point %s done" % name)
+
+    for name, overrides in points.items():
+        while len(running) >= jobs:
+            reap()
+        sys.stdout.flush()
+        pid = m5.fork(joinpath(outdir, name.replace("%", "%%")))
+        if pid == 0:
+            applySweepPoint(root, overrides)
+            return name
+        running[pid] = name
+    while running:
+        reap()
+
+    if failed:
+        print("Sweep points failed: %s" % ", ".join(failed))
+    sys.exit(1 if failed else 0)
+
+
 def run(options, root, testsys, cpu_class, multiprocesses=0):
     if options.checkpoint_dir:
         cptdir = options.checkpoint_dir
@@ -700,6 +779,18 @@ def run(options, root, testsys, cpu_class, multiprocesses=0):
     checkpoint_dir = None
     if options.checkpoint_restore:
         cpt_starttick, checkpoint_dir = findCptDir(options, cptdir, testsys)
+
+    if getattr(options, "partition_eventqs", "off") == "parallel":
+        # the partitions of the cores synchronize every quantum, and the
+        # switched in CPUs run in the partition of the CPU they replace
+        m5.ticks.fixGlobalFrequency()
+        root.sim_quantum = m5.ticks.fromSeconds(
+            m5.util.convert.anyToLatency(options.partition_quantum)
+        )
+        for name in ("switch_cpus", "switch_cpus_1", "repeat_switch_cpus"):
+            for i, cpu in enumerate(getattr(testsys, name, None) or []):
+                cpu.eventq_index = testsys.cpu[i].eventq_index
+
     root.apply_config(options.param)
     m5.instantiate(checkpoint_dir)
 
@@ -712,6 +803,10 @@ def run(options, root, testsys, cpu_class, multiprocesses=0):
     if options.initialize_only:
         return
 
+    # Restore once, and simulate every sweep point in its own child
+    if options.sweep:
+        forkSweep(options, root)
+
     # Handle the max tick settings now that tick frequency was resolved
     # during system instantiation
     # NOTE: the maxtick variable here is in absolute ticks, so it must
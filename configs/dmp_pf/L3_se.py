@@ -173,6 +173,10 @@ CPUClass.numThreads = numThreads
 if args.smt and args.num_cpus > 1:
     fatal("You cannot use SMT with multiple CPUs!")
 
+# Check -- the processes are shared by the event queues of the cores
+if args.partition_eventqs != "off":
+    fatal("--partition-eventqs is not supported in SE mode!")
+
 np = args.num_cpus
 mp0_path = multiprocesses[0].executable
 system = System(
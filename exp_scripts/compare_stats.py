@@ -0,0 +1,75 @@
+#! /bin/env python3
+
+# Compare the stats of a --partition-eventqs parallel run with the ones of
+# the single run of the same checkpoint, which share the same timing but
+# for the interleaving of the partitions within a quantum. Exits with 1 if
+# a stat differs by more than the tolerance.
+#
+#   ./compare_stats.py single_m5out/stats.txt parallel_m5out/stats.txt
+
+import argparse
+import re
+import sys
+
+default_stats = [
+    r'simInsts',
+    r'simSeconds',
+    r'system\.cpu\d*\.ipc',
+    r'system\.(cpu\d*\.)?l2\.overallMissRate::total',
+    r'system\.l3\.overallMissRate::total',
+    r'system\.(cpu\d*\.)?l2\.prefetcher\.pfIssued',
+    r'system\.(cpu\d*\.)?l2\.prefetcher\.pfUseful',
+]
+
+def read_stats(path):
+    # the stats of the first dump
+    stats = {}
+    with open(path, 'r') as f:
+        for line in f:
+            if line.startswith('---------- End'):
+                break
+            # remove comments
+            fields = line.split('#')[0].split()
+            if len(fields) < 2:
+                continue
+            try:
+                stats[fields[0]] = float(fields[1])
+            except ValueError:
+                pass
+    return stats
+
+parser = argparse.ArgumentParser()
+parser.add_argument('reference', help='stats.txt of the single run')
+parser.add_argument('parallel', help='stats.txt of the parallel run')
+parser.add_argument('--tolerance', type=float, default=0.02,
+        help='relative difference allowed per stat')
+parser.add_argument('--stat', action='append', default=None,
+        help='regex of the stats to compare, may be repeated')
+args = parser.parse_args()
+
+reference = read_stats(args.reference)
+parallel = read_stats(args.parallel)
+patterns = [re.compile(p) for p in (args.stat or default_stats)]
+
+failed = False
+compared = 0
+for name in sorted(reference):
+    if not any(p.fullmatch(name) for p in patterns):
+        continue
+    ref = reference[name]
+    if name not in parallel:
+        print('%s: missing' % name)
+        failed = True
+        continue
+    par = parallel[name]
+    diff = abs(par - ref) / abs(ref) if ref != 0 else abs(par)
+    verdict = 'FAIL' if diff > args.tolerance else 'ok'
+    print('%s: %g %g (%.2f%%) %s' % (name, ref, par, diff * 100, verdict))
+    failed = failed or diff > args.tolerance
+    compared += 1
+
+if compared == 0:
+    print('no stat to compare')
+    failed = True
+
+sys.exit(1 if failed else 0)
@@ -30,6 +30,13 @@ GEM5_ARCH="ARM"
 GEM5_BIN="$GEM5_PATH/build/$GEM5_ARCH/gem5.opt"
 SW_PATH="aarch-system-20220707"
 
+HINT_FILE="$GEM5_PATH/configs/dmp_pf/hints/${BENCH}.hint"
+if [[ -f "$HINT_FILE" ]]; then
+    HINT_OPT="--dmp-hint-file $HINT_FILE"
+else
+    HINT_OPT=""
+fi
+
 function render_rcS() {
     :> $1/$2_$3_$4.rcS
 
@@ -77,7 +84,7 @@ elif [[ "$MODE" == "restore" ]]; then
         --l2_repl_policy LRURP \
         --l1d-hwp-type StridePrefetcher \
         --l2-hwp-type DiffMatchingPrefetcher \
-        --dmp-init-bench $BENCH \
+        $HINT_OPT \
         --tlb-size 65536 \
         --stride-degree $STR_DEG \
         --dmp-range-ahead-dist $RAG_AHEAD \
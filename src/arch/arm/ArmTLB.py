@@ -39,6 +39,7 @@ from m5.SimObject import SimObject
 from m5.params import *
 from m5.proxy import *
 from m5.objects.BaseTLB import BaseTLB
+from m5.objects.ReplacementPolicies import BaseReplacementPolicy
 
 
 class ArmLookupLevel(Enum):
@@ -51,6 +52,11 @@ class ArmTLB(BaseTLB):
     cxx_header = "arch/arm/tlb.hh"
     sys = Param.System(Parent.any, "system object parameter")
     size = Param.Int(64, "TLB size")
+    assoc = Param.Int(0, "TLB associativity, 0 for fully associative")
+    replacement_policy = Param.BaseReplacementPolicy(
+        NULL,
+        "Replacement policy within a set, NULL for the MRU-ordered array",
+    )
     is_stage2 = Param.Bool(False, "Is this a stage 2 TLB?")
     pf_translation_timing = Param.Bool(
         False, 
@@ -1034,12 +1034,20 @@ ISA::readMiscReg(RegIndex idx)
       // Generic Timer registers
       case MISCREG_CNTFRQ ... MISCREG_CNTVOFF:
       case MISCREG_CNTFRQ_EL0 ... MISCREG_CNTVOFF_EL2:
-        return getGenericTimer().readMiscReg(idx);
+        {
+            // the timer and the GIC are on the event queue of the
+            // system, which may not be the one of this core
+            EventQueue::ScopedMigration migrate(system->eventQueue());
+            return getGenericTimer().readMiscReg(idx);
+        }
 
       case MISCREG_ICC_AP0R0 ... MISCREG_ICH_LRC15:
       case MISCREG_ICC_PMR_EL1 ... MISCREG_ICC_IGRPEN1_EL3:
       case MISCREG_ICH_AP0R0_EL2 ... MISCREG_ICH_LR15_EL2:
-        return getGICv3CPUInterface().readMiscReg(idx);
+        {
+            EventQueue::ScopedMigration migrate(system->eventQueue());
+            return getGICv3CPUInterface().readMiscReg(idx);
+        }
 
       default:
         break;
@@ -1122,6 +1130,7 @@ ISA::setMiscReg(RegIndex idx, RegVal val)
                 // ensures that IRQ and FIQ are both appropriately
                 // asserted or deasserted for the Exception level and
                 // Security state that the PE is entering.
+                EventQueue::ScopedMigration migrate(system->eventQueue());
                 static_cast<Gicv3CPUInterface&>(
                     getGICv3CPUInterface()).update();
             }
@@ -1957,12 +1966,18 @@ ISA::setMiscReg(RegIndex idx, RegVal val)
           // Generic Timer registers
           case MISCREG_CNTFRQ ... MISCREG_CNTVOFF:
           case MISCREG_CNTFRQ_EL0 ... MISCREG_CNTVOFF_EL2:
-            getGenericTimer().setMiscReg(idx, newVal);
+            {
+                EventQueue::ScopedMigration migrate(system->eventQueue());
+                getGenericTimer().setMiscReg(idx, newVal);
+            }
             break;
           case MISCREG_ICC_AP0R0 ... MISCREG_ICH_LRC15:
           case MISCREG_ICC_PMR_EL1 ... MISCREG_ICC_IGRPEN1_EL3:
           case MISCREG_ICH_AP0R0_EL2 ... MISCREG_ICH_LR15_EL2:
-            getGICv3CPUInterface().setMiscReg(idx, newVal);
+            {
+                EventQueue::ScopedMigration migrate(system->eventQueue());
+                getGICv3CPUInterface().setMiscReg(idx, newVal);
+            }
             return;
           case MISCREG_ZCR_EL3:
           case MISCREG_ZCR_EL2:
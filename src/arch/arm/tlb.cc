@@ -40,6 +40,7 @@
 
 #include "arch/arm/tlb.hh"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -47,6 +48,7 @@
 #include "arch/arm/table_walker.hh"
 #include "arch/arm/tlbi_op.hh"
 #include "arch/arm/utility.hh"
+#include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/thread_context.hh"
 #include "debug/TLB.hh"
@@ -60,6 +62,14 @@ using namespace ArmISA;
 
 TLB::TLB(const ArmTLBParams &p)
     : BaseTLB(p), table(new TlbEntry[p.size]), size(p.size),
+      assoc(p.assoc > 0 ? p.assoc : std::max(p.size, 1)),
+      numSets(p.size / assoc),
+      replacementPolicy(p.replacement_policy),
+      replEntries(p.size),
+      mruPrev(p.size), mruNext(p.size),
+      mruHead(numSets), mruTail(numSets),
+      mruStamp(p.size), mruClock(0),
+      slotIndex(p.size, SlotIndex::None), slotKey(p.size),
       isStage2(p.is_stage2),
       pf_translation_timing(p.pf_translation_timing),
       _walkCache(false),
@@ -67,6 +77,21 @@ TLB::TLB(const ArmTLBParams &p)
       stats(*this), rangeMRU(1), vmid(0),
       can_serialize(p.can_serialize)
 {
+    fatal_if(size <= 0, "TLB needs at least one entry");
+    fatal_if(size % assoc != 0,
+             "TLB size %d is not a multiple of its associativity %d",
+             size, assoc);
+
+    for (int slot = 0; slot < size; slot++) {
+        replEntries[slot].setPosition(slot / assoc, slot % assoc);
+        if (replacementPolicy) {
+            replEntries[slot].replacementData =
+                replacementPolicy->instantiateEntry();
+        }
+    }
+    resetOrder();
+    pageSizeCount.fill(0);
+
     for (int lvl = LookupLevel::L0;
          lvl < LookupLevel::Num_ArmLookupLevel; lvl++) {
 
@@ -107,52 +132,204 @@ TLB::setTableWalker(TableWalker *table_walker)
 TlbEntry*
 TLB::match(const Lookup &lookup_data)
 {
-    // Vector of TLB entry candidates.
+    // Gather the entries which may map the address: one page index
+    // probe per page size in use, plus the irregular entries
+    std::vector<int> &cands = matchCandidates;
+    cands.clear();
+    for (uint8_t n : pageSizes) {
+        auto range = pageIndex.equal_range(PageKey{lookup_data.va >> n, n});
+        for (auto it = range.first; it != range.second; ++it) {
+            if (table[it->second].match(lookup_data))
+                cands.push_back(it->second);
+        }
+    }
+    for (int x : irregularSlots) {
+        if (table[x].match(lookup_data))
+            cands.push_back(x);
+    }
+
+    // Visit them in MRU order, as the scan of the MRU-ordered array
+    std::sort(cands.begin(), cands.end(), [&](int a, int b) {
+        return mruStamp[a] > mruStamp[b];
+    });
+
+    // TLB entry candidates, one per lookup level as it stores
+    // both complete and partial matches.
     // Only one of them will be assigned to retval and will
     // be returned to the MMU (in case of a hit)
-    // The vector has one entry per lookup level as it stores
-    // both complete and partial matches
-    std::vector<std::pair<int, const TlbEntry*>> hits{
-        LookupLevel::Num_ArmLookupLevel, {0, nullptr}};
+    std::array<int, LookupLevel::Num_ArmLookupLevel> hits;
+    hits.fill(-1);
 
-    int x = 0;
-    while (x < size) {
-        if (table[x].match(lookup_data)) {
-            const TlbEntry &entry = table[x];
-            hits[entry.lookupLevel] = std::make_pair(x, &entry);
+    for (int x : cands) {
+        const TlbEntry &entry = table[x];
+        hits[entry.lookupLevel] = x;
 
-            // This is a complete translation, no need to loop further
-            if (!entry.partial)
-                break;
-        }
-        ++x;
+        // This is a complete translation, no need to loop further
+        if (!entry.partial)
+            break;
     }
 
     // Loop over the list of TLB entries matching our translation
     // request, starting from the highest lookup level (complete
     // translation) and iterating backwards (using reverse iterators)
     for (auto it = hits.rbegin(); it != hits.rend(); it++) {
-        const auto& [idx, entry] = *it;
-        if (!entry) {
+        const int idx = *it;
+        if (idx == -1) {
             // No match for the current LookupLevel
             continue;
         }
 
+        if (!lookup_data.functional)
+            touch(idx);
+        return &table[idx];
+    }
+
+    return nullptr;
+}
+
+int
+TLB::setOf(const TlbEntry &entry) const
+{
+    return entry.vpn % numSets;
+}
+
+int
+TLB::findVictim(int set)
+{
+    if (!replacementPolicy)
+        return mruTail[set];
+
+    victimCandidates.clear();
+    for (int way = 0; way < assoc; way++)
+        victimCandidates.push_back(&replEntries[set * assoc + way]);
+    ReplaceableEntry *victim = replacementPolicy->getVictim(victimCandidates);
+    return victim->getSet() * assoc + victim->getWay();
+}
+
+void
+TLB::touch(int slot)
+{
+    if (replacementPolicy) {
+        replacementPolicy->touch(replEntries[slot].replacementData);
+        moveToFront(slot);
+    } else if (!nearMRU(slot)) {
         // Maintaining LRU array
         // We only move the hit entry ahead when the position is higher
         // than rangeMRU
-        if (idx > rangeMRU && !lookup_data.functional) {
-            TlbEntry tmp_entry = *entry;
-            for (int i = idx; i > 0; i--)
-                table[i] = table[i - 1];
-            table[0] = tmp_entry;
-            return &table[0];
-        } else {
-            return &table[idx];
+        moveToFront(slot);
+    }
+}
+
+void
+TLB::moveToFront(int slot)
+{
+    mruStamp[slot] = ++mruClock;
+
+    const int set = slot / assoc;
+    if (mruHead[set] == slot)
+        return;
+
+    // unlink
+    mruNext[mruPrev[slot]] = mruNext[slot];
+    if (mruNext[slot] != -1)
+        mruPrev[mruNext[slot]] = mruPrev[slot];
+    else
+        mruTail[set] = mruPrev[slot];
+
+    // link at the head
+    mruPrev[slot] = -1;
+    mruNext[slot] = mruHead[set];
+    mruPrev[mruHead[set]] = slot;
+    mruHead[set] = slot;
+}
+
+bool
+TLB::nearMRU(int slot) const
+{
+    int x = mruHead[slot / assoc];
+    for (int pos = 0; pos <= rangeMRU && x != -1; pos++, x = mruNext[x]) {
+        if (x == slot)
+            return true;
+    }
+    return false;
+}
+
+void
+TLB::resetOrder()
+{
+    // slot order within each set, the lowest slot being the MRU one
+    for (int set = 0; set < numSets; set++) {
+        const int base = set * assoc;
+        for (int way = 0; way < assoc; way++) {
+            const int slot = base + way;
+            mruPrev[slot] = way > 0 ? slot - 1 : -1;
+            mruNext[slot] = way < assoc - 1 ? slot + 1 : -1;
+            mruStamp[slot] = size - slot;
         }
+        mruHead[set] = base;
+        mruTail[set] = base + assoc - 1;
     }
+    mruClock = size;
+}
 
-    return nullptr;
+void
+TLB::indexSlot(int slot)
+{
+    const TlbEntry &entry = table[slot];
+    assert(slotIndex[slot] == SlotIndex::None);
+    if (!entry.valid)
+        return;
+
+    if (entry.N < 64 && entry.size == mask(entry.N)) {
+        const PageKey key{entry.vpn, entry.N};
+        pageIndex.emplace(key, slot);
+        slotKey[slot] = key;
+        slotIndex[slot] = SlotIndex::Page;
+        if (pageSizeCount[entry.N]++ == 0)
+            pageSizes.push_back(entry.N);
+    } else {
+        irregularSlots.push_back(slot);
+        slotIndex[slot] = SlotIndex::Irregular;
+    }
+}
+
+void
+TLB::unindexSlot(int slot)
+{
+    switch (slotIndex[slot]) {
+      case SlotIndex::Page:
+        {
+            const PageKey &key = slotKey[slot];
+            auto range = pageIndex.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == slot) {
+                    pageIndex.erase(it);
+                    break;
+                }
+            }
+            if (--pageSizeCount[key.N] == 0) {
+                pageSizes.erase(std::find(pageSizes.begin(),
+                                          pageSizes.end(), key.N));
+            }
+        }
+        break;
+      case SlotIndex::Irregular:
+        irregularSlots.erase(std::find(irregularSlots.begin(),
+                                       irregularSlots.end(), slot));
+        break;
+      case SlotIndex::None:
+        break;
+    }
+    slotIndex[slot] = SlotIndex::None;
+}
+
+void
+TLB::invalidateSlot(int slot)
+{
+    table[slot].valid = false;
+    unindexSlot(slot);
+    if (replacementPolicy)
+        replacementPolicy->invalidate(replEntries[slot].replacementData);
 }
 
 TlbEntry*
@@ -250,19 +427,22 @@ TLB::insert(TlbEntry &entry)
             entry.ap, static_cast<uint8_t>(entry.domain), entry.ns, entry.nstid,
             entry.isHyp);
 
-    if (table[size - 1].valid)
+    const int victim = findVictim(setOf(entry));
+    const TlbEntry &old = table[victim];
+    if (old.valid)
         DPRINTF(TLB, " - Replacing Valid entry %#x, asn %d vmn %d ppn %#x "
                 "size: %#x ap:%d ns:%d nstid:%d g:%d isHyp:%d el: %d\n",
-                table[size-1].vpn << table[size-1].N, table[size-1].asid,
-                table[size-1].vmid, table[size-1].pfn << table[size-1].N,
-                table[size-1].size, table[size-1].ap, table[size-1].ns,
-                table[size-1].nstid, table[size-1].global, table[size-1].isHyp,
-                table[size-1].el);
+                old.vpn << old.N, old.asid, old.vmid, old.pfn << old.N,
+                old.size, old.ap, old.ns, old.nstid, old.global, old.isHyp,
+                old.el);
 
     // inserting to MRU position and evicting the LRU one
-    for (int i = size - 1; i > 0; --i)
-        table[i] = table[i-1];
-    table[0] = entry;
+    unindexSlot(victim);
+    table[victim] = entry;
+    indexSlot(victim);
+    if (replacementPolicy)
+        replacementPolicy->reset(replEntries[victim].replacementData);
+    moveToFront(victim);
 
     stats.inserts++;
     ppRefills->notify(1);
@@ -307,7 +487,7 @@ TLB::flushAll()
 
         if (te->valid) {
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateSlot(x);
             stats.flushedEntries++;
         }
         ++x;
@@ -325,7 +505,7 @@ TLB::flush(const TLBIOp& tlbi_op)
         te = &table[x];
         if (tlbi_op.match(te, vmid)) {
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateSlot(x);
             stats.flushedEntries++;
         }
         ++x;
@@ -417,9 +597,13 @@ TLB::serialize(CheckpointOut &cp) const
     int _size = size;
     SERIALIZE_SCALAR(_size);
 
-    // Store all entries
-    for (int i = 0; i < size; i++) {
-        table[i].serializeSection(cp, csprintf("Entry%d", i));
+    // Store all entries, each set in MRU order so that restoring them
+    // in slot order keeps the recency order
+    int i = 0;
+    for (int set = 0; set < numSets; set++) {
+        for (int x = mruHead[set]; x != -1; x = mruNext[x]) {
+            table[x].serializeSection(cp, csprintf("Entry%d", i++));
+        }
     }
 }
 
@@ -437,8 +621,19 @@ TLB::unserialize(CheckpointIn &cp)
     // Restore all entries
     for (int i = 0; i < _size; i++) {
         // Use pre-allocated space in table
+        unindexSlot(i);
         table[i].unserializeSection(cp, csprintf("Entry%d", i));
+        indexSlot(i);
+        if (replacementPolicy) {
+            if (table[i].valid) {
+                replacementPolicy->reset(replEntries[i].replacementData);
+            } else {
+                replacementPolicy->invalidate(
+                    replEntries[i].replacementData);
+            }
+        }
     }
+    resetOrder();
 }
 
 } // namespace gem5
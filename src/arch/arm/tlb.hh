@@ -41,6 +41,11 @@
 #ifndef __ARCH_ARM_TLB_HH__
 #define __ARCH_ARM_TLB_HH__
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "arch/arm/faults.hh"
 #include "arch/arm/pagetable.hh"
@@ -48,6 +53,8 @@
 #include "arch/generic/tlb.hh"
 #include "base/statistics.hh"
 #include "enums/TypeTLB.hh"
+#include "mem/cache/replacement_policies/base.hh"
+#include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/request.hh"
 #include "params/ArmTLB.hh"
 #include "sim/probe/pmu.hh"
@@ -108,6 +115,84 @@ class TLB : public BaseTLB
     /** TLB Size */
     int size;
 
+    /** Ways per set, size if the TLB is fully associative */
+    int assoc;
+
+    /** Number of sets, 1 if the TLB is fully associative */
+    int numSets;
+
+    /**
+     * Replacement policy choosing the victim within a set. Without one
+     * each set behaves as the MRU-ordered array of the original TLB:
+     * hits move an entry to the front unless it is within rangeMRU, and
+     * the last entry is replaced.
+     */
+    replacement_policy::Base *replacementPolicy;
+
+    /** Replacement state of each slot of table */
+    std::vector<ReplaceableEntry> replEntries;
+
+    /**
+     * Recency order of the slots of each set, MRU first, kept as a
+     * linked list so that moving an entry to the front is O(1). The
+     * stamps give the same order across sets, the higher the more
+     * recent.
+     */
+    std::vector<int> mruPrev;
+    std::vector<int> mruNext;
+    std::vector<int> mruHead;
+    std::vector<int> mruTail;
+    std::vector<uint64_t> mruStamp;
+    uint64_t mruClock;
+
+    /**
+     * Index of the valid entries by page: an entry of N page bits can
+     * only match addresses with va >> N == vpn, so a lookup probes one
+     * key per page size present in the TLB instead of scanning it.
+     */
+    struct PageKey
+    {
+        Addr vpn;
+        uint8_t N;
+
+        bool
+        operator==(const PageKey &other) const
+        {
+            return vpn == other.vpn && N == other.N;
+        }
+    };
+
+    struct PageKeyHash
+    {
+        size_t
+        operator()(const PageKey &key) const
+        {
+            return std::hash<Addr>()(key.vpn * 0x9e3779b97f4a7c15ULL ^
+                                     key.N);
+        }
+    };
+
+    std::unordered_multimap<PageKey, int, PageKeyHash> pageIndex;
+
+    /** How each slot is indexed */
+    enum class SlotIndex : uint8_t { None, Page, Irregular };
+    std::vector<SlotIndex> slotIndex;
+    std::vector<PageKey> slotKey;
+
+    /**
+     * Valid entries whose size does not cover exactly their page,
+     * which are checked on every lookup
+     */
+    std::vector<int> irregularSlots;
+
+    /** Number of indexed entries per page size, and the sizes in use */
+    std::array<int, 64> pageSizeCount;
+    std::vector<uint8_t> pageSizes;
+
+    /** Candidates of the lookup in progress */
+    std::vector<int> matchCandidates;
+    ReplacementCandidates victimCandidates;
+
     /** Indicates this TLB caches IPA->PA translations */
     bool isStage2;
 
@@ -305,6 +390,31 @@ class TLB : public BaseTLB
     /** Helper function looking up for a matching TLB entry
      * Does not update stats; see lookup method instead */
     TlbEntry *match(const Lookup &lookup_data);
+
+    /** Set an entry is placed in */
+    int setOf(const TlbEntry &entry) const;
+
+    /** Slot of the set to (re)place with a new entry */
+    int findVictim(int set);
+
+    /** Update the replacement state of a slot on a hit */
+    void touch(int slot);
+
+    /** Make a slot the MRU one of its set */
+    void moveToFront(int slot);
+
+    /** Whether a slot is among the rangeMRU+1 first of its set */
+    bool nearMRU(int slot) const;
+
+    /** Reset the recency order of every set to the slot order */
+    void resetOrder();
+
+    /** Add or remove the entry of a slot from the page index */
+    void indexSlot(int slot);
+    void unindexSlot(int slot);
+
+    /** Invalidate the entry of a slot */
+    void invalidateSlot(int slot);
 };
 
 } // namespace ArmISA
@@ -0,0 +1,174 @@
+/**
+ * Thread-local free lists of fixed size blocks
+ */
+
+#ifndef __BASE_FREE_LIST_HH__
+#define __BASE_FREE_LIST_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace gem5
+{
+
+/**
+ * Free list of the blocks of Size bytes of a host thread, for objects
+ * which are allocated and freed at a high rate, e.g. packets. Blocks
+ * are carved from chunks which are never given back, so the memory
+ * used is the peak of live objects.
+ *
+ * Objects may be freed by another thread than the one which allocated
+ * them, e.g. the packets and requests crossing a QuantumBridge, or the
+ * probe packets of a prefetcher on another event queue. Each block thus
+ * records the free list it was carved for, and a block freed by another
+ * thread goes to a locked list of its owner, which takes the blocks back
+ * when it runs out. Otherwise the blocks would pile up in the free list
+ * of the freeing thread, and the owner would keep carving new chunks.
+ */
+template <size_t Size, size_t Align>
+class FreeList
+{
+    static_assert(Align <= alignof(std::max_align_t),
+                  "Chunks are only aligned to max_align_t");
+
+    struct Block
+    {
+        Block *next;
+    };
+
+    /** Each block is preceded by a pointer to its owner */
+    static constexpr size_t HeaderBytes =
+        (sizeof(FreeList *) + Align - 1) / Align * Align;
+    static constexpr size_t BlockBytes = HeaderBytes +
+        (std::max(Size, sizeof(Block)) + Align - 1) / Align * Align;
+    static constexpr size_t ChunkBlocks = 256;
+
+    Block *head = nullptr;
+
+    /** Blocks freed by other threads */
+    std::mutex remoteLock;
+    Block *remoteHead = nullptr;
+
+    static FreeList *&
+    owner(void *p)
+    {
+        return *reinterpret_cast<FreeList **>(
+            static_cast<char *>(p) - HeaderBytes);
+    }
+
+    void
+    push(void *p)
+    {
+        Block *block = static_cast<Block *>(p);
+        block->next = head;
+        head = block;
+    }
+
+    void
+    refill()
+    {
+        {
+            std::lock_guard<std::mutex> lock(remoteLock);
+            head = remoteHead;
+            remoteHead = nullptr;
+        }
+        if (head) {
+            return;
+        }
+
+        char *chunk = static_cast<char *>(
+            ::operator new(BlockBytes * ChunkBlocks));
+        for (size_t i = 0; i < ChunkBlocks; i++) {
+            char *p = chunk + i * BlockBytes + HeaderBytes;
+            owner(p) = this;
+            push(p);
+        }
+    }
+
+  public:
+    /**
+     * The free list of the calling thread, which outlives it as its
+     * blocks may still be freed by other threads
+     */
+    static FreeList &
+    local()
+    {
+        thread_local FreeList *list = new FreeList;
+        return *list;
+    }
+
+    void *
+    allocate()
+    {
+        if (!head) {
+            refill();
+        }
+        Block *block = head;
+        head = block->next;
+        return block;
+    }
+
+    /** Free a block to the free list it was carved for */
+    void
+    deallocate(void *p)
+    {
+        FreeList *list = owner(p);
+        if (list == this) {
+            push(p);
+            return;
+        }
+
+        Block *block = static_cast<Block *>(p);
+        std::lock_guard<std::mutex> lock(list->remoteLock);
+        block->next = list->remoteHead;
+        list->remoteHead = block;
+    }
+};
+
+/**
+ * Allocator of single objects from the free list of the calling thread,
+ * e.g. for std::allocate_shared(), which also places the reference
+ * count in the block. Arrays are allocated with operator new.
+ */
+template <typename T>
+class FreeListAllocator
+{
+    using List = FreeList<sizeof(T), alignof(T)>;
+
+  public:
+    using value_type = T;
+
+    FreeListAllocator() = default;
+    template <typename U>
+    FreeListAllocator(const FreeListAllocator<U> &) {}
+
+    T *
+    allocate(size_t n)
+    {
+        if (n != 1) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(List::local().allocate());
+    }
+
+    void
+    deallocate(T *p, size_t n)
+    {
+        if (n != 1) {
+            ::operator delete(p);
+        } else {
+            List::local().deallocate(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const FreeListAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const FreeListAllocator<U> &) const { return false; }
+};
+
+} // namespace gem5
+
+#endif // __BASE_FREE_LIST_HH__
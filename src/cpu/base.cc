@@ -193,6 +193,9 @@ BaseCPU::~BaseCPU()
 void
 BaseCPU::postInterrupt(ThreadID tid, int int_num, int index)
 {
+    // devices on the shared event queue interrupt a core simulated on
+    // its own queue, whose state is locked meanwhile
+    EventQueue::ScopedEntry enter(eventQueue());
     interrupts[tid]->post(int_num, index);
     // Only wake up syscall emulation if it is not waiting on a futex.
     // This is to model the fact that instructions such as ARM SEV
@@ -242,7 +245,7 @@ BaseCPU::mwaitAtomic(ThreadID tid, ThreadContext *tc, BaseMMU *mmu)
     assert(tid < numThreads);
     AddressMonitor &monitor = addressMonitor[tid];
 
-    RequestPtr req = std::make_shared<Request>();
+    RequestPtr req = Request::create();
 
     Addr addr = monitor.vAddr;
     int block_size = cacheLineSize();
@@ -237,12 +237,14 @@ class BaseCPU : public ClockedObject
     void
     clearInterrupt(ThreadID tid, int int_num, int index)
     {
+        EventQueue::ScopedEntry enter(eventQueue());
         interrupts[tid]->clear(int_num, index);
     }
 
     void
     clearInterrupts(ThreadID tid)
     {
+        EventQueue::ScopedEntry enter(eventQueue());
         interrupts[tid]->clearAll();
     }
 
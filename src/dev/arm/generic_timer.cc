@@ -873,6 +873,7 @@ GenericTimer::CoreTimers::virtEventStreamCallback()
 void
 GenericTimer::CoreTimers::eventStreamCallback() const
 {
+    EventQueue::ScopedEntry enter(threadContext->getCpuPtr()->eventQueue());
     sendEvent(threadContext);
     threadContext->getCpuPtr()->wakeup(threadContext->threadId());
 }
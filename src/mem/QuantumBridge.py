@@ -0,0 +1,46 @@
+from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
+
+
+class QuantumBridge(SimObject):
+    """Bridge between SimObjects on different event queues in timing mode
+
+    The bridge is on the event queue of its memory side, and
+    cpu_side_eventq_index is the event queue of its CPU side. Timing
+    packets cross the bridge as events on the queue of the other side
+    after the bridge delay, which must be at least the simulation
+    quantum (Root.sim_quantum) when the queues differ. Express snoops
+    from the memory side are delivered at once, so the CPU side must
+    have the higher event queue index when it snoops.
+
+    Example, a core with private L1 caches on event queue 1 and the
+    shared L2 on event queue 0:
+
+    root.sim_quantum = 1000
+    cpu.eventq_index = 1
+    cpu.dcache_bridge = QuantumBridge(
+        eventq_index=0, cpu_side_eventq_index=1, delay="1ns")
+    cpu.dcache.mem_side = cpu.dcache_bridge.cpu_side_port
+    cpu.dcache_bridge.mem_side_port = system.tol2bus.cpu_side_ports
+    """
+
+    type = "QuantumBridge"
+    cxx_header = "mem/quantum_bridge.hh"
+    cxx_class = "gem5::QuantumBridge"
+
+    cpu_side_port = ResponsePort(
+        "This port receives requests and sends responses"
+    )
+    mem_side_port = RequestPort(
+        "This port sends requests and receives responses"
+    )
+
+    cpu_side_eventq_index = Param.UInt32(
+        Parent.eventq_index, "Event queue of the CPU side"
+    )
+    delay = Param.Latency(
+        "1ns",
+        "The latency of this bridge, at least the simulation quantum "
+        "when the sides are on different event queues",
+    )
@@ -155,6 +155,11 @@ class SnoopFilter(SimObject):
     # Sanity check on max capacity to track, adjust if needed.
     max_capacity = Param.MemorySize("8MiB", "Maximum capacity of snoop filter")
 
+    # Needed to restore the caches below that checkpoint their contents
+    checkpoint_contents = Param.Bool(
+        False, "Save and restore the tracked lines in checkpoints"
+    )
+
 
 # We use a coherent crossbar to connect multiple requestors to the L2
 # caches. Normally this crossbar would be part of the cache itself.
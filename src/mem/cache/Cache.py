@@ -38,7 +38,7 @@
 
 from m5.params import *
 from m5.proxy import *
-from m5.SimObject import SimObject
+from m5.SimObject import *
 
 from m5.objects.ClockedObject import ClockedObject
 from m5.objects.Compressors import BaseCacheCompressor
@@ -82,6 +82,7 @@ class BaseCache(ClockedObject):
     abstract = True
     cxx_header = "mem/cache/base.hh"
     cxx_class = "gem5::BaseCache"
+    cxx_exports = [PyBindMethod("setRuntimeParam")]
 
     size = Param.MemorySize("Capacity")
     assoc = Param.Unsigned("Associativity")
@@ -113,6 +114,22 @@ class BaseCache(ClockedObject):
     prefetch_on_pf_hit = Param.Bool(
         False, "Notify the hardware prefetcher on hit on prefetched lines"
     )
+    prefetch_warming = Param.Bool(
+        False,
+        "Notify the hardware prefetcher of atomic accesses, so it trains "
+        "during fast-forward (prefetches are not issued in atomic mode)",
+    )
+
+    prefetch_issue_batch = Param.Unsigned(
+        1,
+        "Queued prefetches checked against the tags, MSHRs and write "
+        "buffer per issue slot, redundant ones are dropped",
+    )
+    prefetch_mshr_share = Param.Unsigned(
+        0,
+        "MSHRs prefetches may occupy ahead of ready demand misses, "
+        "0 issues prefetches only when no miss is ready",
+    )
 
     tags = Param.BaseTags(BaseSetAssoc(), "Tag store")
     replacement_policy = Param.BaseReplacementPolicy(
@@ -173,7 +190,19 @@ class BaseCache(ClockedObject):
     # data cache.
     write_allocator = Param.WriteAllocator(NULL, "Write allocator")
 
+    # Checkpoints normally restore caches cold and refuse dirty caches.
+    # When enabled, the tags, replacement data and data blocks of the
+    # cache are saved in a side file of the checkpoint and restored, so
+    # simulation resumes with a warm cache. The snoop filters of the
+    # crossbars above the cache must checkpoint their contents too.
+    checkpoint_contents = Param.Bool(False,
+        "Save and restore the contents of the cache in checkpoints")
+
     stats_pc_list = VectorParam.Addr([], "Monitor PC list in stats")
+    stats_pc_auto = Param.Unsigned(0,
+        "Number of PCs added to the monitored PCs by their demand misses")
+    stats_pc_auto_misses = Param.Unsigned(16,
+        "Demand misses of a PC before it is monitored")
 
 class Cache(BaseCache):
     type = "Cache"
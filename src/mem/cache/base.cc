@@ -45,9 +45,16 @@
 
 #include "mem/cache/base.hh"
 
+#include <zlib.h>
+
+#include <climits>
+#include <sstream>
+
 #include "base/compiler.hh"
 #include "base/logging.hh"
+#include "base/str.hh"
 #include "debug/Cache.hh"
+#include "debug/Checkpoint.hh"
 #include "debug/CacheComp.hh"
 #include "debug/CachePort.hh"
 #include "debug/CacheRepl.hh"
@@ -105,6 +112,10 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
       isReadOnly(p.is_read_only),
       replaceExpansions(p.replace_expansions),
       moveContractions(p.move_contractions),
+      checkpointContents(p.checkpoint_contents),
+      prefetchWarming(p.prefetch_warming),
+      prefetchIssueBatch(std::max(p.prefetch_issue_batch, 1u)),
+      prefetchMSHRShare(p.prefetch_mshr_share),
       blocked(0),
       order(0),
       noTargetMSHR(nullptr),
@@ -136,9 +147,8 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
     if (compressor)
         compressor->setCache(this);
 
-    if (!p.stats_pc_list.empty()) {
-        stats_pc_list = p.stats_pc_list;
-    }
+    stats_pc_index.init(p.stats_pc_list, p.stats_pc_auto,
+                        p.stats_pc_auto_misses);
 }
 
 BaseCache::~BaseCache()
@@ -214,6 +224,37 @@ BaseCache::getPort(const std::string &if_name, PortID idx)
     }
 }
 
+void
+BaseCache::schedulePrefetch()
+{
+    if (!prefetcher || !mshrQueue.canPrefetch() || isBlocked()) {
+        return;
+    }
+    Tick next_pf_time = prefetcher->nextPrefetchReadyTime();
+    if (next_pf_time != MaxTick) {
+        schedMemSideSendEvent(std::max(next_pf_time, clockEdge()));
+    }
+}
+
+bool
+BaseCache::setRuntimeParam(const std::string &name, const std::string &value)
+{
+    unsigned new_value;
+    if (!to_number(value, new_value)) {
+        return false;
+    }
+    if (name == "mshrs") {
+        return mshrQueue.setNumEntries(new_value);
+    } else if (name == "prefetch_issue_batch") {
+        prefetchIssueBatch = std::max(new_value, 1u);
+        return true;
+    } else if (name == "prefetch_mshr_share") {
+        prefetchMSHRShare = new_value;
+        return true;
+    }
+    return false;
+}
+
 bool
 BaseCache::inRange(Addr addr) const
 {
@@ -250,7 +291,7 @@ BaseCache::handleTimingReqHit(PacketPtr pkt, CacheBlk *blk, Tick request_time)
             // Basically we need to get the MSHR in the same state as if
             // we had missed and just received the response.
             // Request *req2 = new Request(*(pkt->req));
-            RequestPtr req2 = std::make_shared<Request>(*(pkt->req));
+            RequestPtr req2 = Request::create(*(pkt->req));
             PacketPtr pkt2 = new Packet(req2, pkt->cmd);
             MSHR *mshr = allocateMissBuffer(pkt2, curTick(), true);
             // Mark the MSHR "in service" (even though it's not) to prevent
@@ -346,11 +387,8 @@ BaseCache::handleTimingReqMiss(PacketPtr pkt, MSHR *mshr, CacheBlk *blk,
 
                 if (pkt->req->hasPC()) {
                     Addr req_pc = pkt->req->getPC();
-                    for (int i = 0; i < stats_pc_list.size(); i++) {
-                        if (req_pc == stats_pc_list[i]) {
-                            stats.cmdStats(pkt).mshrHitsPerPC[i]++;
-                            break;
-                        }
+                    if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                        stats.cmdStats(pkt).mshrHitsPerPC[i]++;
                     }
                 }
 
@@ -361,12 +399,9 @@ BaseCache::handleTimingReqMiss(PacketPtr pkt, MSHR *mshr, CacheBlk *blk,
 
                         stats.cmdStats(pkt).mshrHitsAtPf[pkt->req->requestorId()]++;
                         if (pkt->req->hasPC()) {
-                            for (int i = 0; i < stats_pc_list.size(); i++) {
-                                Addr req_pc = pkt->req->getPC();
-                                if (req_pc == stats_pc_list[i]) {
-                                    stats.cmdStats(pkt).mshrHitsAtPfPerPC[i]++;
-                                    break;
-                                }
+                            Addr req_pc = pkt->req->getPC();
+                            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                                stats.cmdStats(pkt).mshrHitsAtPfPerPC[i]++;
                             }
                         }
 
@@ -406,11 +441,8 @@ BaseCache::handleTimingReqMiss(PacketPtr pkt, MSHR *mshr, CacheBlk *blk,
 
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    stats.cmdStats(pkt).mshrMissesPerPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                stats.cmdStats(pkt).mshrMissesPerPC[i]++;
             }
         }
 
@@ -701,6 +733,10 @@ BaseCache::recvAtomic(PacketPtr pkt)
     PacketList writebacks;
     bool satisfied = access(pkt, blk, lat, writebacks);
 
+    if (prefetchWarming && satisfied) {
+        ppHit->notify(pkt);
+    }
+
     if (pkt->isClean() && blk && blk->isSet(CacheBlk::DirtyBit)) {
         // A cache clean opearation is looking for a dirty
         // block. If a dirty block is encountered a WriteClean
@@ -720,18 +756,24 @@ BaseCache::recvAtomic(PacketPtr pkt)
 
     if (!satisfied) {
         lat += handleAtomicReqMiss(pkt, blk, writebacks);
+
+        if (prefetchWarming) {
+            ppMiss->notify(pkt);
+        }
     }
 
-    // Note that we don't invoke the prefetcher at all in atomic mode.
+    // Note that we don't issue prefetches at all in atomic mode.
     // It's not clear how to do it properly, particularly for
     // prefetchers that aggressively generate prefetch candidates and
     // rely on bandwidth contention to throttle them; these will tend
     // to pollute the cache in atomic mode since there is no bandwidth
-    // contention.  If we ever do want to enable prefetching in atomic
-    // mode, though, this is the place to do it... see timingAccess()
-    // for an example (though we'd want to issue the prefetch(es)
-    // immediately rather than calling requestMemSideBus() as we do
-    // there).
+    // contention.  With prefetchWarming the prefetcher still observes
+    // the accesses above, so that its tables are trained when switching
+    // to timing mode, but the prefetches it generates are dropped.  If
+    // we ever do want to enable prefetching in atomic mode, though,
+    // this is the place to do it... see timingAccess() for an example
+    // (though we'd want to issue the prefetch(es) immediately rather
+    // than calling requestMemSideBus() as we do there).
 
     // do any writebacks resulting from the response handling
     doWritebacksAtomic(writebacks);
@@ -910,6 +952,20 @@ BaseCache::getNextQueueEntry()
     MSHR *miss_mshr  = mshrQueue.getNext();
     WriteQueueEntry *wq_entry = writeBuffer.getNext();
 
+    // prefetches within their MSHR share go ahead of ready misses, so a
+    // burst of misses does not starve them
+    if (miss_mshr && !(wq_entry && writeBuffer.isFull()) &&
+        prefetchMSHRShare > 0 && prefetcher && mshrQueue.canPrefetch() &&
+        !isBlocked() && prefetcher->nextPrefetchReadyTime() <= curTick() &&
+        mshrQueue.numPrefetches() < prefetchMSHRShare) {
+        if (MSHR *pf_mshr = getNextPrefetch()) {
+            DPRINTF(RequestSlot, "[Ready] Prefetch ahead of MSHR: %s\n",
+                    miss_mshr->print());
+            stats.prefetchesAheadOfDemand++;
+            return pf_mshr;
+        }
+    }
+
     // If we got a write buffer request ready, first priority is a
     // full write buffer, otherwise we favour the miss requests
     if (wq_entry && (writeBuffer.isFull() || !miss_mshr)) {
@@ -968,53 +1024,61 @@ BaseCache::getNextQueueEntry()
     // do prefetch try
     if (prefetcher && mshrQueue.canPrefetch() && !isBlocked()) {
         // If we have a miss queue slot, we can try a prefetch
-        PacketPtr pkt = prefetcher->getPacket();
-        if (pkt) {
-            Addr pf_addr = pkt->getBlockAddr(blkSize);
-            if (tags->findBlock(pf_addr, pkt->isSecure())) {
-                DPRINTF(HWPrefetch, "Prefetch %#x has hit in cache, "
-                        "dropped.\n", pf_addr);
-                DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
-                prefetcher->pfHitInCache(pkt);
+        return getNextPrefetch();
+    }
 
-                CacheBlk* try_cache_blk = getCacheBlk(pf_addr, false);
+    return nullptr;
+}
 
-                if (try_cache_blk != nullptr && try_cache_blk->data) {
-                    prefetcher->notifyFill(pkt, try_cache_blk->data);
-                }
+MSHR *
+BaseCache::getNextPrefetch()
+{
+    for (unsigned tried = 0; tried < prefetchIssueBatch; tried++) {
+        PacketPtr pkt = prefetcher->getPacket();
+        if (!pkt) {
+            DPRINTF(RequestSlot, "[Failed] No available prefetch pkt\n");
+            return nullptr;
+        }
 
-                // free the request and packet
-                delete pkt;
-            } else if (mshrQueue.findMatch(pf_addr, pkt->isSecure())) {
-                DPRINTF(HWPrefetch, "Prefetch %#x has hit in a MSHR, "
-                        "dropped.\n", pf_addr);
-                DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
-                prefetcher->pfHitInMSHR(pkt);
-                // free the request and packet
-                delete pkt;
-            } else if (writeBuffer.findMatch(pf_addr, pkt->isSecure())) {
-                DPRINTF(HWPrefetch, "Prefetch %#x has hit in the "
-                        "Write Buffer, dropped.\n", pf_addr);
-                DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
-                prefetcher->pfHitInWB(pkt);
-                // free the request and packet
-                delete pkt;
-            } else {
-                // Update statistic on number of prefetches issued
-                // (hwpf_mshr_misses)
-                assert(pkt->req->requestorId() < system->maxRequestors());
-                stats.cmdStats(pkt).mshrMisses[pkt->req->requestorId()]++;
+        Addr pf_addr = pkt->getBlockAddr(blkSize);
+        if (tags->findBlock(pf_addr, pkt->isSecure())) {
+            DPRINTF(HWPrefetch, "Prefetch %#x has hit in cache, "
+                    "dropped.\n", pf_addr);
+            DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
+            prefetcher->pfHitInCache(pkt);
+
+            CacheBlk* try_cache_blk = getCacheBlk(pf_addr, false);
 
-                // allocate an MSHR and return it, note
-                // that we send the packet straight away, so do not
-                // schedule the send
-                DPRINTF(RequestSlot, "[Ready] Prefetch chance: may drop, check debug::HWPrefetch\n");
-                return allocateMissBuffer(pkt, curTick(), false);
+            if (try_cache_blk != nullptr && try_cache_blk->data) {
+                prefetcher->notifyFill(pkt, try_cache_blk->data);
             }
+        } else if (mshrQueue.findMatch(pf_addr, pkt->isSecure())) {
+            DPRINTF(HWPrefetch, "Prefetch %#x has hit in a MSHR, "
+                    "dropped.\n", pf_addr);
+            DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
+            prefetcher->pfHitInMSHR(pkt);
+        } else if (writeBuffer.findMatch(pf_addr, pkt->isSecure())) {
+            DPRINTF(HWPrefetch, "Prefetch %#x has hit in the "
+                    "Write Buffer, dropped.\n", pf_addr);
+            DPRINTF(RequestSlot, "[Failed] Prefetch droped\n");
+            prefetcher->pfHitInWB(pkt);
         } else {
-            //break;
-            DPRINTF(RequestSlot, "[Failed] No available prefetch pkt\n");
+            // Update statistic on number of prefetches issued
+            // (hwpf_mshr_misses)
+            assert(pkt->req->requestorId() < system->maxRequestors());
+            stats.cmdStats(pkt).mshrMisses[pkt->req->requestorId()]++;
+
+            // allocate an MSHR and return it, note
+            // that we send the packet straight away, so do not
+            // schedule the send
+            DPRINTF(RequestSlot, "[Ready] Prefetch chance: may drop, check debug::HWPrefetch\n");
+            return allocateMissBuffer(pkt, curTick(), false);
         }
+
+        // free the request and packet of the redundant prefetch, and
+        // try the next one of the batch
+        stats.prefetchesDroppedAtIssue++;
+        delete pkt;
     }
 
     return nullptr;
@@ -1783,7 +1847,7 @@ BaseCache::writebackBlk(CacheBlk *blk)
 
     stats.writebacks[Request::wbRequestorId]++;
 
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         regenerateBlkAddr(blk), blkSize, 0, Request::wbRequestorId);
 
     if (blk->isSecure())
@@ -1826,7 +1890,7 @@ BaseCache::writebackBlk(CacheBlk *blk)
 PacketPtr
 BaseCache::writecleanBlk(CacheBlk *blk, Request::Flags dest, PacketId id)
 {
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         regenerateBlkAddr(blk), blkSize, 0, Request::wbRequestorId);
 
     if (blk->isSecure()) {
@@ -1900,7 +1964,7 @@ BaseCache::writebackVisitor(CacheBlk &blk)
     if (blk.isSet(CacheBlk::DirtyBit)) {
         assert(blk.isValid());
 
-        RequestPtr request = std::make_shared<Request>(
+        RequestPtr request = Request::create(
             regenerateBlkAddr(&blk), blkSize, 0, Request::funcRequestorId);
 
         request->taskId(blk.getTaskId());
@@ -2088,6 +2152,36 @@ BaseCache::serialize(CheckpointOut &cp) const
 {
     bool dirty(isDirty());
 
+    if (checkpointContents) {
+        // all the contents, dirty data included, go to a side file
+        std::string contents_file = name() + ".tags";
+        DPRINTF(Checkpoint, "Serializing the contents of %s to %s\n",
+                name(), contents_file);
+
+        std::ostringstream contents;
+        tags->serializeContents(contents);
+        const std::string &buf = contents.str();
+        fatal_if(buf.size() > INT_MAX, "%s: contents too large to "
+                 "checkpoint\n", name());
+
+        std::string filepath = CheckpointIn::dir() + "/" + contents_file;
+        gzFile compressed = gzopen(filepath.c_str(), "wb");
+        fatal_if(!compressed, "Can't open cache checkpoint file '%s'\n",
+                 contents_file);
+        fatal_if(gzwrite(compressed, buf.data(), buf.size()) !=
+                 (int)buf.size(), "Write failed on cache checkpoint file "
+                 "'%s'\n", contents_file);
+        fatal_if(gzclose(compressed), "Close failed on cache checkpoint "
+                 "file '%s'\n", contents_file);
+
+        SERIALIZE_SCALAR(contents_file);
+        bool contents_dirty(dirty);
+        SERIALIZE_SCALAR(contents_dirty);
+        bool bad_checkpoint(false);
+        SERIALIZE_SCALAR(bad_checkpoint);
+        return;
+    }
+
     if (dirty) {
         warn("*** The cache still contains dirty data. ***\n");
         warn("    Make sure to drain the system using the correct flags.\n");
@@ -2113,6 +2207,41 @@ BaseCache::unserialize(CheckpointIn &cp)
               "supported in the classic memory system. Please remove any "
               "caches or drain them properly before taking checkpoints.\n");
     }
+
+    std::string contents_file;
+    if (!optParamIn(cp, "contents_file", contents_file, false)) {
+        return;
+    }
+
+    if (!checkpointContents) {
+        // the cache restores cold, which loses its dirty data
+        bool contents_dirty;
+        UNSERIALIZE_SCALAR(contents_dirty);
+        fatal_if(contents_dirty, "%s: the checkpoint has dirty data in the "
+                 "cache, set checkpoint_contents to restore it\n", name());
+        return;
+    }
+
+    DPRINTF(Checkpoint, "Unserializing the contents of %s from %s\n",
+            name(), contents_file);
+
+    std::string filepath = cp.getCptDir() + "/" + contents_file;
+    gzFile compressed = gzopen(filepath.c_str(), "rb");
+    fatal_if(!compressed, "Can't open cache checkpoint file '%s'\n",
+             contents_file);
+    std::string buf;
+    char chunk[16384];
+    int bytes_read;
+    while ((bytes_read = gzread(compressed, chunk, sizeof(chunk))) > 0) {
+        buf.append(chunk, bytes_read);
+    }
+    fatal_if(bytes_read < 0, "Read failed on cache checkpoint file '%s'\n",
+             contents_file);
+    fatal_if(gzclose(compressed), "Close failed on cache checkpoint file "
+             "'%s'\n", contents_file);
+
+    std::istringstream contents(buf);
+    tags->unserializeContents(contents);
 }
 
 
@@ -2188,10 +2317,7 @@ BaseCache::CacheCmdStats::regStatsFromParent()
     System *system = cache.system;
     const auto max_requestors = system->maxRequestors();
       
-    const int max_per_pc = 32;
-    std::vector<Addr> stats_pc_list = cache.stats_pc_list;
-
-    assert(stats_pc_list.size() < max_per_pc);
+    const int max_per_pc = cache.stats_pc_index.statSize();
 
     hits
         .init(max_requestors)
@@ -2355,21 +2481,18 @@ BaseCache::CacheCmdStats::regStatsFromParent()
     accessesPerPC.flags(nozero | nonan);
     accessesPerPC = hitsPerPC + missesPerPC;
 
-    for (int i = 0; i < stats_pc_list.size(); i++) {
-        std::stringstream stream;
-        stream << std::hex << stats_pc_list[i];
-        std::string pc_hex = stream.str();
-
-        hitsPerPC.subname(i, pc_hex);
-        hitsAtPfPerPC.subname(i, pc_hex);
-        hitsAtPfAllocPerPC.subname(i, pc_hex);
-        missesPerPC.subname(i, pc_hex);
-        accessesPerPC.subname(i, pc_hex);
-        mshrHitsPerPC.subname(i, pc_hex);
-        mshrHitsAtPfPerPC.subname(i, pc_hex);
-        mshrMissesPerPC.subname(i, pc_hex);
-        mshrUncacheablePerPC.subname(i, pc_hex);
-    }
+    cache.stats_pc_index.addNamer(
+        [this](int i, const std::string &pc_hex) {
+            hitsPerPC.subname(i, pc_hex);
+            hitsAtPfPerPC.subname(i, pc_hex);
+            hitsAtPfAllocPerPC.subname(i, pc_hex);
+            missesPerPC.subname(i, pc_hex);
+            accessesPerPC.subname(i, pc_hex);
+            mshrHitsPerPC.subname(i, pc_hex);
+            mshrHitsAtPfPerPC.subname(i, pc_hex);
+            mshrMissesPerPC.subname(i, pc_hex);
+            mshrUncacheablePerPC.subname(i, pc_hex);
+        });
 
 }
 
@@ -2484,6 +2607,10 @@ BaseCache::CacheStats::CacheStats(BaseCache &c)
              "number of replacements"),
     ADD_STAT(prefetchFills, statistics::units::Count::get(),
              "number of prefetch fills"),
+    ADD_STAT(prefetchesAheadOfDemand, statistics::units::Count::get(),
+             "number of prefetches issued ahead of a ready demand miss"),
+    ADD_STAT(prefetchesDroppedAtIssue, statistics::units::Count::get(),
+             "number of redundant prefetches dropped at issue"),
     ADD_STAT(dataExpansions, statistics::units::Count::get(),
              "number of data expansions"),
     ADD_STAT(dataContractions, statistics::units::Count::get(),
@@ -2504,11 +2631,6 @@ BaseCache::CacheStats::regStats()
     System *system = cache.system;
     const auto max_requestors = system->maxRequestors();
 
-    const int max_per_pc = 32;
-    std::vector<Addr> stats_pc_list = cache.stats_pc_list;
-
-    assert(stats_pc_list.size() < max_per_pc);
-
     for (auto &cs : cmd)
         cs->regStatsFromParent();
 
@@ -2786,24 +2908,21 @@ BaseCache::CacheStats::regStats()
     hitsPfRatioPerPC = demandHitsAtPfAllocPerPC / demandHitsAtPfPerPC;
 
     // PerPC stats
-    for (int i = 0; i < stats_pc_list.size(); i++) {
-        std::stringstream stream;
-        stream << std::hex << stats_pc_list[i];
-        std::string pc_hex = stream.str();
-
-        demandHitsPerPC.subname(i, pc_hex);
-        demandHitsAtPfPerPC.subname(i, pc_hex);
-        demandHitsAtPfAllocPerPC.subname(i, pc_hex);
-        hitsAtPfCoverAccessPerPC.subname(i, pc_hex);
-        hitsAtPfAllocCoverAccessPerPC.subname(i, pc_hex);
-        hitsPfRatioPerPC.subname(i, pc_hex);
-        demandMissesPerPC.subname(i, pc_hex);
-        demandAccessesPerPC.subname(i, pc_hex);
-        demandMissRatePerPC.subname(i, pc_hex);
-        demandMshrHitsPerPC.subname(i, pc_hex);
-        demandMshrHitsAtPfPerPC.subname(i, pc_hex);
-        demandMshrMissesPerPC.subname(i, pc_hex);
-    }
+    cache.stats_pc_index.addNamer(
+        [this](int i, const std::string &pc_hex) {
+            demandHitsPerPC.subname(i, pc_hex);
+            demandHitsAtPfPerPC.subname(i, pc_hex);
+            demandHitsAtPfAllocPerPC.subname(i, pc_hex);
+            hitsAtPfCoverAccessPerPC.subname(i, pc_hex);
+            hitsAtPfAllocCoverAccessPerPC.subname(i, pc_hex);
+            hitsPfRatioPerPC.subname(i, pc_hex);
+            demandMissesPerPC.subname(i, pc_hex);
+            demandAccessesPerPC.subname(i, pc_hex);
+            demandMissRatePerPC.subname(i, pc_hex);
+            demandMshrHitsPerPC.subname(i, pc_hex);
+            demandMshrHitsAtPfPerPC.subname(i, pc_hex);
+            demandMshrMissesPerPC.subname(i, pc_hex);
+        });
 
 }
 
@@ -2886,6 +3005,13 @@ BaseCache::CpuSidePort::recvAtomic(PacketPtr pkt)
     if (cache->system->bypassCaches()) {
         // Forward the request if the system is in cache bypass mode.
         return cache->memSidePort.sendAtomic(pkt);
+    } else if (cache->prefetchWarming) {
+        cache->ppL1Req->notify(pkt);
+        Tick latency = cache->recvAtomic(pkt);
+        if (pkt->isResponse()) {
+            cache->ppL1Resp->notify(pkt);
+        }
+        return latency;
     } else {
         return cache->recvAtomic(pkt);
     }
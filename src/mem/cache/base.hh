@@ -61,6 +61,7 @@
 #include "mem/cache/cache_blk.hh"
 #include "mem/cache/compressors/base.hh"
 #include "mem/cache/mshr_queue.hh"
+#include "mem/cache/pc_stats_index.hh"
 #include "mem/cache/tags/base.hh"
 #include "mem/cache/write_queue.hh"
 #include "mem/cache/write_queue_entry.hh"
@@ -649,6 +650,14 @@ class BaseCache : public ClockedObject
      */
     QueueEntry* getNextQueueEntry();
 
+    /**
+     * Pick the next prefetch to issue and allocate its MSHR. Up to
+     * prefetchIssueBatch queued prefetches are tried in priority order,
+     * the redundant ones are dropped.
+     * @return the MSHR of the prefetch, or nullptr if there is none
+     */
+    MSHR *getNextPrefetch();
+
     /**
      * Insert writebacks into the write buffer
      */
@@ -971,6 +980,28 @@ class BaseCache : public ClockedObject
      */
     const bool moveContractions;
 
+    /** Whether the contents of the cache are saved in checkpoints. */
+    const bool checkpointContents;
+
+    /**
+     * Whether atomic accesses notify the probes the prefetcher listens
+     * to, which trains it during fast-forward (functional warming).
+     */
+    const bool prefetchWarming;
+
+    /**
+     * Queued prefetches checked per issue slot, so redundant ones (in
+     * the tags, an MSHR or the write buffer) do not use up the slot.
+     */
+    unsigned prefetchIssueBatch;
+
+    /**
+     * MSHRs prefetches may occupy ahead of ready demand misses. Below
+     * it, a ready prefetch takes the issue slot even if a miss is ready,
+     * so prefetches are not starved during miss bursts.
+     */
+    unsigned prefetchMSHRShare;
+
     /**
      * Bit vector of the blocking reasons for the access path.
      * @sa #BlockedCause
@@ -1190,6 +1221,12 @@ class BaseCache : public ClockedObject
         /** Number of prefetch blocks filled */
         statistics::Scalar prefetchFills;
 
+        /** Number of prefetches issued ahead of a ready demand miss */
+        statistics::Scalar prefetchesAheadOfDemand;
+
+        /** Number of redundant prefetches dropped at issue */
+        statistics::Scalar prefetchesDroppedAtIssue;
+
         /** Number of data expansions. */
         statistics::Scalar dataExpansions;
 
@@ -1203,7 +1240,8 @@ class BaseCache : public ClockedObject
         std::vector<std::unique_ptr<CacheCmdStats>> cmd;
     } stats;
 
-    std::vector<Addr> stats_pc_list;
+    /** PCs with per-PC statistics */
+    PCStatsIndex stats_pc_index;
 
     /** Registers probes. */
     void regProbePoints() override;
@@ -1279,6 +1317,24 @@ class BaseCache : public ClockedObject
         schedMemSideSendEvent(time);
     }
 
+    /**
+     * Schedule the issue of the prefetches the prefetcher queued outside
+     * of an access, e.g. when a translation or a delayed notification
+     * completes.
+     */
+    void schedulePrefetch();
+
+    /**
+     * Change a parameter of an instantiated cache, e.g. in the children
+     * of a forked parameter sweep. Accepts "mshrs", which can only be
+     * lowered, "prefetch_issue_batch" and "prefetch_mshr_share".
+     * @param name name of the parameter, as in the Python class
+     * @param value new value of the parameter
+     * @return false if the parameter can't be changed or the value is
+     *         invalid
+     */
+    bool setRuntimeParam(const std::string &name, const std::string &value);
+
     /**
      * Returns true if the cache is blocked for accesses.
      */
@@ -1369,11 +1425,11 @@ class BaseCache : public ClockedObject
 
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    stats.cmdStats(pkt).missesPerPC[i]++;
-                    break;
-                }
+            if (pkt->isDemand()) {
+                stats_pc_index.discover(req_pc);
+            }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                stats.cmdStats(pkt).missesPerPC[i]++;
             }
         }
     }
@@ -1394,21 +1450,15 @@ class BaseCache : public ClockedObject
 
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-
-                if (req_pc == stats_pc_list[i]) {
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                stats.cmdStats(pkt).hitsPerPC[i]++;
 
-                    stats.cmdStats(pkt).hitsPerPC[i]++;
-
-                    if (prefetcher && blk->wasPrefetched()) {
-                        stats.cmdStats(pkt).hitsAtPfPerPC[i]++;
-                    }
-
-                    if (prefetcher && blk->fromPrefetched()) {
-                        stats.cmdStats(pkt).hitsAtPfAllocPerPC[i]++;
-                    }
+                if (prefetcher && blk->wasPrefetched()) {
+                    stats.cmdStats(pkt).hitsAtPfPerPC[i]++;
+                }
 
-                    break;
+                if (prefetcher && blk->fromPrefetched()) {
+                    stats.cmdStats(pkt).hitsAtPfAllocPerPC[i]++;
                 }
             }
         }
@@ -1459,7 +1509,9 @@ class BaseCache : public ClockedObject
     /**
      * Serialize the state of the caches
      *
-     * We currently don't support checkpointing cache state, so this panics.
+     * The contents of the cache are only saved, to a side file of the
+     * checkpoint, if checkpointContents is set. Otherwise the cache
+     * restores cold, and checkpoints of dirty caches cannot be restored.
      */
     void serialize(CheckpointOut &cp) const override;
     void unserialize(CheckpointIn &cp) override;
@@ -68,6 +68,16 @@ CacheBlk::insert(const Addr tag, const bool is_secure,
     increaseRefCount();
 }
 
+void
+CacheBlk::restore(const unsigned coherence_bits, const unsigned ref_count)
+{
+    assert(isValid());
+
+    setCoherenceBits(coherence_bits);
+    setRefCount(ref_count);
+    setWhenReady(curTick());
+}
+
 void
 CacheBlkPrintWrapper::print(std::ostream &os, int verbosity,
                             const std::string &prefix) const
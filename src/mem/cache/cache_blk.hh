@@ -267,7 +267,7 @@ class CacheBlk : public TaggedEntry
 
     void setPrefetchedAllocate() { _prefetched_allocate = true; };
 
-    Addr getPC() { return _src_pc; };
+    Addr getPC() const { return _src_pc; };
 
     void setPC(Addr pc) { _src_pc = pc; };
 
@@ -336,6 +336,15 @@ class CacheBlk : public TaggedEntry
         const int src_requestor_ID, const uint32_t task_ID);
     using TaggedEntry::insert;
 
+    /**
+     * Set the state of a block restored from a checkpoint of the cache
+     * contents, once inserted. The block is ready at the current tick.
+     *
+     * @param coherence_bits The coherence bits of the block.
+     * @param ref_count Number of references to the block since insertion.
+     */
+    void restore(const unsigned coherence_bits, const unsigned ref_count);
+
     /**
      * Track the fact that a local locked was issued to the
      * block. Invalidate any previous LL to the same address.
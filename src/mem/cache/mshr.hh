@@ -423,6 +423,48 @@ class MSHR : public QueueEntry, public Printable
 
     void clearDownstreamPending();
 
+    /**
+     * The request is buffered on its way downstream by a component
+     * which is not a cache, e.g. a QuantumBridge, so that snoops are
+     * ordered before it until it is forwarded.
+     */
+    void
+    setDownstreamPending()
+    {
+        assert(!downstreamPending);
+        downstreamPending = true;
+    }
+
+    /**
+     * Forward the request buffered after setDownstreamPending(). The
+     * flag is cleared before the request is sent, as the next cache may
+     * buffer it in turn, and forwardedDownstream() is called with the
+     * outcome. Both are called within the event queue of the cache of
+     * this MSHR, the send is not, as the caches below may snoop it.
+     */
+    void
+    forwardingDownstream()
+    {
+        assert(downstreamPending);
+        downstreamPending = false;
+    }
+
+    /**
+     * @param accepted If the request was accepted, otherwise it stays
+     *                 pending
+     */
+    void
+    forwardedDownstream(bool accepted)
+    {
+        if (!accepted) {
+            downstreamPending = true;
+        } else if (!downstreamPending) {
+            // unless buffered again, the request made it to a level where
+            // it is going to get a response, like in markInService()
+            targets.clearDownstreamPending();
+        }
+    }
+
     /**
      * Mark this MSHR as free.
      */
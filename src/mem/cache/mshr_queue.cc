@@ -148,4 +148,17 @@ MSHRQueue::forceDeallocateTarget(MSHR *mshr)
     return was_full && !isFull();
 }
 
+int
+MSHRQueue::numPrefetches() const
+{
+    int count = 0;
+    for (MSHR *mshr : allocatedList) {
+        // late prefetches keep the prefetch as first target
+        if (mshr->hasTargets() && mshr->getTarget()->pkt->cmd.isHWPrefetch()) {
+            count++;
+        }
+    }
+    return count;
+}
+
 } // namespace gem5
@@ -151,6 +151,12 @@ class MSHRQueue : public Queue<MSHR>
         return !readyList.empty();
     }
 
+    /**
+     * Number of MSHRs allocated for a prefetch which are still
+     * outstanding.
+     */
+    int numPrefetches() const;
+
     /**
      * Returns true if sufficient mshrs for prefetch.
      * @return True if sufficient mshrs for prefetch.
@@ -0,0 +1,141 @@
+/**
+ * PC to index mapping of the per-PC statistics of caches and prefetchers
+ */
+
+#ifndef __MEM_CACHE_PC_STATS_INDEX_HH__
+#define __MEM_CACHE_PC_STATS_INDEX_HH__
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Maps the monitored PCs of an object to the index of their element in
+ * its per-PC statistics vectors, with one hash lookup per event.
+ *
+ * The monitored PCs are the configured list, in order, followed by up
+ * to auto_pcs PCs discovered at run time: a PC is added once it has been
+ * reported auto_threshold times through discover() (e.g. on demand
+ * misses), so the PCs missing the most early on fill the free elements.
+ *
+ * Statistics are sized with statSize() and named through the namers
+ * registered with addNamer(), which are called again whenever a PC is
+ * discovered, so the subnames of discovered PCs are created lazily.
+ */
+class PCStatsIndex
+{
+  public:
+    using Namer = std::function<void(int, const std::string &)>;
+
+  private:
+    std::unordered_map<Addr, int> slots;
+    std::vector<Addr> pcs;
+
+    unsigned maxPCs;
+    unsigned autoThreshold;
+
+    /** Reports of the PCs not monitored yet */
+    std::unordered_map<Addr, unsigned> candidates;
+
+    /** Observers only, so they may be added through a const index */
+    mutable std::vector<Namer> namers;
+
+    void
+    name(int slot)
+    {
+        const std::string pc_name = pcName(pcs[slot]);
+        for (auto &namer : namers) {
+            namer(slot, pc_name);
+        }
+    }
+
+  public:
+    PCStatsIndex() : maxPCs(0), autoThreshold(1) {}
+
+    /**
+     * @param pc_list PCs monitored from the start
+     * @param auto_pcs number of PCs to discover at run time
+     * @param auto_threshold reports of a PC before it is monitored
+     */
+    void
+    init(const std::vector<Addr> &pc_list, unsigned auto_pcs = 0,
+         unsigned auto_threshold = 1)
+    {
+        slots.clear();
+        candidates.clear();
+        pcs = pc_list;
+        for (int i = 0; i < (int)pcs.size(); i++) {
+            // a repeated PC keeps its first element
+            slots.emplace(pcs[i], i);
+        }
+        maxPCs = pcs.size() + auto_pcs;
+        autoThreshold = std::max(auto_threshold, 1u);
+        for (int i = 0; i < (int)pcs.size(); i++) {
+            name(i);
+        }
+    }
+
+    /** Number of elements the per-PC statistics need */
+    unsigned statSize() const { return std::max(maxPCs, 1u); }
+
+    /** Monitored PCs, by element */
+    const std::vector<Addr> &getPCs() const { return pcs; }
+
+    bool full() const { return pcs.size() >= maxPCs; }
+
+    /** Element of a PC, or -1 if it is not monitored */
+    int
+    find(Addr pc) const
+    {
+        if (slots.empty()) return -1;
+        auto it = slots.find(pc);
+        return it == slots.end() ? -1 : it->second;
+    }
+
+    /** Report an event of a PC, which may make it monitored */
+    void
+    discover(Addr pc)
+    {
+        if (full() || slots.count(pc)) return;
+        if (++candidates[pc] < autoThreshold) return;
+
+        const int slot = pcs.size();
+        pcs.push_back(pc);
+        slots.emplace(pc, slot);
+        candidates.erase(pc);
+        if (full()) {
+            candidates.clear();
+        }
+        name(slot);
+    }
+
+    /** Name elements with namer, now and as PCs are discovered */
+    void
+    addNamer(Namer namer) const
+    {
+        namers.push_back(std::move(namer));
+        for (int i = 0; i < (int)pcs.size(); i++) {
+            namers.back()(i, pcName(pcs[i]));
+        }
+    }
+
+    static std::string
+    pcName(Addr pc)
+    {
+        std::stringstream stream;
+        stream << std::hex << pc;
+        return stream.str();
+    }
+};
+
+} // namespace gem5
+
+#endif // __MEM_CACHE_PC_STATS_INDEX_HH__
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "mem/cache/pc_stats_index.hh"
+
+using namespace gem5;
+
+/** Configured PCs keep their order, a repeated PC its first element */
+TEST(PCStatsIndexTest, Configured)
+{
+    PCStatsIndex index;
+    index.init({0x400, 0x500, 0x400});
+
+    EXPECT_EQ(index.statSize(), 3u);
+    EXPECT_TRUE(index.full());
+    EXPECT_EQ(index.find(0x400), 0);
+    EXPECT_EQ(index.find(0x500), 1);
+    EXPECT_EQ(index.find(0x600), -1);
+
+    // nothing to discover into
+    index.discover(0x600);
+    index.discover(0x600);
+    EXPECT_EQ(index.find(0x600), -1);
+}
+
+/** Without PCs the statistics still get one element */
+TEST(PCStatsIndexTest, Empty)
+{
+    PCStatsIndex index;
+    EXPECT_EQ(index.statSize(), 1u);
+    EXPECT_EQ(index.find(0), -1);
+}
+
+/** PCs reaching the threshold first take the free elements */
+TEST(PCStatsIndexTest, Discover)
+{
+    PCStatsIndex index;
+    index.init({0x100}, 2, 3);
+    EXPECT_EQ(index.statSize(), 3u);
+
+    std::vector<std::string> names(3);
+    index.addNamer([&](int i, const std::string &name) { names[i] = name; });
+    EXPECT_EQ(names, std::vector<std::string>({"100", "", ""}));
+
+    index.discover(0x200);
+    index.discover(0x300);
+    index.discover(0x300);
+    index.discover(0x200);
+    EXPECT_EQ(index.find(0x300), -1);
+    index.discover(0x300);
+    EXPECT_EQ(index.find(0x300), 1);
+    EXPECT_EQ(names[1], "300");
+
+    // a monitored PC is not counted again
+    index.discover(0x100);
+    index.discover(0x100);
+    index.discover(0x100);
+    EXPECT_FALSE(index.full());
+
+    index.discover(0x200);
+    EXPECT_EQ(index.find(0x200), 2);
+    EXPECT_EQ(names, std::vector<std::string>({"100", "300", "200"}));
+    EXPECT_TRUE(index.full());
+}
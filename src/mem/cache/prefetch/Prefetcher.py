@@ -64,7 +64,11 @@ class BasePrefetcher(ClockedObject):
     abstract = True
     cxx_class = "gem5::prefetch::Base"
     cxx_header = "mem/cache/prefetch/base.hh"
-    cxx_exports = [PyBindMethod("addEventProbe"), PyBindMethod("addTLB")]
+    cxx_exports = [
+        PyBindMethod("addEventProbe"),
+        PyBindMethod("addTLB"),
+        PyBindMethod("setRuntimeParam"),
+    ]
     sys = Param.System(Parent.any, "System this prefetcher belongs to")
 
     # Get the block size from the parent (system)
@@ -91,6 +95,10 @@ class BasePrefetcher(ClockedObject):
     )
 
     stats_pc_list = VectorParam.Addr([], "Monitor PC list in stats")
+    stats_pc_auto = Param.Unsigned(0,
+        "Number of PCs added to the monitored PCs by their demand misses")
+    stats_pc_auto_misses = Param.Unsigned(16,
+        "Demand misses of a PC before it is monitored")
 
     def __init__(self, **kwargs):
         super().__init__(**kwargs)
@@ -158,6 +166,25 @@ class QueuedPrefetcher(BasePrefetcher):
 
     cross_page_ctrl = Param.Bool(False, "Control cross page prefetch")
 
+    # Translations of prefetches to the same page share one walk; the
+    # prefetcher TLB also keeps the pages of recent walks
+    use_pf_tlb = Param.Bool(
+        False, "Translate prefetches with a prefetcher TLB first"
+    )
+    pf_tlb_entries = Param.MemorySize(
+        "32", "Number of entries of the prefetcher TLB"
+    )
+    pf_tlb_assoc = Param.Unsigned(32, "Associativity of the prefetcher TLB")
+    pf_tlb_indexing_policy = Param.BaseIndexingPolicy(
+        SetAssociative(
+            entry_size=1, assoc=Parent.pf_tlb_assoc, size=Parent.pf_tlb_entries
+        ),
+        "Indexing policy of the prefetcher TLB",
+    )
+    pf_tlb_replacement_policy = Param.BaseReplacementPolicy(
+        LRURP(), "Replacement policy of the prefetcher TLB"
+    )
+
     # The throttle_control_percentage controls how many of the candidate
     # addresses generated by the prefetcher will be finally turned into
     # prefetch requests
@@ -706,6 +733,10 @@ class DiffMatchingPrefetcher(StridePrefetcher):
     cxx_header = "mem/cache/prefetch/diff_matching.hh"
     cxx_exports = [PyBindMethod("addPfHelper")]
                 
+    # range relations translate up to indir_range targets per filled line,
+    # mostly to the same pages
+    use_pf_tlb = True
+
     iq_ent_num = Param.Unsigned(16, "Number of entres of iq")
 
     iddt_ent_num = Param.Unsigned(8, "Number of entries of iddt")
@@ -716,6 +747,28 @@ class DiffMatchingPrefetcher(StridePrefetcher):
 
     rt_ent_num = Param.Unsigned(16, "Number of entries of rt")
 
+    partition_num = Param.Unsigned(
+        0,
+        "Number of private partitions of IDDT/TADT/ICS/RT, one per "
+        "context (or core). Remaining entries form a shared overflow "
+        "pool. 0 shares the whole tables among all contexts",
+    )
+    partition_by_core = Param.Bool(
+        False, "Select partitions by core id instead of ContextID"
+    )
+    iddt_part_ent_num = Param.Unsigned(
+        0, "Entries of each iddt partition, 0 for an even split with the pool"
+    )
+    tadt_part_ent_num = Param.Unsigned(
+        0, "Entries of each tadt partition, 0 for an even split with the pool"
+    )
+    ics_part_ent_num = Param.Unsigned(
+        0, "Entries of each ics partition, 0 for an even split with the pool"
+    )
+    rt_part_ent_num = Param.Unsigned(
+        0, "Entries of each rt partition, 0 for an even split with the pool"
+    )
+
     auto_detect = Param.Bool(True, "Start index_pc detecting or not")
     detect_period = Param.Unsigned(1000, "Cycles between index pc choosing")
 
@@ -736,7 +789,36 @@ class DiffMatchingPrefetcher(StridePrefetcher):
         16, "Size of indirect prefetch range, limited by Cache blkSize" 
     )
 
-    notify_latency = Param.Unsigned(0, "Notify triggered prefetch latency")
+    # L1 requests/responses and fills are matched against the tables
+    # notify_latency cycles after their probe, and the prefetches a fill
+    # triggers are generated the cycles after. 0 latency and 0 widths do
+    # all of it in the probe.
+    notify_latency = Param.Unsigned(
+        0, "Cycles between a probe and its handling by the tables"
+    )
+    match_width = Param.Unsigned(
+        0, "Probes matched against the tables per cycle, 0 for no limit"
+    )
+    pf_gen_width = Param.Unsigned(
+        0, "Indirect prefetches generated per cycle, 0 for no limit"
+    )
+    notify_queue_size = Param.Unsigned(
+        32, "Probes waiting to be matched, more are dropped"
+    )
+    pf_gen_queue_size = Param.Unsigned(
+        64, "Indirect prefetches waiting to be generated, more are dropped"
+    )
+
+    chain_depth = Param.Unsigned(
+        3,
+        "Number of chained indirect levels (e.g. 2 for A[B[C[i]]]) which "
+        "fills of DMP's own prefetches may trigger",
+    )
+    chain_lookahead = VectorParam.Unsigned(
+        [],
+        "Index elements dereferenced per filled line by range relations "
+        "of each chain level, the relation's range degree if not given",
+    )
 
     range_unit = Param.Unsigned(
         8, "Size of each range quantification unit"
@@ -746,26 +828,59 @@ class DiffMatchingPrefetcher(StridePrefetcher):
         4, "Number of total range quantification levels"
     )
 
+    throttle_period = Param.Unsigned(
+        32,
+        "Useful/late/unused feedback events of a relation between "
+        "adjustments of its throttle level, 0 disables throttling",
+    )
+    throttle_acc_high = Param.Float(
+        0.75, "Accuracy above which a relation is considered accurate"
+    )
+    throttle_acc_low = Param.Float(
+        0.40, "Accuracy below which a relation is throttled down"
+    )
+    throttle_late = Param.Float(
+        0.10, "Fraction of late used prefetches which throttles up"
+    )
+    throttle_init_level = Param.Unsigned(
+        3, "Initial throttle level of relations, in [1, 5]"
+    )
+
     index_pc_init = VectorParam.Addr([], "IDDT array init from config")
     target_pc_init = VectorParam.Addr([], "TADT array init from config")
     range_pc_init = VectorParam.Addr([], "RangeTable init from config")
 
+    # A hint file lists "index|target|range <pc>" lines, e.g. as written
+    # by a short run with record_hints, to train those PCs from the start
+    hint_file = Param.String("", "File of PCs to init the tables with")
+    record_hints = Param.Bool(
+        False, "Write the PCs of the learned relations to <name>.hints"
+    )
+
     def __init__(self, **kwargs):
         super().__init__(**kwargs)
-        self._monitor_simObj = NULL # Demand init by config
-        self._access_simObj = NULL # Demand init by config
-        self._fill_simObj = NULL # Demand init by config
+        # Demand init by config, one entry per core sharing this DMP
+        self._monitor_simObj = []
+        self._access_simObj = []
+        self._fill_simObj = []
         self._pf_helper = []
-    
-    def set_probe_obj(self, monitor_simObj, access_simObj, fill_simObj):
-        self._monitor_simObj = monitor_simObj
-        self._access_simObj = access_simObj
-        self._fill_simObj = fill_simObj
 
-    def set_pf_helper(self, simObj):
+    def set_probe_obj(self, monitor_simObj, access_simObj, fill_simObj):
+        # may be called once per core when DMP is in a shared cache
+        for objs, obj in (
+            (self._monitor_simObj, monitor_simObj),
+            (self._access_simObj, access_simObj),
+            (self._fill_simObj, fill_simObj),
+        ):
+            if obj and not any(o is obj for o in objs):
+                objs.append(obj)
+
+    def set_pf_helper(self, simObj, context_id=-1):
+        """Add a StridePrefetcher helper. context_id binds the helper to
+        the core issuing that ContextID, -1 lets it serve every core."""
         if not isinstance(simObj, SimObject):
             raise TypeError("argument must be a SimObject type")
-        self._pf_helper.append(simObj)
+        self._pf_helper.append((simObj, context_id))
 
     # Override BasePrefetcher::regProbeListeners
     # Register L1 request and response probelisteners
@@ -775,31 +890,35 @@ class DiffMatchingPrefetcher(StridePrefetcher):
             self.getCCObject().addTLB(tlb.getCCObject())
         
         # Add PfHelper
-        for pf_helper in self._pf_helper:
-            self.getCCObject().addPfHelper(pf_helper.getCCObject())
-        
+        for pf_helper, context_id in self._pf_helper:
+            self.getCCObject().addPfHelper(
+                pf_helper.getCCObject(), context_id
+            )
 
         # Add Trigger ProbeListener
-        self.getCCObject().addEventProbe(
-            self._access_simObj.getCCObject(), "Miss", False, True, False, False
-        ) 
-        self.getCCObject().addEventProbe(
-            self._fill_simObj.getCCObject(), "Fill", True, False, False, False
-        ) 
-        self.getCCObject().addEventProbe(
-            self._access_simObj.getCCObject(), "Hit", False, False, False, False
-        ) 
-
-        # Add Monitor ProbeListener
-        if self._monitor_simObj:
-            # Request to L1 ProbeListener
+        for access_simObj in self._access_simObj:
             self.getCCObject().addEventProbe(
-                self._monitor_simObj.getCCObject(), "Request", False, False, True, False
+                access_simObj.getCCObject(), "Miss", False, True, False, False
             ) 
-            # Response from L1 ProbeListener
             self.getCCObject().addEventProbe(
-                self._monitor_simObj.getCCObject(), "Response", False, False, False, True
-            )
+                access_simObj.getCCObject(), "Hit", False, False, False, False
+            ) 
+        for fill_simObj in self._fill_simObj:
+            self.getCCObject().addEventProbe(
+                fill_simObj.getCCObject(), "Fill", True, False, False, False
+            ) 
+
+        # Add Monitor ProbeListener
+        if self._monitor_simObj:
+            for monitor_simObj in self._monitor_simObj:
+                # Request to L1 ProbeListener
+                self.getCCObject().addEventProbe(
+                    monitor_simObj.getCCObject(), "Request", False, False, True, False
+                ) 
+                # Response from L1 ProbeListener
+                self.getCCObject().addEventProbe(
+                    monitor_simObj.getCCObject(), "Response", False, False, False, True
+                )
         else:
             print("No valid Monitor SimObj !")
         self.getCCObject().regProbeListeners()
\ No newline at end of file
@@ -106,6 +106,13 @@ class AssociativeSet
      */
     std::vector<Entry *> getPossibleEntries(const Addr addr) const;
 
+    /**
+     * Regenerate the key an entry was inserted with
+     * @param entry pointer to a valid entry of this container
+     * @result key of the entry
+     */
+    Addr regenerateAddr(const Entry *entry) const;
+
     /**
      * Indicate that an entry has just been inserted
      * @param addr key of the container
@@ -108,6 +108,13 @@ AssociativeSet<Entry>::getPossibleEntries(const Addr addr) const
     return entries;
 }
 
+template<class Entry>
+Addr
+AssociativeSet<Entry>::regenerateAddr(const Entry *entry) const
+{
+    return indexingPolicy->regenerateAddr(entry->getTag(), entry);
+}
+
 template<class Entry>
 void
 AssociativeSet<Entry>::insertEntry(Addr addr, bool is_secure, Entry* entry)
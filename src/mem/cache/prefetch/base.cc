@@ -48,6 +48,7 @@
 #include <cassert>
 
 #include "base/intmath.hh"
+#include "base/str.hh"
 #include "mem/cache/base.hh"
 #include "params/BasePrefetcher.hh"
 #include "debug/HWPrefetch.hh"
@@ -65,15 +66,19 @@ Base::PrefetchInfo::PrefetchInfo(PacketPtr pkt, Addr addr, bool miss)
     requestorId(pkt->req->requestorId()), validPC(pkt->req->hasPC()),
     secure(pkt->isSecure()), size(pkt->req->getSize()), write(pkt->isWrite()),
     paddress(pkt->req->getPaddr()), cacheMiss(miss), 
-    cID(pkt->req->hasContextId() ? pkt->req->contextId() : 0)
+    cID(pkt->req->hasContextId() ? pkt->req->contextId() : 0),
+    dataView(nullptr), dataInline(false)
 {
     unsigned int req_size = pkt->req->getSize();
-    if (!write && miss) {
-        data = nullptr;
-    } else {
-        data = new uint8_t[req_size];
+    if (write || !miss) {
         Addr offset = pkt->req->getPaddr() - pkt->getAddr();
-        std::memcpy(data, &(pkt->getConstPtr<uint8_t>()[offset]), req_size);
+        const uint8_t *req_data = &(pkt->getConstPtr<uint8_t>()[offset]);
+        if (req_size <= MaxInlineData) {
+            std::memcpy(inlineData, req_data, req_size);
+            dataInline = true;
+        } else {
+            dataView = req_data;
+        }
     }
 }
 
@@ -81,19 +86,78 @@ Base::PrefetchInfo::PrefetchInfo(PrefetchInfo const &pfi, Addr addr)
   : address(addr), pc(pfi.pc), requestorId(pfi.requestorId),
     validPC(pfi.validPC), secure(pfi.secure), size(pfi.size),
     write(pfi.write), paddress(pfi.paddress), cacheMiss(pfi.cacheMiss),
-    cID(pfi.cID), data(nullptr)
+    cID(pfi.cID), dataView(nullptr), dataInline(false)
 {
 }
 
 Base::PrefetchInfo::PrefetchInfo(Addr addr, Addr pc, RequestorID requestorID, ContextID cID)
-  : address(addr), pc(pc), requestorId(requestorId), validPC(true),
+  : address(addr), pc(pc), requestorId(requestorID), validPC(true),
     secure(false), size(0), write(false), paddress(0x0), cacheMiss(false),
-    cID(cID), data(nullptr)
+    cID(cID), dataView(nullptr), dataInline(false)
+{
+}
+
+void
+Base::PrefetchInfo::serialize(CheckpointOut &cp) const
 {
+    SERIALIZE_SCALAR(address);
+    SERIALIZE_SCALAR(pc);
+    SERIALIZE_SCALAR(validPC);
+    SERIALIZE_SCALAR(secure);
+    SERIALIZE_SCALAR(size);
+    SERIALIZE_SCALAR(write);
+    SERIALIZE_SCALAR(paddress);
+    SERIALIZE_SCALAR(cacheMiss);
+    SERIALIZE_SCALAR(cID);
+}
+
+void
+Base::PrefetchInfo::unserialize(CheckpointIn &cp, RequestorID requestor_id)
+{
+    UNSERIALIZE_SCALAR(address);
+    UNSERIALIZE_SCALAR(pc);
+    UNSERIALIZE_SCALAR(validPC);
+    UNSERIALIZE_SCALAR(secure);
+    UNSERIALIZE_SCALAR(size);
+    UNSERIALIZE_SCALAR(write);
+    UNSERIALIZE_SCALAR(paddress);
+    UNSERIALIZE_SCALAR(cacheMiss);
+    UNSERIALIZE_SCALAR(cID);
+    requestorId = requestor_id;
+    dataView = nullptr;
+    dataInline = false;
 }
 
 void
 Base::PrefetchListener::notify(const PacketPtr &pkt)
+{
+    if (!parent.enabled) {
+        return;
+    }
+
+    if (curEventQueue() == parent.eventQueue()) {
+        deliver(pkt);
+        return;
+    }
+
+    // the probe fired in a cache of another event queue, e.g. an L1 of
+    // a core simulated on its own thread: the packet goes on with that
+    // cache, so the prefetcher gets a copy a quantum later, like any
+    // other packet crossing to its queue
+    PacketPtr copy = new Packet(pkt, false, pkt->hasData());
+    if (pkt->hasData())
+        copy->setData(pkt->getConstPtr<uint8_t>());
+    copy->senderState = nullptr;
+
+    parent.eventQueue()->schedule(new EventFunctionWrapper(
+        [this, copy]() {
+            deliver(copy);
+            delete copy;
+        }, parent.name() + ".probe", true), curTick() + simQuantum);
+}
+
+void
+Base::PrefetchListener::deliver(const PacketPtr &pkt)
 {
     if (l1_req) {
         parent.notifyL1Req(pkt);
@@ -119,12 +183,24 @@ Base::Base(const BasePrefetcherParams &p)
       prefetchOnPfHit(p.prefetch_on_pf_hit),
       useVirtualAddresses(p.use_virtual_addresses),
       prefetchStats(this), issuedPrefetches(0),
-      usefulPrefetches(0), tlb(nullptr)
+      usefulPrefetches(0), tlb(nullptr), enabled(true)
 {
-    if (!p.stats_pc_list.empty()) {
-        prefetchStats.regStatsPerPC(p.stats_pc_list);
-        stats_pc_list = p.stats_pc_list;
-    }
+    stats_pc_index.init(p.stats_pc_list, p.stats_pc_auto,
+                        p.stats_pc_auto_misses);
+    prefetchStats.regStatsPerPC(stats_pc_index);
+}
+
+std::string
+Base::requestorName(RequestorID id) const
+{
+    if (id >= cache->system->maxRequestors()) return "";
+    return cache->system->getRequestorName(id);
+}
+
+RequestorID
+Base::requestorByName(const std::string &name) const
+{
+    return cache->system->lookupRequestorId(name);
 }
 
 void
@@ -263,8 +339,14 @@ Base::StatGroup::StatGroup(statistics::Group *parent)
      */
     accuracy_prefetcher.flags(total | nonan);
     accuracy_prefetcher = (pfLate + pfUseful + demandMshrHitsAtPf) / pfIssued;
+}
+
+void
+Base::StatGroup::regStatsPerPC(const PCStatsIndex &stats_pc_index)
+{
+    using namespace statistics;
 
-    int max_per_pc = 32;
+    const int max_per_pc = stats_pc_index.statSize();
 
     demandMshrMissesPerPC
         .init(max_per_pc)
@@ -330,26 +412,12 @@ Base::StatGroup::StatGroup(statistics::Group *parent)
 
     accuracy_prefetcher_perPfPC.flags(total | nonan);
     accuracy_prefetcher_perPfPC = (pfLatePerPfPC + pfUsefulPerPfPC + demandMshrHitsAtPfPerPfPC) / pfIssuedPerPfPC;
-}
-
-void 
-Base::StatGroup::regStatsPerPC(const std::vector<Addr> &stats_pc_list)
-{
-    using namespace statistics;
-
-    int max_per_pc = 32;
-    assert(stats_pc_list.size() < max_per_pc);
-    
-    for (int i = 0; i < stats_pc_list.size(); i++) {
-
-        std::stringstream stream;
-        stream << std::hex << stats_pc_list[i];
-        std::string pc_name = stream.str();
 
+    stats_pc_index.addNamer([this](int i, const std::string &pc_name) {
         demandMshrMissesPerPC.subname(i, pc_name);
         demandMshrHitsAtPfPerPfPC.subname(i, pc_name);
         pfIssuedPerPfPC.subname(i, pc_name);
-        pfUnusedPerPfPC.subname(i, pc_name); 
+        pfUnusedPerPfPC.subname(i, pc_name);
         pfUsefulPerPfPC.subname(i, pc_name);
         pfHitInCachePerPfPC.subname(i, pc_name);
         pfHitInMSHRPerPfPC.subname(i, pc_name);
@@ -366,7 +434,7 @@ Base::StatGroup::regStatsPerPC(const std::vector<Addr> &stats_pc_list)
         pf_timely_perPfPC.subname(i, pc_name);
         accuracy_cache_perPfPC.subname(i, pc_name);
         accuracy_prefetcher_perPfPC.subname(i, pc_name);
-    }
+    });
 }
 
 bool
@@ -459,11 +527,9 @@ Base::prefetchHit(PacketPtr pkt, bool miss)
         prefetchStats.pfUseful++;
 
         Addr req_pc = cache->getCacheBlk(pkt->getAddr(), pkt->isSecure())->getPC();
-        for (int i = 0; i < stats_pc_list.size(); i++) {
-            if (req_pc == stats_pc_list[i]) {
-                prefetchStats.pfUsefulPerPfPC[i]++;
-                break;
-            }
+        notifyPrefetchUseful(req_pc);
+        if (int i = stats_pc_index.find(req_pc); i >= 0) {
+            prefetchStats.pfUsefulPerPfPC[i]++;
         }
 
         if (miss)
@@ -542,5 +608,20 @@ Base::addTLB(BaseTLB *t)
     tlb = t;
 }
 
+bool
+Base::setRuntimeParam(const std::string &name, const std::string &value)
+{
+    if (name == "enabled") {
+        if (!to_bool(value, enabled)) {
+            return false;
+        }
+        if (!enabled) {
+            squashPrefetches();
+        }
+        return true;
+    }
+    return false;
+}
+
 } // namespace prefetch
 } // namespace gem5
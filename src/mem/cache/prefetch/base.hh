@@ -47,12 +47,15 @@
 #define __MEM_CACHE_PREFETCH_BASE_HH__
 
 #include <cstdint>
+#include <cstring>
+#include <string>
 
 #include "arch/generic/tlb.hh"
 #include "base/compiler.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/cache_blk.hh"
+#include "mem/cache/pc_stats_index.hh"
 #include "mem/packet.hh"
 #include "mem/request.hh"
 #include "sim/byteswap.hh"
@@ -82,6 +85,9 @@ class Base : public ClockedObject
               l1_req(l1_req), l1_resp(l1_resp) {}
         void notify(const PacketPtr &pkt) override;
       protected:
+        /** Notify the prefetcher, on its event queue */
+        void deliver(const PacketPtr &pkt);
+
         Base &parent;
         const bool isFill;
         const bool miss;
@@ -120,8 +126,27 @@ class Base : public ClockedObject
         bool cacheMiss;
         /** ContexID of the pc */
         ContextID cID;
-        /** Pointer to the associated request data */
-        uint8_t *data;
+
+      public:
+        /** Largest request payload copied into the PrefetchInfo */
+        static constexpr unsigned MaxInlineData = 64;
+
+      private:
+        /**
+         * The associated request data. Payloads of up to MaxInlineData
+         * bytes are copied in inlineData, larger ones are only viewed in
+         * the packet, which outlives the notification. Either way no
+         * memory is allocated per notification.
+         */
+        uint8_t inlineData[MaxInlineData];
+        const uint8_t *dataView;
+        bool dataInline;
+
+        const uint8_t *
+        getData() const
+        {
+            return dataInline ? inlineData : dataView;
+        }
 
       public:
         /**
@@ -232,15 +257,18 @@ class Base : public ClockedObject
         inline T
         get(ByteOrder endian) const
         {
+            const uint8_t *data = getData();
             if (data == nullptr) {
                 panic("PrefetchInfo::get called with a request with no data.");
             }
+            T value;
+            std::memcpy(&value, data, sizeof(T));
             switch (endian) {
                 case ByteOrder::big:
-                    return betoh(*(T*)data);
+                    return betoh(value);
 
                 case ByteOrder::little:
-                    return letoh(*(T*)data);
+                    return letoh(value);
 
                 default:
                     panic("Illegal byte order in PrefetchInfo::get()\n");
@@ -281,10 +309,13 @@ class Base : public ClockedObject
          */
         PrefetchInfo(Addr addr, Addr pc, RequestorID requestorID, ContextID cID);
 
-        ~PrefetchInfo()
-        {
-            delete[] data;
-        }
+        /**
+         * Checkpoint the request fields. The data is only valid during
+         * the notification and is not kept. The requestor is given to
+         * unserialize(), see Base::requestorByName().
+         */
+        void serialize(CheckpointOut &cp) const;
+        void unserialize(CheckpointIn &cp, RequestorID requestor_id);
     };
 
   protected:
@@ -359,7 +390,7 @@ class Base : public ClockedObject
     struct StatGroup : public statistics::Group
     {
         StatGroup(statistics::Group *parent);
-        void regStatsPerPC(const std::vector<Addr> &stats_pc_list);
+        void regStatsPerPC(const PCStatsIndex &stats_pc_index);
 
         statistics::Scalar demandMshrMisses;
         statistics::Vector demandMshrMissesPerPC;
@@ -416,7 +447,8 @@ class Base : public ClockedObject
         statistics::Formula pfLateRatePerPfPC;
     } prefetchStats;
 
-    std::vector<Addr> stats_pc_list;
+    /** PCs with per-PC statistics */
+    PCStatsIndex stats_pc_index;
 
     /** Total prefetches issued */
     uint64_t issuedPrefetches;
@@ -426,6 +458,19 @@ class Base : public ClockedObject
     /** Registered tlb for address translations */
     BaseTLB * tlb;
 
+    /** Whether the prefetcher observes accesses, see setRuntimeParam */
+    bool enabled;
+
+    /**
+     * Per-requestor state is checkpointed by requestor name, as the IDs
+     * depend on the order the requestors were registered in, e.g. on the
+     * CPU model.
+     */
+    std::string requestorName(RequestorID id) const;
+
+    /** @return Request::invldRequestorId for an unknown requestor */
+    RequestorID requestorByName(const std::string &name) const;
+
   public:
     Base(const BasePrefetcherParams &p);
     virtual ~Base() = default;
@@ -447,23 +492,34 @@ class Base : public ClockedObject
     // Probe DataResp from L1 for prefetch detection
     virtual void notifyL1Resp(const PacketPtr &pkt) {}
 
+    /**
+     * Feedback on a prefetched block, pc is the PC the prefetch was
+     * tagged with. Useful: a demand hit the block, late: a demand hit
+     * the MSHR of the prefetch, unused: the block was evicted before
+     * any demand.
+     */
+    virtual void notifyPrefetchUseful(Addr pc) {}
+    virtual void notifyPrefetchLate(Addr pc) {}
+    virtual void notifyPrefetchUnused(Addr pc) {}
+
     virtual PacketPtr getPacket() = 0;
 
     virtual Tick nextPrefetchReadyTime() const = 0;
 
+    /** Drop the prefetches not issued yet, when the prefetcher is off */
+    virtual void squashPrefetches() {}
+
     void prefetchHit(PacketPtr pkt, bool miss);
 
     void
     prefetchUnused(Addr pc)
     {
         prefetchStats.pfUnused++;
+        notifyPrefetchUnused(pc);
 
         if (pc != MaxAddr) {
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (pc == stats_pc_list[i]) {
-                    prefetchStats.pfUnusedPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(pc); i >= 0) {
+                prefetchStats.pfUnusedPerPfPC[i]++;
             }
         }
     }
@@ -471,13 +527,11 @@ class Base : public ClockedObject
     void incrDemandMshrHitsAtPf(Addr pc)
     {
         prefetchStats.demandMshrHitsAtPf++;
+        notifyPrefetchLate(pc);
 
         if (pc != MaxAddr) {
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (pc == stats_pc_list[i]) {
-                    prefetchStats.demandMshrHitsAtPfPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(pc); i >= 0) {
+                prefetchStats.demandMshrHitsAtPfPerPfPC[i]++;
             }
         }
     }
@@ -489,11 +543,9 @@ class Base : public ClockedObject
 
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    prefetchStats.demandMshrMissesPerPC[i]++;
-                    break;
-                }
+            stats_pc_index.discover(req_pc);
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                prefetchStats.demandMshrMissesPerPC[i]++;
             }
         }
     }
@@ -504,11 +556,8 @@ class Base : public ClockedObject
         prefetchStats.pfHitInCache++;
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    prefetchStats.pfHitInCachePerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                prefetchStats.pfHitInCachePerPfPC[i]++;
             }
         }
     }
@@ -519,11 +568,8 @@ class Base : public ClockedObject
         prefetchStats.pfHitInMSHR++;
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    prefetchStats.pfHitInMSHRPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                prefetchStats.pfHitInMSHRPerPfPC[i]++;
             }
         }
     }
@@ -534,11 +580,8 @@ class Base : public ClockedObject
         prefetchStats.pfHitInWB++;
         if (pkt->req->hasPC()) {
             Addr req_pc = pkt->req->getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    prefetchStats.pfHitInWBPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                prefetchStats.pfHitInWBPerPfPC[i]++;
             }
         }
     }
@@ -572,6 +615,19 @@ class Base : public ClockedObject
      * @param tlb pointer to the BaseTLB object to add
      */
     void addTLB(BaseTLB *tlb);
+
+    /**
+     * Change a parameter of an instantiated prefetcher, e.g. in the
+     * children of a forked parameter sweep. Only parameters which can
+     * change between two accesses are accepted; "enabled" turns the
+     * prefetcher on or off, turning it off squashes its queued prefetches.
+     * @param name name of the parameter, as in the Python class
+     * @param value new value of the parameter
+     * @return false if the parameter can't be changed or the value is
+     *         invalid
+     */
+    virtual bool setRuntimeParam(const std::string &name,
+                                 const std::string &value);
 };
 
 } // namespace prefetch
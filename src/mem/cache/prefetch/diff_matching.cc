@@ -1,10 +1,20 @@
 #include "mem/cache/prefetch/diff_matching.hh"
+#include "mem/cache/prefetch/diff_matching_kernel.hh"
+#include "mem/cache/prefetch/dmp_hints.hh"
 #include "mem/cache/mshr.hh"
 #include "mem/cache/base.hh"
+#include "cpu/thread_context.hh"
+#include "base/cprintf.hh"
+#include "base/output.hh"
+#include "base/str.hh"
 
 #include "debug/HWPrefetch.hh"
 #include "debug/DMP.hh"
 #include "params/DiffMatchingPrefetcher.hh"
+#include "sim/core.hh"
+
+#include <fstream>
+#include <iterator>
 
 namespace gem5
 {
@@ -13,6 +23,65 @@ GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
 namespace prefetch
 {
 
+namespace
+{
+
+/** Entries of each partition, 0 splits a table evenly with its pool */
+int
+partitionBudget(int ent_num, int part_num, int budget)
+{
+    if (part_num == 0 || budget > 0) return budget;
+    return std::max(1, ent_num / (part_num + 1));
+}
+
+/**
+ * Checkpoint the entries of a table for which saved(slot) holds, each in
+ * a subsection named by its slot. Must come after the other parameters
+ * of the current section.
+ */
+template <typename Table, typename Saved>
+void
+serializeTable(CheckpointOut &cp, const Table &table, Saved &&saved)
+{
+    std::vector<int> slots;
+    for (int slot = 0; slot < table.size(); slot++) {
+        if (saved(slot)) slots.push_back(slot);
+    }
+    paramOut(cp, "numEntries", (int)table.size());
+    arrayParamOut(cp, "slots", slots);
+    for (int slot : slots) {
+        Serializable::ScopedCheckpointSection sec(
+            cp, csprintf("Entry%d", slot));
+        table[slot].serialize(cp);
+    }
+}
+
+/**
+ * Restore the entries of serializeTable() in their slots and call
+ * restored(slot) for each of them.
+ * @return false, restoring nothing, if the table size differs
+ */
+template <typename Table, typename Restored>
+bool
+unserializeTable(CheckpointIn &cp, Table &table, Restored &&restored)
+{
+    int num_entries;
+    std::vector<int> slots;
+    paramIn(cp, "numEntries", num_entries);
+    arrayParamIn(cp, "slots", slots);
+    if (num_entries != table.size()) return false;
+
+    for (int slot : slots) {
+        Serializable::ScopedCheckpointSection sec(
+            cp, csprintf("Entry%d", slot));
+        table[slot].unserialize(cp);
+        restored(slot);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 DiffMatching::DiffMatching(const DiffMatchingPrefetcherParams &p)
   : Stride(p),
     iddt_ent_num(p.iddt_ent_num),
@@ -24,30 +93,55 @@ DiffMatching::DiffMatching(const DiffMatchingPrefetcherParams &p)
     range_ahead_dist(p.range_ahead_dist),
     indir_range(p.indir_range),
     notify_latency(p.notify_latency),
+    match_width(p.match_width),
+    pf_gen_width(p.pf_gen_width),
+    notifyQueue(p.notify_queue_size),
+    notifyHead(0),
+    notifyCount(0),
+    pf_gen_queue_size(p.pf_gen_queue_size),
+    pipelineEvent([this] { processPipeline(); }, this->name()),
+    lastPipelineTick(MaxTick),
     cur_range_priority(0),
     range_group_size(p.range_group_size),
+    partition_by_core(p.partition_by_core),
     iddt_diff_num(p.iddt_diff_num),
     tadt_diff_num(p.tadt_diff_num),
+    match_mask(std::max(1, (int)p.iddt_diff_num - (int)p.tadt_diff_num + 1)),
     indexDataDeltaTable(p.iddt_ent_num, iddt_ent_t(p.iddt_diff_num, false)),
     targetAddrDeltaTable(p.tadt_ent_num, tadt_ent_t(p.tadt_diff_num, false)),
-    iddt_ptr(0), tadt_ptr(0),
+    iddtParts(p.iddt_ent_num, p.partition_num, partitionBudget(
+        p.iddt_ent_num, p.partition_num, p.iddt_part_ent_num)),
+    tadtParts(p.tadt_ent_num, p.partition_num, partitionBudget(
+        p.tadt_ent_num, p.partition_num, p.tadt_part_ent_num)),
+    iddtIndex(p.iddt_ent_num), tadtIndex(p.tadt_ent_num),
     range_unit_param(p.range_unit),
     range_level_param(p.range_level),
     rangeTable(p.rg_ent_num * 4, RangeTableEntry(p.range_unit, p.range_level, false)),
     rg_ptr(0),
+    rgIndex(p.rg_ent_num * 4),
     indexQueue(p.iq_ent_num),
     iq_ptr(0),
     indirectCandidateScoreboard(p.ics_ent_num, ICSEntry(p.ics_candidate_num, false)),
-    ics_ptr(0),
+    icsParts(p.ics_ent_num, p.partition_num, partitionBudget(
+        p.ics_ent_num, p.partition_num, p.ics_part_ent_num)),
     checkNewIndexEvent([this] { pickIndexPC(); }, this->name()),
     auto_detect(p.auto_detect),
+    record_hints(p.record_hints),
     detect_period(p.detect_period),
     ics_miss_threshold(p.ics_miss_threshold),
     ics_candidate_num(p.ics_candidate_num),
     relationTable(p.rt_ent_num),
-    rt_ptr(0),
-    statsDMP(this),
-    pf_helper(nullptr)
+    rtParts(p.rt_ent_num, p.partition_num, partitionBudget(
+        p.rt_ent_num, p.partition_num, p.rt_part_ent_num)),
+    rtIndexPCIndex(p.rt_ent_num), rtTargetPCIndex(p.rt_ent_num),
+    throttle_period(p.throttle_period),
+    throttle_acc_high(p.throttle_acc_high),
+    throttle_acc_low(p.throttle_acc_low),
+    throttle_late(p.throttle_late),
+    throttle_init_level(p.throttle_init_level),
+    chain_depth(p.chain_depth),
+    chain_lookahead(p.chain_lookahead.begin(), p.chain_lookahead.end()),
+    statsDMP(this)
 {
     /**
      * Priority Update Policy: 
@@ -55,55 +149,87 @@ DiffMatching::DiffMatching(const DiffMatchingPrefetcherParams &p)
      * new single-type priority = parent_rte.priority + 1
     */
 
+    fatal_if(throttle_init_level < 1 || throttle_init_level > ThrottleLevels,
+             "throttle_init_level must be in [1, %d]", ThrottleLevels);
+    fatal_if((notify_latency > 0 || match_width > 0 || pf_gen_width > 0) &&
+             (notifyQueue.empty() || pf_gen_queue_size == 0),
+             "The notification pipeline needs notify_queue_size and "
+             "pf_gen_queue_size entries");
+
     // init cur_range_priority
     cur_range_priority = std::numeric_limits<int32_t>::max();
     cur_range_priority -= cur_range_priority % range_group_size;
 
 
+    DMPHints hints;
     if (!p.auto_detect) {
-
         /**
          * Manual Mode
         */
-        std::vector<Addr> pc_list;
+        hints.indexPCs = p.index_pc_init;
+        hints.targetPCs = p.target_pc_init;
+        hints.rangePCs = p.range_pc_init;
+    }
+    // hinted PCs are trained from the start, detection goes on if enabled
+    if (!p.hint_file.empty()) {
+        std::ifstream is(p.hint_file);
+        fatal_if(!is, "Can't open DMP hint file '%s'\n", p.hint_file);
+        hints.read(is, p.hint_file);
+    }
+    const std::vector<Addr> &index_pcs = hints.indexPCs;
+    const std::vector<Addr> &target_pcs = hints.targetPCs;
+    const std::vector<Addr> &range_pcs = hints.rangePCs;
+
+    // init IDDT and TADT, as context 0 whose partition demotes to the
+    // shared pool when it is full
+    const int init_iddt_part = iddtParts.partOf(partitionKey(0));
+    warn_if(int(index_pcs.size()) > iddtParts.capacity(init_iddt_part),
+            "%s: %d index PCs exceed the %d IDDT entries of context 0, "
+            "the first ones are dropped\n", name(), index_pcs.size(),
+            iddtParts.capacity(init_iddt_part));
+    for (auto index_pc : index_pcs) {
+        insertIDDT(index_pc, 0);
+    }
 
-        // init IDDT
-        if (!p.index_pc_init.empty()) {
-            for (auto index_pc : p.index_pc_init) {
-                indexDataDeltaTable[iddt_ptr].update(index_pc, 0, 0).validate();
-                iddt_ptr++;
-            }
-            pc_list.insert(
-                pc_list.end(), p.index_pc_init.begin(), p.index_pc_init.end()
-            );
-        }
+    const int init_tadt_part = tadtParts.partOf(partitionKey(0));
+    warn_if(int(target_pcs.size()) > tadtParts.capacity(init_tadt_part),
+            "%s: %d target PCs exceed the %d TADT entries of context 0, "
+            "the first ones are dropped\n", name(), target_pcs.size(),
+            tadtParts.capacity(init_tadt_part));
+    for (auto target_pc : target_pcs) {
+        insertTADT(target_pc, 0);
+    }
 
-        // init TADT
-        if (!p.target_pc_init.empty()) {
-            for (auto target_pc : p.target_pc_init) {
-                targetAddrDeltaTable[tadt_ptr].update(target_pc, 0, 0).validate();
-                tadt_ptr++;
-            }
-            pc_list.insert(
-                pc_list.end(), p.target_pc_init.begin(), p.target_pc_init.end()
-            );
+    // init RangeTable
+    for (auto range_pc : range_pcs) {
+        if (rg_ptr + std::size(shift_v) > rangeTable.size()) {
+            warn("%s: RangeTable full, ignoring range PCs from %#x\n",
+                 name(), range_pc);
+            break;
         }
-
-        // init RangeTable
-        if (!p.range_pc_init.empty()) {
-            for (auto range_pc : p.range_pc_init) {
-                for (unsigned int shift_try: shift_v) {
-                    rangeTable[rg_ptr].update(range_pc, 0x0, shift_try, 0).validate();
-                    rg_ptr++;
-                }
-            }
+        for (unsigned int shift_try: shift_v) {
+            rangeTable[rg_ptr].update(range_pc, 0x0, shift_try, 0).validate();
+            rgIndex.assign(rg_ptr, range_pc);
+            rg_ptr++;
         }
+    }
+    if (rg_ptr == rangeTable.size()) rg_ptr = 0;
 
+    if (!p.auto_detect) {
+        std::vector<Addr> pc_list(index_pcs);
+        pc_list.insert(pc_list.end(), target_pcs.begin(), target_pcs.end());
         std::sort( pc_list.begin(), pc_list.end() );
         pc_list.erase( std::unique( pc_list.begin(), pc_list.end() ), pc_list.end() );
-        statsDMP.regStatsPerPC(pc_list);
-        dmp_stats_pc = pc_list;
+        dmp_stats_pc_index.init(pc_list);
+    } else {
+        // monitor the target PCs identifying the most prefetches
+        dmp_stats_pc_index.init({}, p.stats_pc_auto, p.stats_pc_auto_misses);
     }
+
+    if (record_hints) {
+        registerExitCallback([this]() { writeHints(); });
+    }
+    statsDMP.regStatsPerPC(dmp_stats_pc_index);
 }
 
 DiffMatching::~DiffMatching()
@@ -119,39 +245,50 @@ DiffMatching::DMPStats::DMPStats(statistics::Group *parent)
     ADD_STAT(dmp_noValidDataPerPC, statistics::units::Count::get(),
              "number of DMP prefetch candidates identified"),
     ADD_STAT(dmp_dataFill, statistics::units::Count::get(),
-             "number of DMP prefetch candidates identified")
+             "number of DMP prefetch candidates identified"),
+    ADD_STAT(dmp_notifyDropped, statistics::units::Count::get(),
+             "number of probes dropped as the notification pipeline was "
+             "full"),
+    ADD_STAT(dmp_pfGenDropped, statistics::units::Count::get(),
+             "number of indirect prefetches dropped as the generation "
+             "queue was full"),
+    ADD_STAT(dmp_poolDemotions, statistics::units::Count::get(),
+             "number of DMP table entries demoted to the shared pool"),
+    ADD_STAT(dmp_throttleUp, statistics::units::Count::get(),
+             "number of relation throttle level increases"),
+    ADD_STAT(dmp_throttleDown, statistics::units::Count::get(),
+             "number of relation throttle level decreases"),
+    ADD_STAT(dmp_throttleLevel, statistics::units::Count::get(),
+             "relation throttle levels after each adjustment")
 {
     using namespace statistics;
-    
-    int max_per_pc = 32;
 
-    dmp_pfIdentifiedPerPfPC 
-        .init(max_per_pc)
-        .flags(total | nozero | nonan)
-        ;
-    dmp_noValidDataPerPC
-        .init(max_per_pc)
-        .flags(total | nozero | nonan)
+    dmp_throttleLevel
+        .init(1, ThrottleLevels, 1)
+        .flags(nozero)
         ;
 }
 
 void
-DiffMatching::DMPStats::regStatsPerPC(const std::vector<Addr>& stats_pc_list)
+DiffMatching::DMPStats::regStatsPerPC(const PCStatsIndex &stats_pc_index)
 {
     using namespace statistics;
 
-    int max_per_pc = 32;
-    assert(stats_pc_list.size() < max_per_pc);
+    const int max_per_pc = stats_pc_index.statSize();
 
-    
-    for (int i = 0; i < stats_pc_list.size(); i++) {
-        std::stringstream stream;
-        stream << std::hex << stats_pc_list[i];
-        std::string pc_name = stream.str();
+    dmp_pfIdentifiedPerPfPC
+        .init(max_per_pc)
+        .flags(total | nozero | nonan)
+        ;
+    dmp_noValidDataPerPC
+        .init(max_per_pc)
+        .flags(total | nozero | nonan)
+        ;
 
+    stats_pc_index.addNamer([this](int i, const std::string &pc_name) {
         dmp_pfIdentifiedPerPfPC.subname(i, pc_name);
         dmp_noValidDataPerPC.subname(i, pc_name);
-    }
+    });
 }
 
 void
@@ -229,14 +366,104 @@ DiffMatching::ICSEntry::updateMiss(Addr miss_pc, int miss_thred)
     return false;
 }
 
+void
+DiffMatching::ICSEntry::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_SCALAR(index_pc);
+    SERIALIZE_SCALAR(cID);
+    SERIALIZE_SCALAR(valid);
+
+    std::vector<std::pair<Addr, int>> misses(miss_count.begin(),
+                                             miss_count.end());
+    std::sort(misses.begin(), misses.end());
+    std::vector<Addr> miss_pcs;
+    std::vector<int> miss_counts;
+    for (const auto &miss : misses) {
+        miss_pcs.push_back(miss.first);
+        miss_counts.push_back(miss.second);
+    }
+    arrayParamOut(cp, "miss_pcs", miss_pcs);
+    arrayParamOut(cp, "miss_counts", miss_counts);
+}
+
+void
+DiffMatching::ICSEntry::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(index_pc);
+    UNSERIALIZE_SCALAR(cID);
+    UNSERIALIZE_SCALAR(valid);
+
+    std::vector<Addr> miss_pcs;
+    std::vector<int> miss_counts;
+    arrayParamIn(cp, "miss_pcs", miss_pcs);
+    arrayParamIn(cp, "miss_counts", miss_counts);
+    fatal_if(miss_pcs.size() != miss_counts.size(),
+             "Inconsistent ICS entry in %s\n",
+             Serializable::currentSection());
+    miss_count.clear();
+    for (int i = 0; i < miss_pcs.size() && i < candidate_num; i++) {
+        miss_count.emplace(miss_pcs[i], miss_counts[i]);
+    }
+}
+
+void
+DiffMatching::RTEntry::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_SCALAR(index_pc);
+    SERIALIZE_SCALAR(target_pc);
+    SERIALIZE_SCALAR(target_base_addr);
+    SERIALIZE_SCALAR(shift);
+    SERIALIZE_SCALAR(index_size);
+    SERIALIZE_SCALAR(index_signed);
+    SERIALIZE_SCALAR(range);
+    SERIALIZE_SCALAR(base_degree);
+    SERIALIZE_SCALAR(range_degree);
+    SERIALIZE_SCALAR(range_ahead);
+    SERIALIZE_SCALAR(cID);
+    SERIALIZE_SCALAR(valid);
+    SERIALIZE_SCALAR(priority);
+    SERIALIZE_SCALAR(chain_level);
+    SERIALIZE_SCALAR(throttle_level);
+    SERIALIZE_SCALAR(pf_useful);
+    SERIALIZE_SCALAR(pf_late);
+    SERIALIZE_SCALAR(pf_unused);
+}
+
+void
+DiffMatching::RTEntry::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(index_pc);
+    UNSERIALIZE_SCALAR(target_pc);
+    UNSERIALIZE_SCALAR(target_base_addr);
+    UNSERIALIZE_SCALAR(shift);
+    UNSERIALIZE_SCALAR(index_size);
+    UNSERIALIZE_SCALAR(index_signed);
+    UNSERIALIZE_SCALAR(range);
+    UNSERIALIZE_SCALAR(base_degree);
+    UNSERIALIZE_SCALAR(range_degree);
+    UNSERIALIZE_SCALAR(range_ahead);
+    UNSERIALIZE_SCALAR(cID);
+    UNSERIALIZE_SCALAR(valid);
+    UNSERIALIZE_SCALAR(priority);
+    UNSERIALIZE_SCALAR(chain_level);
+    UNSERIALIZE_SCALAR(throttle_level);
+    UNSERIALIZE_SCALAR(pf_useful);
+    UNSERIALIZE_SCALAR(pf_late);
+    UNSERIALIZE_SCALAR(pf_unused);
+}
+
 void
 DiffMatching::notifyICSMiss(Addr miss_addr, Addr miss_pc_in, ContextID cID_in)
 {
-    for (auto& ics_ent : indirectCandidateScoreboard) {
+    bool selected = false;
+
+    // only the partition of this context and the pool hold its entries
+    icsParts.forEachSlot(icsParts.partOf(partitionKey(cID_in)), [&](int slot) {
+        auto& ics_ent = indirectCandidateScoreboard[slot];
 
-        if (!ics_ent.valid) continue;
+        if (selected || !ics_ent.valid) return;
 
-        if (ics_ent.cID != cID_in) continue;
+        if (ics_ent.cID != cID_in) return;
 
         DPRINTF(DMP, "ICS updateMiss: targetPC %llx Addr %llx cID %d\n", miss_pc_in, miss_addr, cID_in);
         if (ics_ent.updateMiss(miss_pc_in, ics_candidate_num)) {
@@ -247,9 +474,9 @@ DiffMatching::notifyICSMiss(Addr miss_addr, Addr miss_pc_in, ContextID cID_in)
 
             DPRINTF(DMP, "ICS select: targetPC %llx cID %d\n", miss_pc_in, cID_in);
 
-            return;
+            selected = true;
         }
-    }
+    });
 }
 
 void
@@ -273,17 +500,25 @@ DiffMatching::insertIndexQueue(Addr index_pc_in, ContextID cID_in)
 void
 DiffMatching::insertICS(Addr index_pc_in, ContextID cID_in)
 {
-    // check if already exist
-    for (auto& ics_ent : indirectCandidateScoreboard) {
-
-        if (!ics_ent.valid) continue;
+    const int part = icsParts.partOf(partitionKey(cID_in));
 
-        if (ics_ent.index_pc == index_pc_in && ics_ent.cID == cID_in) return;
+    // check if already exist
+    bool exist = false;
+    icsParts.forEachSlot(part, [&](int slot) {
+        const auto& ics_ent = indirectCandidateScoreboard[slot];
+        exist = exist || (ics_ent.valid && ics_ent.index_pc == index_pc_in &&
+                          ics_ent.cID == cID_in);
+    });
+    if (exist) return;
+
+    // insert to the next position of this context's partition
+    int slot = icsParts.allocate(part);
+    int demoted = icsParts.demote(slot, indirectCandidateScoreboard[slot].valid);
+    if (demoted != -1) {
+        indirectCandidateScoreboard[demoted] = indirectCandidateScoreboard[slot];
+        statsDMP.dmp_poolDemotions++;
     }
-
-    // insert to position ics_ptr
-    indirectCandidateScoreboard[ics_ptr].update(index_pc_in, cID_in).validate();
-    ics_ptr = (ics_ptr + 1) % ics_ent_num;
+    indirectCandidateScoreboard[slot].update(index_pc_in, cID_in).validate();
 
     DPRINTF(DMP, "insert ICS: indexPC %llx cID %d\n", index_pc_in, cID_in);
 }
@@ -292,16 +527,22 @@ void
 DiffMatching::insertIDDT(Addr index_pc_in, ContextID cID_in)
 {
     // check if already exist
-    for (auto& iddt_ent : indexDataDeltaTable) {
-
-        if (!iddt_ent.isValid()) continue;
-
-        if (iddt_ent.getPC() == index_pc_in && iddt_ent.getContextId() == cID_in) return;
+    int found = iddtIndex.findIf(index_pc_in, [&](int slot) {
+        const auto& iddt_ent = indexDataDeltaTable[slot];
+        return iddt_ent.isValid() && iddt_ent.getContextId() == cID_in;
+    });
+    if (found != -1) return;
+
+    // insert to the next position of this context's partition
+    int slot = iddtParts.allocate(iddtParts.partOf(partitionKey(cID_in)));
+    int demoted = iddtParts.demote(slot, indexDataDeltaTable[slot].isValid());
+    if (demoted != -1) {
+        indexDataDeltaTable[demoted] = indexDataDeltaTable[slot];
+        iddtIndex.assign(demoted, indexDataDeltaTable[demoted].getPC());
+        statsDMP.dmp_poolDemotions++;
     }
-
-    // insert to position iddt_ptr
-    indexDataDeltaTable[iddt_ptr].update(index_pc_in, cID_in).validate();
-    iddt_ptr = (iddt_ptr + 1) % iddt_ent_num;
+    indexDataDeltaTable[slot].update(index_pc_in, cID_in).validate();
+    iddtIndex.assign(slot, index_pc_in);
 
     DPRINTF(DMP, "insert IDDT: indexPC %llx cID %d\n", index_pc_in, cID_in);
 }
@@ -310,16 +551,22 @@ void
 DiffMatching::insertTADT(Addr target_pc_in, ContextID cID_in)
 {
     // check if already exist
-    for (auto& tadt_ent : targetAddrDeltaTable) {
-
-        if (!tadt_ent.isValid()) continue;
-
-        if (tadt_ent.getPC() == target_pc_in && tadt_ent.getContextId() == cID_in) return;
+    int found = tadtIndex.findIf(target_pc_in, [&](int slot) {
+        const auto& tadt_ent = targetAddrDeltaTable[slot];
+        return tadt_ent.isValid() && tadt_ent.getContextId() == cID_in;
+    });
+    if (found != -1) return;
+
+    // insert to the next position of this context's partition
+    int slot = tadtParts.allocate(tadtParts.partOf(partitionKey(cID_in)));
+    int demoted = tadtParts.demote(slot, targetAddrDeltaTable[slot].isValid());
+    if (demoted != -1) {
+        targetAddrDeltaTable[demoted] = targetAddrDeltaTable[slot];
+        tadtIndex.assign(demoted, targetAddrDeltaTable[demoted].getPC());
+        statsDMP.dmp_poolDemotions++;
     }
-
-    // insert to position tadt_ptr
-    targetAddrDeltaTable[tadt_ptr].update(target_pc_in, cID_in).validate();
-    tadt_ptr = (tadt_ptr + 1) % tadt_ent_num;
+    targetAddrDeltaTable[slot].update(target_pc_in, cID_in).validate();
+    tadtIndex.assign(slot, target_pc_in);
 
     DPRINTF(DMP, "insert TADT: targetPC %llx cID %d\n", target_pc_in, cID_in);
 }
@@ -328,18 +575,18 @@ void
 DiffMatching::insertRG(Addr req_addr_in, Addr target_pc_in, ContextID cID_in)
 {
     // check if already exist
-    for (auto& rg_ent : rangeTable) {
-
-        if (!rg_ent.valid) continue;
-
-        if (rg_ent.target_pc == target_pc_in && rg_ent.cID == cID_in) return;
-    }
+    int found = rgIndex.findIf(target_pc_in, [&](int slot) {
+        const auto& rg_ent = rangeTable[slot];
+        return rg_ent.valid && rg_ent.cID == cID_in;
+    });
+    if (found != -1) return;
 
     // insert 4 rangeTableRntry for different shift values
     for (auto shift_try : shift_v) {
         rangeTable[rg_ptr].update(
             target_pc_in, req_addr_in, shift_try, cID_in
         ).validate();
+        rgIndex.assign(rg_ptr, target_pc_in);
         rg_ptr = (rg_ptr+1) % (rg_ent_num * 4);
     }
 
@@ -354,61 +601,59 @@ DiffMatching::diffMatching(const tadt_ent_t& tadt_ent)
 
     ContextID tadt_ent_cID = tadt_ent.getContextId();
 
-    // try to match all valid and ready index data diff-sequence 
-    for (const auto& iddt_ent : indexDataDeltaTable) {
-        if (!iddt_ent.isValid() || !iddt_ent.isReady()) continue;
-        if (tadt_ent_cID != iddt_ent.getContextId()) continue;
-        
-        // a specific index data diff-sequence may have multiple matching point  
-        for (int i_start = 0; i_start < iddt_diff_num-tadt_diff_num+1; i_start++) {
+    // a specific index data diff-sequence may have multiple matching point  
+    const int num_starts = iddt_diff_num - tadt_diff_num + 1;
+    if (num_starts <= 0) return;
 
-            // try different shift values
-            for (unsigned int shift_try: shift_v) {
-                int t_start = 0;
-                while (t_start < tadt_diff_num) {
-                    if (iddt_ent[i_start+t_start] != (tadt_ent[t_start] >> shift_try)) {
-                        break;
-                    }
-                    t_start++;
-                }
+    const int num_shifts = sizeof(shift_v) / sizeof(shift_v[0]);
 
-                if (t_start == tadt_diff_num) {
-                    // match success
-                    // insert pattern to RelationTable
-                    insertRT(iddt_ent, tadt_ent, i_start+tadt_diff_num, shift_try, tadt_ent_cID);
+    // try to match all valid and ready index data diff-sequence
+    // of the same context, which live in its partition or the pool
+    const int part = iddtParts.partOf(partitionKey(tadt_ent_cID));
+    iddtParts.forEachSlot(part, [&](int slot) {
+        const auto& iddt_ent = indexDataDeltaTable[slot];
+        if (!iddt_ent.isValid() || !iddt_ent.isReady()) return;
+        if (tadt_ent_cID != iddt_ent.getContextId()) return;
 
-                    // match updata
-                    matchUpdate(iddt_ent.getPC(), tadt_ent.getPC(), tadt_ent.getContextId());
-                }
+        // test all start offsets and shift values at once
+        diffSeqMatch(iddt_ent.data(), iddt_diff_num,
+                     tadt_ent.data(), tadt_diff_num,
+                     shift_v, num_shifts, match_mask.data());
+
+        for (int i_start = 0; i_start < num_starts; i_start++) {
+            if (match_mask[i_start] == 0) continue;
+
+            // try different shift values
+            for (int s = 0; s < num_shifts; s++) {
+                if (!(match_mask[i_start] & (1 << s))) continue;
+
+                // match success
+                // insert pattern to RelationTable
+                insertRT(iddt_ent, tadt_ent, i_start+tadt_diff_num, shift_v[s], tadt_ent_cID);
 
+                // match updata
+                matchUpdate(iddt_ent.getPC(), tadt_ent.getPC(), tadt_ent.getContextId());
             }
         }
-
-    }
+    });
 }
 
 bool
 DiffMatching::findRTE(Addr index_pc, Addr target_pc, ContextID cID)
 {
-    for (const auto& rte : relationTable)
-    {
-        if (!rte.valid) continue;
-
-        // only allow one index for each target
-        if ( rte.target_pc == target_pc && 
-             rte.cID == cID) {
-            return true; 
-        }
-
-        // avoid ring
-        if ( rte.index_pc == target_pc && 
-             rte.target_pc == index_pc && 
-             rte.cID == cID) {
-            return true; 
-        }
-
-    }
-    return false;
+    // only allow one index for each target
+    int found = rtTargetPCIndex.findIf(target_pc, [&](int slot) {
+        const auto& rte = relationTable[slot];
+        return rte.valid && rte.cID == cID;
+    });
+    if (found != -1) return true;
+
+    // avoid ring
+    found = rtTargetPCIndex.findIf(index_pc, [&](int slot) {
+        const auto& rte = relationTable[slot];
+        return rte.valid && rte.index_pc == target_pc && rte.cID == cID;
+    });
+    return found != -1;
 }
 
 bool
@@ -416,19 +661,15 @@ DiffMatching::checkRedundantRTE(Addr index_pc, Addr target_base_addr, ContextID
 {
     // check whether current new RTE will be prefetched by other exist RTEs
     Addr block_addr_mask = ~(Addr(blkSize - 1));
-    for (const auto& rte : relationTable) 
-    {
-        if (!rte.valid) continue;
-
-        if ( rte.index_pc == index_pc && 
-             ((rte.target_base_addr ^ target_base_addr) & block_addr_mask) == 0 &&
-             rte.cID == cID ) {
-            // target_base_addr points to the same cache block
-            return true;
-        }
-    }
-
-    return false;
+    int found = rtIndexPCIndex.findIf(index_pc, [&](int slot) {
+        const auto& rte = relationTable[slot];
+        // target_base_addr points to the same cache block
+        return rte.valid &&
+               ((rte.target_base_addr ^ target_base_addr) & block_addr_mask) == 0 &&
+               rte.cID == cID;
+    });
+
+    return found != -1;
 }
 
 void
@@ -443,52 +684,52 @@ DiffMatching::insertRT(
     // check if pattern already exist
     if (findRTE(new_index_pc, new_target_pc, cID)) return;
 
-    // calculate the target base address
-    IndexData data_match = iddt_ent_match.getLast();
+    // calculate the target base address, diffs wrap at the index width
+    const int index_size = iddt_ent_match.getDataSize();
+    const bool index_signed = iddt_ent_match.isSigned();
+    uint64_t data_raw = iddt_ent_match.getLastValue();
     for (int i = iddt_match_point; i < iddt_diff_num; i++) {
-        data_match -= iddt_ent_match[i];
+        data_raw -= iddt_ent_match[i];
     }
+    int64_t data_match = extendIndex(data_raw, index_size, index_signed);
 
     TargetAddr addr_match = tadt_ent_match.getLast();
 
-    int64_t base_addr_tmp = addr_match - (data_match << shift);
+    // modular, so negative indices give the right base as well
+    Addr target_base_addr =
+        static_cast<Addr>(addr_match) - (static_cast<Addr>(data_match) << shift);
 
-    DPRINTF(DMP, "Matched: LastData %llx Data %llx Addr %llx Shift %d\n", 
-               iddt_ent_match.getLast(), data_match, addr_match, shift);
-    
-    assert(base_addr_tmp <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()));
-    Addr target_base_addr = static_cast<uint64_t>(base_addr_tmp);
+    DPRINTF(DMP, "Matched: LastData %llx Data %llx Addr %llx Shift %d "
+            "IndexSize %d Signed %d\n",
+            iddt_ent_match.getLastValue(), data_match, addr_match, shift,
+            index_size, index_signed);
 
     if (checkRedundantRTE(new_index_pc, target_base_addr, cID)) return;
 
     /* get indexPC Range type */
-    bool new_range_type;
-
-    // Stride PC should be classified as Range
-    // search for all requestor
-    if(pf_helper) {
-        new_range_type = pf_helper->checkStride(new_index_pc);
-    } else {
-        new_range_type = this->checkStride(new_index_pc);
-
-        // tmp: only for test
-        //new_range_type = true;
-    }
+    bool new_range_type = checkRangeStride(new_index_pc, cID);
 
     // try tadt's range detection
     if (!new_range_type) {
 
         // check rangeTable for range type
-        for (auto range_ent : rangeTable) {
-            if (range_ent.target_pc != new_index_pc || range_ent.cID != cID) continue;
+        int found = rgIndex.findIf(new_index_pc, [&](int slot) {
+            const auto& range_ent = rangeTable[slot];
+            return range_ent.cID == cID && range_ent.getRangeType();
+        });
+        new_range_type = (found != -1);
 
-            new_range_type = new_range_type || range_ent.getRangeType();
-            
-            if (new_range_type == true) break; 
-        } 
+    }
 
+    /* get range degree */
+    int range_degree = indir_range;
+    if (new_range_type) {
+        range_degree = predictRangeDegree(new_index_pc, index_size, cID);
     }
 
+    /* get position in the indirect chain */
+    int chain_level = getChainLevel(new_index_pc, cID);
+
     /* get priority */
     int32_t priority = 0;
     if (new_range_type) {
@@ -500,40 +741,227 @@ DiffMatching::insertRT(
     }
 
     DPRINTF(DMP, "Insert RelationTable: "
-        "indexPC %llx targetPC %llx target_addr %llx shift %d cID %d rangeType %d priority %d\n",
-        new_index_pc, new_target_pc, target_base_addr, shift, cID, new_range_type, priority
+        "indexPC %llx targetPC %llx target_addr %llx shift %d indexSize %d "
+        "cID %d rangeType %d rangeDegree %d priority %d level %d\n",
+        new_index_pc, new_target_pc, target_base_addr, shift, index_size,
+        cID, new_range_type, range_degree, priority, chain_level
     );
 
-    relationTable[rt_ptr].update(
+    // insert to the next position of this context's partition
+    int slot = rtParts.allocate(rtParts.partOf(partitionKey(cID)));
+    int demoted = rtParts.demote(slot, relationTable[slot].valid);
+    if (demoted != -1) {
+        relationTable[demoted] = relationTable[slot];
+        rtIndexPCIndex.assign(demoted, relationTable[demoted].index_pc);
+        rtTargetPCIndex.assign(demoted, relationTable[demoted].target_pc);
+        statsDMP.dmp_poolDemotions++;
+    }
+
+    rtIndexPCIndex.assign(slot, new_index_pc);
+    rtTargetPCIndex.assign(slot, new_target_pc);
+    relationTable[slot].update(
         new_index_pc,
         new_target_pc,
         target_base_addr,
         shift,
+        index_size,
+        index_signed,
         new_range_type, 
-        indir_range, // TODO: dynamic detection
+        range_degree,
         cID,
         true,
-        priority
+        priority,
+        chain_level
     ).validate();
-    rt_ptr = (rt_ptr+1) % rt_ent_num;
+    relationTable[slot].throttle_level = throttle_init_level;
+    applyThrottle(relationTable[slot]);
+
+    // relations fed by the new target are one level further down
+    updateChainLevel(new_target_pc, chain_level + 1, cID);
+}
+
+int
+DiffMatching::predictRangeDegree(Addr index_pc, int index_size, ContextID cID)
+{
+    // the RangeTable entry sampling index_pc with the element width
+    const unsigned shift = floorLog2(index_size);
+    int found = rgIndex.findIf(index_pc, [&](int slot) {
+        const auto& range_ent = rangeTable[slot];
+        return range_ent.valid && range_ent.cID == cID &&
+               range_ent.shift_times == shift && range_ent.getRangeType();
+    });
+    if (found == -1) return indir_range;
+
+    // upper bound of the most frequent run length level
+    int level = rangeTable[found].getPredLevel() + 1;
+    if (level >= range_level_param) return indir_range;
+    return std::min(level * range_unit_param, indir_range);
+}
+
+void
+DiffMatching::applyThrottle(RTEntry& rt_ent)
+{
+    const int step = rt_ent.throttle_level - (ThrottleLevels + 1) / 2;
+
+    int degree = step >= 0 ? rt_ent.base_degree << step
+                           : rt_ent.base_degree >> -step;
+    rt_ent.range_degree = std::max(1, std::min(degree, indir_range));
+    rt_ent.range_ahead = std::max(0, range_ahead_dist + step);
+}
+
+void
+DiffMatching::throttleFeedback(Addr pc, Feedback kind)
+{
+    if (throttle_period == 0) return;
+
+    rtTargetPCIndex.forEach(pc, [&](int slot) {
+        auto& rt_ent = relationTable[slot];
+        if (!rt_ent.valid) return;
+
+        switch (kind) {
+          case Feedback::Useful: rt_ent.pf_useful++; break;
+          case Feedback::Late: rt_ent.pf_late++; break;
+          case Feedback::Unused: rt_ent.pf_unused++; break;
+        }
+
+        const int used = rt_ent.pf_useful + rt_ent.pf_late;
+        const int total = used + rt_ent.pf_unused;
+        if (total < throttle_period) return;
+
+        const double accuracy = double(used) / total;
+        const bool late = used > 0 &&
+                          double(rt_ent.pf_late) / used >= throttle_late;
+
+        if (accuracy < throttle_acc_low) {
+            if (rt_ent.throttle_level > 1) {
+                rt_ent.throttle_level--;
+                statsDMP.dmp_throttleDown++;
+            }
+        } else if (accuracy >= throttle_acc_high && late &&
+                   rt_ent.throttle_level < ThrottleLevels) {
+            rt_ent.throttle_level++;
+            statsDMP.dmp_throttleUp++;
+        }
+        applyThrottle(rt_ent);
+        statsDMP.dmp_throttleLevel.sample(rt_ent.throttle_level);
+
+        DPRINTF(DMP, "throttle: targetPC %llx useful %d late %d unused %d "
+                "level %d degree %d ahead %d\n", pc, rt_ent.pf_useful,
+                rt_ent.pf_late, rt_ent.pf_unused, rt_ent.throttle_level,
+                rt_ent.range_degree, rt_ent.range_ahead);
+
+        rt_ent.pf_useful = 0;
+        rt_ent.pf_late = 0;
+        rt_ent.pf_unused = 0;
+    });
+}
+
+void
+DiffMatching::notifyPrefetchUseful(Addr pc)
+{
+    throttleFeedback(pc, Feedback::Useful);
+}
+
+void
+DiffMatching::notifyPrefetchLate(Addr pc)
+{
+    throttleFeedback(pc, Feedback::Late);
+}
+
+void
+DiffMatching::notifyPrefetchUnused(Addr pc)
+{
+    throttleFeedback(pc, Feedback::Unused);
+}
+
+int
+DiffMatching::getChainLevel(Addr index_pc, ContextID cID)
+{
+    // only one index for each target, see findRTE
+    int parent = rtTargetPCIndex.findIf(index_pc, [&](int slot) {
+        const auto& rte = relationTable[slot];
+        return rte.valid && rte.cID == cID;
+    });
+    if (parent == -1) return 1;
+
+    // levels beyond chain_depth behave the same, bound them
+    return std::min(relationTable[parent].chain_level + 1, chain_depth + 1);
+}
+
+void
+DiffMatching::updateChainLevel(Addr index_pc, int level, ContextID cID)
+{
+    level = std::min(level, chain_depth + 1);
+
+    // levels only grow up to the bound, so this ends on rings as well
+    rtIndexPCIndex.forEach(index_pc, [&](int slot) {
+        auto& rte = relationTable[slot];
+        if (!rte.valid || rte.cID != cID || rte.chain_level >= level) return;
+
+        rte.chain_level = level;
+        updateChainLevel(rte.target_pc, level + 1, cID);
+    });
 }
 
 int32_t
 DiffMatching::getPriority(Addr pc_in, ContextID cID_in)
 {
-    int32_t priority = 0;
-    for (auto& rt_ent : relationTable) {
-        // if (!rt_ent.valid()) continue;
+    int found = rtTargetPCIndex.findIf(pc_in, [&](int slot) {
+        return cID_in == -1 || relationTable[slot].cID == cID_in;
+    });
 
-        if (rt_ent.target_pc != pc_in) continue;
+    return found != -1 ? relationTable[found].priority : 0;
+}
 
-        if (cID_in != -1 && rt_ent.cID != cID_in) continue;
+int64_t
+DiffMatching::extendIndex(uint64_t raw, int size, bool is_signed)
+{
+    const unsigned nbits = size * 8;
+    uint64_t val = raw & mask(nbits);
+    if (is_signed && nbits < 64 && bits(val, nbits - 1)) {
+        val |= ~mask(nbits);
+    }
+    return static_cast<int64_t>(val);
+}
 
-        priority = rt_ent.priority;
-        break;
+void
+DiffMatching::IndexDataCollection::fillData(
+    uint64_t raw, int size, ContextID cID_in)
+{
+    if (cID_in != cID) return;
+
+    if (size != data_size) {
+        // first element or the width changed, restart the sequence
+        data_size = size;
+        signed_votes = 0;
+        unsigned_votes = 0;
+        ready = false;
+        diff_ptr = 0;
+        last = extendIndex(raw, size, false);
+        return;
     }
 
-    return priority;
+    const uint64_t last_raw = last;
+    const int64_t diff = extendIndex(raw - last_raw, size, true);
+
+    // only a crossing of a wrap-around point tells signedness apart
+    if (size < 8) {
+        int64_t u_step = extendIndex(raw, size, false) -
+                         extendIndex(last_raw, size, false);
+        int64_t s_step = extendIndex(raw, size, true) -
+                         extendIndex(last_raw, size, true);
+        if (u_step != s_step) {
+            if (diff == s_step) {
+                signed_votes++;
+            } else if (diff == u_step) {
+                unsigned_votes++;
+            }
+        }
+    }
+
+    // last keeps the zero-extended element
+    push(diff);
+    last = extendIndex(raw, size, false);
 }
 
 bool
@@ -594,17 +1022,16 @@ DiffMatching::rangeFilter(Addr pc_in, Addr addr_in, ContextID cID_in)
 {
     bool ret = true;
 
-    for (auto& range_ent : rangeTable) {
+    rgIndex.forEach(pc_in, [&](int slot) {
+        auto& range_ent = rangeTable[slot];
 
-        if (!range_ent.valid) continue;
-        
-        if (range_ent.target_pc != pc_in || range_ent.cID != cID_in) continue;
+        if (!range_ent.valid || range_ent.cID != cID_in) return;
 
         DPRINTF(DMP, "updateSample: pc %llx addr %llx cur_tail %llx\n", 
-                    pc_in, addr_in, range_ent.cur_tail);
+                    pc_in, addr_in, range_ent.cur_tail[0]);
         bool update_ret = range_ent.updateSample(addr_in);
         ret = ret && update_ret;
-    }
+    });
 
     return ret;
 }
@@ -620,48 +1047,56 @@ DiffMatching::notifyL1Req(const PacketPtr &pkt)
         return;
     }
 
-    Addr req_addr = pkt->req->getVaddr();
+    DPRINTF(HWPrefetch, "notifyL1Req: PC %llx, Addr %llx, PAddr %llx, VAddr %llx\n",
+                        pkt->req->hasPC() ? pkt->req->getPC() : 0x0,
+                        pkt->getAddr(), 
+                        pkt->req->getPaddr(), 
+                        pkt->req->hasVaddr() ? pkt->req->getVaddr() : 0x0 );
+
+    const ContextID cID =
+        pkt->req->hasContextId() ? pkt->req->contextId() : 0;
+
+    if (!pipelined()) {
+        trainTarget(pkt->req->getPC(), pkt->req->getVaddr(), cID);
+        return;
+    }
+    if (NotifyWork *work = allocateWork(NotifyWork::Kind::L1Req)) {
+        work->pc = pkt->req->getPC();
+        work->addr = pkt->req->getVaddr();
+        work->cID = cID;
+    }
+}
 
+void
+DiffMatching::trainTarget(Addr pc, Addr req_addr, ContextID cID)
+{
     // avoid overflow when calculating DiffSeq
     if (req_addr > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) return;
 
-    for (auto& tadt_ent: targetAddrDeltaTable) {
+    tadtIndex.forEach(pc, [&](int slot) {
+        auto& tadt_ent = targetAddrDeltaTable[slot];
 
         Addr target_pc = tadt_ent.getPC();
         
         // tadt_ent validation check
-        if (target_pc != pkt->req->getPC() || !tadt_ent.isValid()) continue;
+        if (!tadt_ent.isValid()) return;
 
         // range check
-        if (!rangeFilter(target_pc, req_addr, 
-                        pkt->req->hasContextId() ? pkt->req->contextId() : 0))
-            continue;
+        if (!rangeFilter(target_pc, req_addr, cID))
+            return;
 
-        DPRINTF(DMP, "notifyL1Req: [filter pass] PC %llx, cID %d, Addr %llx, PAddr %llx, VAddr %llx\n",
-                            pkt->req->hasPC() ? pkt->req->getPC() : 0x0,
-                            pkt->req->hasContextId() ? pkt->req->contextId() : 0,
-                            pkt->getAddr(), 
-                            pkt->req->getPaddr(), 
-                            pkt->req->hasVaddr() ? pkt->req->getVaddr() : 0x0 );
+        DPRINTF(DMP, "trainTarget: [filter pass] PC %llx, cID %d, VAddr %llx\n",
+                            pc, cID, req_addr);
 
         // check passed, fill in
-        tadt_ent.fill(
-            static_cast<TargetAddr>(pkt->req->getVaddr()),
-            pkt->req->hasContextId() ? pkt->req->contextId() : 0
-        ); 
+        tadt_ent.fill(static_cast<TargetAddr>(req_addr), cID); 
 
         // try matching
         if (tadt_ent.isReady()) {
             DPRINTF(DMP, "try diffMatching for target PC: %llx\n", target_pc);
             diffMatching(tadt_ent);
         }
-    }
-
-    DPRINTF(HWPrefetch, "notifyL1Req: PC %llx, Addr %llx, PAddr %llx, VAddr %llx\n",
-                        pkt->req->hasPC() ? pkt->req->getPC() : 0x0,
-                        pkt->getAddr(), 
-                        pkt->req->getPaddr(), 
-                        pkt->req->hasVaddr() ? pkt->req->getVaddr() : 0x0 );
+    });
 }
 
 void
@@ -679,14 +1114,14 @@ DiffMatching::notifyL1Resp(const PacketPtr &pkt)
     }
 
     /** 
-     * NOTE: assume the max length of resp data is 8 byte (int64)
-     * Since pkt only keeps the data which req needs, we should 
-     * parse all data. 
+     * Index elements are 1, 2, 4 or 8 bytes wide. Since pkt only keeps
+     * the data which req needs, the access size is the element width.
     **/
     const int data_stride = 8;
     const int byte_width = 8;
 
-    if (pkt->getSize() > 8) return; 
+    const unsigned data_size = pkt->getSize();
+    if (data_size > 8 || !isPowerOf2(data_size)) return; 
     uint8_t data[8] = {0};
     pkt->writeData(data); 
     uint64_t resp_data = 0;
@@ -695,32 +1130,43 @@ DiffMatching::notifyL1Resp(const PacketPtr &pkt)
         resp_data += static_cast<uint64_t>(data[i_st]);
     }
 
-    // avoid overflow when calculating DiffSeq
-    if (resp_data > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) return;
+    const ContextID cID =
+        pkt->req->hasContextId() ? pkt->req->contextId() : 0;
+
+    if (!pipelined()) {
+        trainIndex(pkt->req->getPC(), resp_data, data_size, cID);
+        return;
+    }
+    if (NotifyWork *work = allocateWork(NotifyWork::Kind::L1Resp)) {
+        work->pc = pkt->req->getPC();
+        work->cID = cID;
+        work->value = resp_data;
+        work->size = data_size;
+    }
+}
 
+void
+DiffMatching::trainIndex(Addr pc, uint64_t resp_data, unsigned data_size,
+                         ContextID cID)
+{
     // update IDDT
-    for (auto& iddt_ent: indexDataDeltaTable) {
-        if (iddt_ent.getPC() == pkt->req->getPC() && iddt_ent.isValid()) {
+    iddtIndex.forEach(pc, [&](int slot) {
+        auto& iddt_ent = indexDataDeltaTable[slot];
+        if (iddt_ent.isValid()) {
 
             IndexData new_data;
             std::memcpy(&new_data, &resp_data, sizeof(int64_t));
 
             // repeation check
-            if (iddt_ent.getLast() == new_data) continue;
+            if (iddt_ent.getDataSize() == data_size &&
+                iddt_ent.getLast() == new_data) return;
 
-            DPRINTF(DMP, "notifyL1Resp: [filter pass] PC %llx, PAddr %llx, VAddr %llx, Size %d, Data %llx\n", 
-                                pkt->req->getPC(), pkt->req->getPaddr(), 
-                                pkt->req->hasVaddr() ? pkt->req->getVaddr() : 0x0,
-                                pkt->getSize(), resp_data);
+            DPRINTF(DMP, "trainIndex: [filter pass] PC %llx, Size %d, Data %llx\n", 
+                                pc, data_size, resp_data);
 
-            iddt_ent.fill(new_data, pkt->req->hasContextId() ? pkt->req->contextId() : 0);
+            iddt_ent.fillData(resp_data, data_size, cID);
         }
-    }
-
-    // DPRINTF(HWPrefetch, "notifyL1Resp: PC %llx, PAddr %llx, VAddr %llx, Size %d, Data %llx\n", 
-    //                     pkt->req->getPC(), pkt->req->getPaddr(), 
-    //                     pkt->req->hasVaddr() ? pkt->req->getVaddr() : 0x0,
-    //                     pkt->getSize(), resp_data);
+    });
 }
 
 void
@@ -738,85 +1184,224 @@ DiffMatching::notifyFill(const PacketPtr &pkt, const uint8_t* data_ptr)
         DPRINTF(HWPrefetch, "notifyFill: PC %llx, PAddr %llx, no Data, %s\n", 
                     pkt->req->getPC(), pkt->req->getPaddr(), pkt->cmdString());
         statsDMP.dmp_noValidData++;
-        for (int i = 0; i < dmp_stats_pc.size(); i++) {
-            Addr req_pc = pkt->req->getPC();
-            if (req_pc == dmp_stats_pc[i]) {
-                statsDMP.dmp_noValidDataPerPC[i]++;
-                break;
-            }
+        Addr req_pc = pkt->req->getPC();
+        if (int i = dmp_stats_pc_index.find(req_pc); i >= 0) {
+            statsDMP.dmp_noValidDataPerPC[i]++;
         }
         return;
     }
 
-    /* get response data */
-    uint8_t fill_data[blkSize];
-    std::memcpy(fill_data, data_ptr, blkSize);
+    /* response data, read in place from the filled block */
+    const uint8_t *fill_data = data_ptr;
 
     /* prinf response data in bytes */
     if (debug::HWPrefetch) {
         unsigned data_offset_debug = pkt->req->getPaddr() & (blkSize-1);
-        do {
-        int64_t resp_data = (int64_t) ((uint64_t)fill_data[data_offset_debug]
-                                + (((uint64_t)fill_data[data_offset_debug+1]) << 8)
-                                + (((uint64_t)fill_data[data_offset_debug+2]) << 16)
-                                + (((uint64_t)fill_data[data_offset_debug+3]) << 24));
-        DPRINTF(HWPrefetch, "notifyFill: PC %llx, PAddr %llx, DataOffset %d, Data %llx\n", 
-                        pkt->req->getPC(), pkt->req->getPaddr(), data_offset_debug, resp_data);
-        data_offset_debug += 4;
-        } while (data_offset_debug < blkSize);
+        while (data_offset_debug + 4 <= blkSize) {
+            int64_t resp_data = (int64_t) ((uint64_t)fill_data[data_offset_debug]
+                                    + (((uint64_t)fill_data[data_offset_debug+1]) << 8)
+                                    + (((uint64_t)fill_data[data_offset_debug+2]) << 16)
+                                    + (((uint64_t)fill_data[data_offset_debug+3]) << 24));
+            DPRINTF(HWPrefetch, "notifyFill: PC %llx, PAddr %llx, DataOffset %d, Data %llx\n", 
+                            pkt->req->getPC(), pkt->req->getPaddr(), data_offset_debug, resp_data);
+            data_offset_debug += 4;
+        }
     }
 
-    Addr pc = pkt->req->getPC();
-    for (const auto& rt_ent: relationTable) { 
+    // a line prefetched by DMP (stream or level N target) continues a chain
+    const bool own_prefetch = pkt->req->requestorId() == requestorId;
 
-        if (!rt_ent.valid) continue;
+    statsDMP.dmp_dataFill++;
 
-        if (rt_ent.index_pc != pc) continue;
+    // nothing to trigger, do not copy the line into the pipeline
+    if (!hasActiveRelation(pkt->req->getPC())) {
+        return;
+    }
 
-        /* Assume response data is a int and always occupies 4 bytes */
-        const int data_stride = 4;
+    if (!pipelined()) {
+        triggerRelations(pkt->req->getPC(), pkt->req->getPaddr(),
+                         own_prefetch, fill_data);
+        return;
+    }
+    if (NotifyWork *work = allocateWork(NotifyWork::Kind::Fill)) {
+        work->pc = pkt->req->getPC();
+        work->addr = pkt->req->getPaddr();
+        work->own_prefetch = own_prefetch;
+        std::memcpy(work->line.data(), fill_data, blkSize);
+    }
+}
+
+void
+DiffMatching::triggerRelations(Addr pc, Addr paddr, bool own_prefetch,
+                               const uint8_t *fill_data)
+{
+    rtIndexPCIndex.forEach(pc, [&](int slot) {
+        const auto& rt_ent = relationTable[slot];
+
+        if (!rt_ent.valid) return;
+
+        if (own_prefetch && rt_ent.chain_level > chain_depth) return;
+
+        /* number of index elements to dereference for range type */
+        int range_degree = rt_ent.range_degree;
+        if (rt_ent.chain_level <= (int)chain_lookahead.size()) {
+            range_degree = chain_lookahead[rt_ent.chain_level - 1];
+        }
+
+        /* index element width learned by the IDDT */
+        const unsigned data_stride = rt_ent.index_size;
         const int byte_width = 8;
+        if (data_stride == 0) return;
 
         /* set range_end, only process one data if not range type */
         unsigned range_end;
-        unsigned data_offset = pkt->req->getPaddr() & (blkSize-1);
+        unsigned data_offset = paddr & (blkSize-1);
         if (rt_ent.range) {
-            range_end = std::min(data_offset + data_stride * rt_ent.range_degree, blkSize);
+            range_end = std::min(data_offset + data_stride * range_degree, blkSize);
         } else {
-            range_end = data_offset + data_stride;
+            range_end = std::min(data_offset + data_stride, blkSize);
         }
 
         /* loop for range prefetch */
-        for (unsigned i_of = data_offset; i_of < range_end; i_of += data_stride)
+        for (unsigned i_of = data_offset; i_of + data_stride <= range_end;
+             i_of += data_stride)
         {
-            /* integrate fill_data[] to resp_data (considered as unsigned)  */
+            /* integrate fill_data[] to resp_data */
             uint64_t resp_data = 0;
             for (int i_st = data_stride-1; i_st >= 0; i_st--) {
                 resp_data = resp_data << byte_width;
                 resp_data += static_cast<uint64_t>(fill_data[i_of + i_st]);
             }
+            int64_t index = extendIndex(resp_data, data_stride, rt_ent.index_signed);
 
             /* calculate target prefetch address */
-            Addr pf_addr = (resp_data << rt_ent.shift) + rt_ent.target_base_addr;
+            Addr pf_addr = (static_cast<Addr>(index) << rt_ent.shift) + rt_ent.target_base_addr;
             DPRINTF(HWPrefetch, 
-                    "notifyFill: PC %llx, pkt_addr %llx, pkt_offset %d, pkt_data %d, pf_addr %llx\n", 
-                    pc, pkt->getAddr(), data_offset, resp_data, pf_addr);
-
-            // insert to missing translation queue
-            insertIndirectPrefetch(pf_addr, rt_ent.target_pc, rt_ent.cID, rt_ent.priority);
-            
-            if (rt_ent.target_pc == 0x400ca0) {
-                for (int i = 1; i <= range_ahead_dist; i++) {
-                    insertIndirectPrefetch(pf_addr + blkSize * i, rt_ent.target_pc, rt_ent.cID, rt_ent.priority);
+                    "notifyFill: PC %llx, pkt_addr %llx, pkt_offset %d, pkt_data %d, pf_addr %llx, level %d\n", 
+                    pc, paddr, data_offset, index, pf_addr, rt_ent.chain_level);
+
+            // range targets are likely to be walked beyond the first block
+            const int range_ahead = rt_ent.range ? rt_ent.range_ahead : 0;
+            for (int i = 0; i <= range_ahead; i++) {
+                const PfCandidate candidate{pf_addr + blkSize * i,
+                    rt_ent.target_pc, rt_ent.cID, rt_ent.priority};
+                if (!pipelined()) {
+                    // insert to missing translation queue
+                    insertIndirectPrefetch(candidate.pf_addr,
+                        candidate.target_pc, candidate.cID,
+                        candidate.priority);
+                } else if (pfGenQueue.size() < pf_gen_queue_size) {
+                    pfGenQueue.push_back(candidate);
+                } else {
+                    statsDMP.dmp_pfGenDropped++;
                 }
             }
         }
 
         // try to do translation immediately
+        if (!pipelined()) {
+            processMissingTranslations(queueSize - pfq.size());
+        }
+    });
+}
+
+bool
+DiffMatching::hasActiveRelation(Addr pc) const
+{
+    return rtIndexPCIndex.findIf(pc, [&](int slot) {
+        return relationTable[slot].valid;
+    }) != -1;
+}
+
+bool
+DiffMatching::pipelined() const
+{
+    return (notify_latency > 0 || match_width > 0 || pf_gen_width > 0) &&
+        !trainingOnly();
+}
+
+DiffMatching::NotifyWork *
+DiffMatching::allocateWork(NotifyWork::Kind kind)
+{
+    if (notifyCount == notifyQueue.size()) {
+        statsDMP.dmp_notifyDropped++;
+        return nullptr;
+    }
+    NotifyWork &work =
+        notifyQueue[(notifyHead + notifyCount) % notifyQueue.size()];
+    notifyCount++;
+
+    work.kind = kind;
+    work.ready = clockEdge(Cycles(notify_latency));
+    if (kind == NotifyWork::Kind::Fill && work.line.size() != blkSize) {
+        work.line.resize(blkSize);
+    }
+    schedulePipeline();
+    return &work;
+}
+
+void
+DiffMatching::processPipeline()
+{
+    lastPipelineTick = curTick();
+
+    // generation stage, fed by the fills matched in earlier cycles
+    int generated = 0;
+    while (!pfGenQueue.empty() &&
+           (pf_gen_width == 0 || generated < pf_gen_width)) {
+        const PfCandidate candidate = pfGenQueue.front();
+        pfGenQueue.pop_front();
+        insertIndirectPrefetch(candidate.pf_addr, candidate.target_pc,
+                               candidate.cID, candidate.priority);
+        generated++;
+    }
+    if (generated > 0) {
         processMissingTranslations(queueSize - pfq.size());
+        cache->schedulePrefetch();
     }
 
-    statsDMP.dmp_dataFill++;
+    // matching stage
+    int matched = 0;
+    while (notifyCount > 0 && (match_width == 0 || matched < match_width)) {
+        const NotifyWork &work = notifyQueue[notifyHead];
+        if (work.ready > curTick()) {
+            break;
+        }
+        switch (work.kind) {
+          case NotifyWork::Kind::L1Req:
+            trainTarget(work.pc, work.addr, work.cID);
+            break;
+          case NotifyWork::Kind::L1Resp:
+            trainIndex(work.pc, work.value, work.size, work.cID);
+            break;
+          case NotifyWork::Kind::Fill:
+            triggerRelations(work.pc, work.addr, work.own_prefetch,
+                             work.line.data());
+            break;
+        }
+        notifyHead = (notifyHead + 1) % notifyQueue.size();
+        notifyCount--;
+        matched++;
+    }
+
+    schedulePipeline();
+}
+
+void
+DiffMatching::schedulePipeline()
+{
+    if (pipelineEvent.scheduled() || (notifyCount == 0 && pfGenQueue.empty())) {
+        return;
+    }
+    // the pipeline advances once per cycle
+    Tick when = clockEdge();
+    if (lastPipelineTick != MaxTick && when <= lastPipelineTick) {
+        when = clockEdge(Cycles(1));
+    }
+    if (pfGenQueue.empty()) {
+        when = std::max(when, notifyQueue[notifyHead].ready);
+    }
+    schedule(pipelineEvent, when);
 }
 
 void 
@@ -829,11 +1414,13 @@ DiffMatching::insertIndirectPrefetch(Addr pf_addr, Addr target_pc, ContextID cID
     PrefetchInfo fake_pfi(blk_pf_addr, target_pc, requestorId, cID);
     
     statsDMP.dmp_pfIdentified++;
-    for (int i = 0; i < dmp_stats_pc.size(); i++) {
-        if (target_pc == dmp_stats_pc[i]) {
-            statsDMP.dmp_pfIdentifiedPerPfPC[i]++;
-            break;
-        }
+    dmp_stats_pc_index.discover(target_pc);
+    if (int i = dmp_stats_pc_index.find(target_pc); i >= 0) {
+        statsDMP.dmp_pfIdentifiedPerPfPC[i]++;
+    }
+
+    if (trainingOnly()) {
+        return;
     }
 
     /* filter repeat request */
@@ -857,8 +1444,15 @@ DiffMatching::insertIndirectPrefetch(Addr pf_addr, Addr target_pc, ContextID cID
 
     // TODO: should set ContextID
 
+    /* a page in the prefetcher TLB needs no translation request */
+    Addr pf_paddr;
+    if (pfTLBTranslate(pf_addr, cID, fake_pfi.isSecure(), pf_paddr)) {
+        queueTranslated(dpp, pf_paddr);
+        return;
+    }
+
     /* make translation request and set PREFETCH flag*/
-    RequestPtr translation_req = std::make_shared<Request>(
+    RequestPtr translation_req = Request::create(
         pf_addr, blkSize, Request::PREFETCH, requestorId, 
         target_pc, cID);
 
@@ -907,6 +1501,11 @@ DiffMatching::notify (const PacketPtr &pkt, const PrefetchInfo &pfi)
 
     assert(pkt->isRequest());
 
+    // remember which core (PC table) a context's demands come from
+    if (pkt->req->hasContextId()) {
+        requestor_of_context[pkt->req->contextId()] = pkt->req->requestorId();
+    }
+
     // TODO: Should we do further prefetch for high level cache prefetch ?
     // e.g. L1 Prefetch Request access and hit at L2.
     // currently L1 HWPrefetch Request will be translated to ReadShared request at L2.
@@ -914,12 +1513,16 @@ DiffMatching::notify (const PacketPtr &pkt, const PrefetchInfo &pfi)
     //if (!pkt->req->isPrefetch()) {
         // Test again in Cache which prefetch send to, in case ppMiss->notify() from other position.
         // When this called by ppHit->notify(), we use cache blk data to prefetch.
-        CacheBlk* try_cache_blk = cache->getCacheBlk(pkt->getAddr(), pkt->isSecure());
+        // Only the index PCs of relations need the block, skip the tag
+        // lookup for every other access.
+        if (pkt->req->hasPC() && hasActiveRelation(pkt->req->getPC())) {
+            CacheBlk* try_cache_blk = cache->getCacheBlk(pkt->getAddr(), pkt->isSecure());
 
-        // assert(try_cache_blk && try_cache_blk->data);
+            // assert(try_cache_blk && try_cache_blk->data);
 
-        if (try_cache_blk != nullptr && try_cache_blk->data) {
-            notifyFill(pkt, try_cache_blk->data);
+            if (try_cache_blk != nullptr && try_cache_blk->data) {
+                notifyFill(pkt, try_cache_blk->data);
+            }
         }
     //}
 
@@ -950,20 +1553,293 @@ DiffMatching::callReadytoIssue(const PrefetchInfo& pfi)
     }
 }
 
+int
+DiffMatching::partitionKey(ContextID cID) const
+{
+    if (partition_by_core && cache != nullptr &&
+            cID >= 0 && cID < cache->system->threads.size()) {
+        return cache->system->threads[cID]->cpuId();
+    }
+    return cID;
+}
+
+bool
+DiffMatching::checkRangeStride(Addr index_pc, ContextID cID) const
+{
+    if (!pf_helpers.empty()) {
+        auto helper = pf_helper_of_context.find(cID);
+        if (helper != pf_helper_of_context.end()) {
+            return helper->second->checkStride(index_pc);
+        }
+
+        // no helper bound to this core, search for all helpers
+        for (auto s : pf_helpers) {
+            if (s->checkStride(index_pc)) return true;
+        }
+        return false;
+    }
+
+    // stream detection of the requesting core
+    auto requestor = requestor_of_context.find(cID);
+    if (requestor != requestor_of_context.end()) {
+        return this->checkStride(index_pc, requestor->second);
+    }
+
+    // search for all requestor
+    return this->checkStride(index_pc);
+}
+
+void
+DiffMatching::addPfHelper(Stride* s, int context)
+{
+    fatal_if(s == this, "DMP can not be its own PfHelper");
+    fatal_if(s->eventQueue() != eventQueue(),
+             "PfHelper %s is on another event queue than %s, it can not "
+             "be called directly.", s->name(), name());
+
+    if (context >= 0) {
+        fatal_if(pf_helper_of_context.count(context),
+                 "PfHelper already registered for context %d", context);
+        pf_helper_of_context[context] = s;
+    }
+
+    if (std::find(pf_helpers.begin(), pf_helpers.end(), s) ==
+            pf_helpers.end()) {
+        pf_helpers.push_back(s);
+    }
+}
+
 void
-DiffMatching::addPfHelper(Stride* s)
+DiffMatching::writeHints() const
 {
-    fatal_if(pf_helper != nullptr, "Only one PfHelper can be registered");
-    pf_helper = s;
+    DMPHints hints;
+    for (const auto &rt_ent : relationTable) {
+        if (!rt_ent.valid) continue;
+        hints.addRelation(rt_ent.index_pc, rt_ent.target_pc, rt_ent.range);
+    }
+
+    OutputStream *out = simout.create(name() + ".hints");
+    std::ostream &os = *out->stream();
+    ccprintf(os, "# relations of %s at tick %d\n", name(), curTick());
+    hints.write(os);
+    simout.close(out);
+}
+
+void
+DiffMatching::serialize(CheckpointOut &cp) const
+{
+    Stride::serialize(cp);
+
+    ScopedCheckpointSection sec(cp, "dmp");
+    SERIALIZE_SCALAR(cur_range_priority);
+    SERIALIZE_SCALAR(rg_ptr);
+    SERIALIZE_SCALAR(iq_ptr);
+
+    std::vector<std::pair<ContextID, RequestorID>> requestors(
+        requestor_of_context.begin(), requestor_of_context.end());
+    std::sort(requestors.begin(), requestors.end());
+    std::vector<ContextID> contexts;
+    std::vector<std::string> requestor_names;
+    for (const auto &requestor : requestors) {
+        std::string requestor_name = requestorName(requestor.second);
+        if (requestor_name.empty()) continue;
+        contexts.push_back(requestor.first);
+        requestor_names.push_back(requestor_name);
+    }
+    arrayParamOut(cp, "contexts", contexts);
+    arrayParamOut(cp, "requestors", requestor_names);
+
+    // table sections come last, each writes its own scalars first
+    {
+        ScopedCheckpointSection table_sec(cp, "iddt");
+        paramOut(cp, "diffNum", iddt_diff_num);
+        iddtParts.serialize(cp);
+        serializeTable(cp, indexDataDeltaTable, [this](int slot) {
+            return indexDataDeltaTable[slot].isValid() ||
+                   iddtIndex.assigned(slot);
+        });
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "tadt");
+        paramOut(cp, "diffNum", tadt_diff_num);
+        tadtParts.serialize(cp);
+        serializeTable(cp, targetAddrDeltaTable, [this](int slot) {
+            return targetAddrDeltaTable[slot].isValid() ||
+                   tadtIndex.assigned(slot);
+        });
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "rangeTable");
+        paramOut(cp, "rangeUnit", range_unit_param);
+        paramOut(cp, "rangeLevel", range_level_param);
+        serializeTable(cp, rangeTable, [this](int slot) {
+            return rangeTable[slot].valid || rgIndex.assigned(slot);
+        });
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "indexQueue");
+        serializeTable(cp, indexQueue, [this](int slot) {
+            return indexQueue[slot].valid;
+        });
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "ics");
+        icsParts.serialize(cp);
+        serializeTable(cp, indirectCandidateScoreboard, [this](int slot) {
+            return indirectCandidateScoreboard[slot].valid;
+        });
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "relationTable");
+        rtParts.serialize(cp);
+        serializeTable(cp, relationTable, [this](int slot) {
+            return relationTable[slot].valid ||
+                   rtIndexPCIndex.assigned(slot);
+        });
+    }
+}
+
+void
+DiffMatching::unserialize(CheckpointIn &cp)
+{
+    Stride::unserialize(cp);
+
+    // checkpoints taken before the prefetcher state was saved
+    if (!cp.sectionExists(Serializable::currentSection() + ".dmp")) {
+        return;
+    }
+
+    ScopedCheckpointSection sec(cp, "dmp");
+    UNSERIALIZE_SCALAR(cur_range_priority);
+    UNSERIALIZE_SCALAR(rg_ptr);
+    UNSERIALIZE_SCALAR(iq_ptr);
+
+    std::vector<ContextID> contexts;
+    std::vector<std::string> requestor_names;
+    arrayParamIn(cp, "contexts", contexts);
+    arrayParamIn(cp, "requestors", requestor_names);
+    fatal_if(contexts.size() != requestor_names.size(),
+             "Inconsistent DMP requestors in %s\n",
+             Serializable::currentSection());
+    requestor_of_context.clear();
+    for (int i = 0; i < contexts.size(); i++) {
+        RequestorID requestor = requestorByName(requestor_names[i]);
+        if (requestor != Request::invldRequestorId) {
+            requestor_of_context[contexts[i]] = requestor;
+        }
+    }
+
+    // the checkpoint replaces the entries set up from the init PCs
+    for (int slot = 0; slot < iddt_ent_num; slot++) {
+        indexDataDeltaTable[slot].invalidate();
+        iddtIndex.release(slot);
+    }
+    for (int slot = 0; slot < tadt_ent_num; slot++) {
+        targetAddrDeltaTable[slot].invalidate();
+        tadtIndex.release(slot);
+    }
+    for (int slot = 0; slot < rangeTable.size(); slot++) {
+        rangeTable[slot].invalidate();
+        rgIndex.release(slot);
+    }
+    for (auto &iq_ent : indexQueue) {
+        iq_ent.invalidate();
+    }
+    for (auto &ics_ent : indirectCandidateScoreboard) {
+        ics_ent.invalidate();
+    }
+    for (int slot = 0; slot < rt_ent_num; slot++) {
+        relationTable[slot].invalidate();
+        rtIndexPCIndex.release(slot);
+        rtTargetPCIndex.release(slot);
+    }
+
+    auto not_restored = [this](const char *table) {
+        warn("%s: %s differs from the checkpointed one, it starts empty\n",
+             name(), table);
+    };
+    auto parts_not_restored = [this](const char *table) {
+        warn("%s: %s partitions differ from the checkpointed ones, "
+             "their replacement order restarts\n", name(), table);
+    };
+
+    {
+        ScopedCheckpointSection table_sec(cp, "iddt");
+        int diff_num;
+        paramIn(cp, "diffNum", diff_num);
+        if (diff_num != iddt_diff_num ||
+            !unserializeTable(cp, indexDataDeltaTable, [this](int slot) {
+                iddtIndex.assign(slot, indexDataDeltaTable[slot].getPC());
+            })) {
+            not_restored("IDDT");
+        } else if (!iddtParts.unserialize(cp)) {
+            parts_not_restored("IDDT");
+        }
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "tadt");
+        int diff_num;
+        paramIn(cp, "diffNum", diff_num);
+        if (diff_num != tadt_diff_num ||
+            !unserializeTable(cp, targetAddrDeltaTable, [this](int slot) {
+                tadtIndex.assign(slot, targetAddrDeltaTable[slot].getPC());
+            })) {
+            not_restored("TADT");
+        } else if (!tadtParts.unserialize(cp)) {
+            parts_not_restored("TADT");
+        }
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "rangeTable");
+        int range_unit;
+        int range_level;
+        paramIn(cp, "rangeUnit", range_unit);
+        paramIn(cp, "rangeLevel", range_level);
+        if (range_unit != range_unit_param ||
+            range_level != range_level_param ||
+            !unserializeTable(cp, rangeTable, [this](int slot) {
+                rgIndex.assign(slot, rangeTable[slot].target_pc);
+            })) {
+            not_restored("RangeTable");
+        }
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "indexQueue");
+        if (!unserializeTable(cp, indexQueue, [](int slot) {})) {
+            not_restored("IndexQueue");
+        }
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "ics");
+        if (!unserializeTable(cp, indirectCandidateScoreboard,
+                              [](int slot) {})) {
+            not_restored("ICS");
+        } else if (!icsParts.unserialize(cp)) {
+            parts_not_restored("ICS");
+        }
+    }
+    {
+        ScopedCheckpointSection table_sec(cp, "relationTable");
+        if (!unserializeTable(cp, relationTable, [this](int slot) {
+                rtIndexPCIndex.assign(slot, relationTable[slot].index_pc);
+                rtTargetPCIndex.assign(slot, relationTable[slot].target_pc);
+            })) {
+            not_restored("RelationTable");
+        } else if (!rtParts.unserialize(cp)) {
+            parts_not_restored("RelationTable");
+        }
+    }
+
+    if (rg_ptr < 0 || rg_ptr >= rangeTable.size()) rg_ptr = 0;
+    if (iq_ptr < 0 || iq_ptr >= indexQueue.size()) iq_ptr = 0;
 }
 
 void
 DiffMatching::calculatePrefetch(const PrefetchInfo &pfi, std::vector<AddrPriority> &addresses) 
 {
-    if (pf_helper) {
+    if (!pf_helpers.empty()) {
         // use fake_addresses to drop Stride Prefetch while keep updating pcTables
-        std::vector<AddrPriority> fake_addresses;
-
+        fake_addresses.clear();
         Stride::calculatePrefetch(pfi, fake_addresses);
     } else {
         Stride::calculatePrefetch(pfi, addresses);
@@ -981,6 +1857,43 @@ DiffMatching::calculatePrefetch(const PrefetchInfo &pfi, std::vector<AddrPriorit
     }
 }
 
+bool
+DiffMatching::setRuntimeParam(const std::string &name,
+                              const std::string &value)
+{
+    int *param = nullptr;
+    if (name == "indir_range") {
+        param = &indir_range;
+    } else if (name == "range_ahead_dist") {
+        param = &range_ahead_dist;
+    } else if (name == "chain_depth") {
+        param = &chain_depth;
+    } else {
+        return Stride::setRuntimeParam(name, value);
+    }
+
+    int new_value;
+    if (!to_number(value, new_value) || new_value < 0) {
+        return false;
+    }
+    *param = new_value;
+
+    // the relations already trained follow the new degree and distance
+    if (param != &chain_depth) {
+        for (RTEntry &rt_ent : relationTable) {
+            if (!rt_ent.valid) continue;
+            if (param == &indir_range) {
+                rt_ent.base_degree = rt_ent.range ?
+                    predictRangeDegree(rt_ent.index_pc, rt_ent.index_size,
+                                       rt_ent.cID) :
+                    indir_range;
+            }
+            applyThrottle(rt_ent);
+        }
+    }
+    return true;
+}
+
 } // namespace prefetch
 
 } // namespace gem5
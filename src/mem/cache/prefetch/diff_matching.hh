@@ -5,13 +5,16 @@
 #ifndef __MEM_CACHE_PREFETCH_DIFF_MATCHING_HH__
 #define __MEM_CACHE_PREFETCH_DIFF_MATCHING_HH__
 
+#include <deque>
 #include <vector>
 #include <queue>
 #include <unordered_map>
 
 #include "base/types.hh"
+#include "mem/cache/prefetch/pc_table_index.hh"
 #include "mem/cache/prefetch/stride.hh"
 #include "mem/cache/prefetch/queued.hh"
+#include "mem/cache/prefetch/table_partition.hh"
 #include "sim/eventq.hh"
 
 namespace gem5
@@ -40,12 +43,86 @@ class DiffMatching : public Stride
     int range_ahead_dist;
     int indir_range;
 
-    int notify_latency;
+    /**
+     * Notification pipeline. L1 requests and responses, and fills, are
+     * handled notify_latency cycles after their probe, at most
+     * match_width of them per cycle. The indirect prefetches a fill
+     * triggers are generated the next cycles, at most pf_gen_width per
+     * cycle. Without latency and width limits (or in atomic mode) all
+     * of it is done in the probe.
+     */
+    const int notify_latency;
+    const int match_width;
+    const int pf_gen_width;
+
+    /** A probe waiting in the notification pipeline */
+    struct NotifyWork
+    {
+        enum class Kind { L1Req, L1Resp, Fill };
+        Kind kind;
+        /** Tick the work can be handled at */
+        Tick ready;
+        Addr pc;
+        /** Virtual address of a request, physical address of a fill */
+        Addr addr;
+        ContextID cID;
+        /** Data of a response */
+        uint64_t value;
+        unsigned size;
+        /** Whether the fill is of a DMP prefetch */
+        bool own_prefetch;
+        /** Data of the filled line, sized at construction */
+        std::vector<uint8_t> line;
+    };
+
+    /** Ring of pending probes, allocated once */
+    std::vector<NotifyWork> notifyQueue;
+    unsigned notifyHead;
+    unsigned notifyCount;
+
+    /** An indirect prefetch waiting to be generated */
+    struct PfCandidate
+    {
+        Addr pf_addr;
+        Addr target_pc;
+        ContextID cID;
+        int32_t priority;
+    };
+    std::deque<PfCandidate> pfGenQueue;
+    const unsigned pf_gen_queue_size;
+
+    EventFunctionWrapper pipelineEvent;
+    /** Last tick the pipeline advanced, it advances once per cycle */
+    Tick lastPipelineTick;
+
+    /** Whether probes go through the notification pipeline */
+    bool pipelined() const;
+
+    /**
+     * Slot for a new probe at the tail of the pipeline, or nullptr if
+     * it is full.
+     */
+    NotifyWork *allocateWork(NotifyWork::Kind kind);
+
+    /** Advance the pipeline by one cycle */
+    void processPipeline();
+
+    void schedulePipeline();
 
     // priority init
     int32_t cur_range_priority;
     int32_t range_group_size;
 
+    /**
+     * Partition IDDT/TADT/ICS/RT by core instead of by ContextID.
+     * The number of partitions and their budgets are given by the
+     * partition_* params, see TablePartitions.
+     */
+    const bool partition_by_core;
+
+    /** Key (ContextID or core id) selecting a context's partition */
+    int partitionKey(ContextID cID) const;
+
     // possiable shift values
     const unsigned int shift_v[4] = {0, 1, 2, 3};
 
@@ -53,17 +130,28 @@ class DiffMatching : public Stride
     const int iddt_diff_num;
     const int tadt_diff_num;
 
+    /** Per start offset shift-match bits from diffSeqMatch() */
+    std::vector<uint8_t> match_mask;
+
+    /**
+     * Diff-sequence ring. Every diff is stored twice, at diff_ptr and
+     * diff_ptr + diff_size, so the diff_size diffs starting at the
+     * oldest one are always contiguous and can be fed to the
+     * diffSeqMatch() kernel without unrolling the ring.
+     */
     template <typename T>
     class DiffSeqCollection
     {
+      protected:
         Addr pc;
         bool valid;
         bool ready;
         ContextID cID;
         T last;
 
+        // oldest diff once ready, next free position before
         int diff_ptr;
-        const int diff_size;
+        int diff_size;
         std::vector<T> diff;
 
       public:
@@ -71,17 +159,15 @@ class DiffMatching : public Stride
         // normal constructor
         DiffSeqCollection(Addr pc, T last, int diff_size)
           : pc(pc), valid(false), ready(false), cID(0), 
-            last(last), diff_ptr(0), diff_size(diff_size) 
-        {
-            diff.reserve(diff_size);
-        };
+            last(last), diff_ptr(0), diff_size(diff_size),
+            diff(2 * diff_size, 0)
+        {};
 
         // init constructor
         DiffSeqCollection(int diff_size, bool valid = false)
-         : valid(valid), diff_size(diff_size)
-        {
-           diff.reserve(diff_size);
-        };
+         : valid(valid), ready(false), diff_ptr(0), diff_size(diff_size),
+           diff(2 * diff_size, 0)
+        {};
 
         ~DiffSeqCollection() = default;
 
@@ -92,20 +178,14 @@ class DiffMatching : public Stride
             diff_ptr = 0;
             cID = 0;
             valid = false;
-            diff.clear();
+            ready = false;
         };
 
         void fill (T last_in, ContextID cID_in)
         {
             if (cID_in != cID) return;
 
-            if (ready) {
-                diff[diff_ptr] = last_in - last;
-                diff_ptr = (diff_ptr+1) % diff_size;
-            } else {
-                diff.push_back(last_in - last);
-                if (diff.size() == diff_size) ready = true;
-            }
+            push(last_in - last);
             last = last_in;
         };
 
@@ -119,8 +199,54 @@ class DiffMatching : public Stride
 
         T getLast() const {return last; };
 
-        T operator[](int index) const { return diff[ (diff_ptr+index) % diff_size ]; };
+        T operator[](int index) const
+        {
+            return ready ? diff[diff_ptr + index] : diff[index];
+        };
+
+        /** Linearized diffs, oldest first. Only complete when ready. */
+        const T* data() const { return &diff[ready ? diff_ptr : 0]; };
+
+        /** The diff_size of the checkpoint must be the one of the entry */
+        void
+        serialize(CheckpointOut &cp) const
+        {
+            SERIALIZE_SCALAR(pc);
+            SERIALIZE_SCALAR(valid);
+            SERIALIZE_SCALAR(ready);
+            SERIALIZE_SCALAR(cID);
+            SERIALIZE_SCALAR(last);
+            SERIALIZE_SCALAR(diff_ptr);
+            SERIALIZE_CONTAINER(diff);
+        }
+
+        void
+        unserialize(CheckpointIn &cp)
+        {
+            UNSERIALIZE_SCALAR(pc);
+            UNSERIALIZE_SCALAR(valid);
+            UNSERIALIZE_SCALAR(ready);
+            UNSERIALIZE_SCALAR(cID);
+            UNSERIALIZE_SCALAR(last);
+            UNSERIALIZE_SCALAR(diff_ptr);
+            arrayParamIn(cp, "diff", diff.data(), diff.size());
+        }
 
+      protected:
+        /** Append a diff to the ring */
+        void push(T diff_in)
+        {
+            diff[diff_ptr] = diff_in;
+            diff[diff_ptr + diff_size] = diff_in;
+            if (ready) {
+                diff_ptr = (diff_ptr+1) % diff_size;
+            } else if (++diff_ptr == diff_size) {
+                diff_ptr = 0;
+                ready = true;
+            }
+        };
+
+      public:
         DiffSeqCollection& update(Addr pc_new, ContextID cID_new, T last_new = 0)
         {
             pc = pc_new;
@@ -129,19 +255,101 @@ class DiffMatching : public Stride
             ready = false;
             valid = false;
             diff_ptr = 0;
-            diff.clear();
             return *this;
         };
     };
 
-    typedef DiffSeqCollection<IndexData> iddt_ent_t;
+    /**
+     * Sign- or zero-extend the low size bytes of raw, i.e. an index
+     * element of that width, to 64 bits.
+     */
+    static int64_t extendIndex(uint64_t raw, int size, bool is_signed);
+
+    /**
+     * IDDT entry. Besides the diff sequence it learns the width and the
+     * signedness of the index elements loaded by its PC.
+     *
+     * Diffs are taken modulo the element width, so they do not depend
+     * on signedness. Signedness only shows when consecutive indices
+     * cross a wrap-around point: crossing 0 <-> -1 is a small step for
+     * signed data, crossing 2^(w-1)-1 <-> 2^(w-1) is a small step for
+     * unsigned data. Each such crossing is counted as a vote.
+     */
+    class IndexDataCollection : public DiffSeqCollection<IndexData>
+    {
+        // bytes per index element, 0 until the first fill
+        int data_size;
+
+        int signed_votes;
+        int unsigned_votes;
+
+      public:
+        IndexDataCollection(int diff_size, bool valid = false)
+          : DiffSeqCollection<IndexData>(diff_size, valid),
+            data_size(0), signed_votes(0), unsigned_votes(0)
+        {};
+
+        /**
+         * Append an index element loaded by this PC.
+         * @param raw the loaded bytes, zero-extended
+         * @param size access size in bytes, a new width restarts training
+         * @param cID_in ContextID of the load
+         */
+        void fillData(uint64_t raw, int size, ContextID cID_in);
+
+        int getDataSize() const { return data_size; };
+
+        bool isSigned() const { return signed_votes > unsigned_votes; };
+
+        /** Last index element, extended with the learned signedness */
+        int64_t
+        getLastValue() const
+        {
+            return extendIndex(last, data_size, isSigned());
+        };
+
+        void
+        serialize(CheckpointOut &cp) const
+        {
+            DiffSeqCollection<IndexData>::serialize(cp);
+            SERIALIZE_SCALAR(data_size);
+            SERIALIZE_SCALAR(signed_votes);
+            SERIALIZE_SCALAR(unsigned_votes);
+        }
+
+        void
+        unserialize(CheckpointIn &cp)
+        {
+            DiffSeqCollection<IndexData>::unserialize(cp);
+            UNSERIALIZE_SCALAR(data_size);
+            UNSERIALIZE_SCALAR(signed_votes);
+            UNSERIALIZE_SCALAR(unsigned_votes);
+        }
+
+        IndexDataCollection&
+        update(Addr pc_new, ContextID cID_new, IndexData last_new = 0)
+        {
+            DiffSeqCollection<IndexData>::update(pc_new, cID_new, last_new);
+            data_size = 0;
+            signed_votes = 0;
+            unsigned_votes = 0;
+            return *this;
+        };
+    };
+
+    typedef IndexDataCollection iddt_ent_t;
     typedef DiffSeqCollection<TargetAddr> tadt_ent_t;
 
     std::vector<iddt_ent_t> indexDataDeltaTable;
     std::vector<tadt_ent_t> targetAddrDeltaTable;
 
-    int iddt_ptr;
-    int tadt_ptr;
+    /** Per-context partitions and FIFO pointers of IDDT and TADT */
+    TablePartitions iddtParts;
+    TablePartitions tadtParts;
+
+    /** PC -> slot lookup for IDDT and TADT */
+    PCTableIndex iddtIndex;
+    PCTableIndex tadtIndex;
 
     void insertIDDT(Addr index_pc_in, ContextID cID_in);
     void insertTADT(Addr target_pc_in, ContextID cID_in);
@@ -205,6 +413,32 @@ class DiffMatching : public Stride
                 std::max_element(sample_count.begin(), sample_count.end()));
         }
 
+        /** The range_quant_level of the checkpoint must be the entry's */
+        void
+        serialize(CheckpointOut &cp) const
+        {
+            SERIALIZE_SCALAR(target_pc);
+            SERIALIZE_ARRAY(cur_tail, 2);
+            SERIALIZE_SCALAR(cur_count);
+            SERIALIZE_SCALAR(cID);
+            SERIALIZE_SCALAR(valid);
+            SERIALIZE_SCALAR(shift_times);
+            SERIALIZE_CONTAINER(sample_count);
+        }
+
+        void
+        unserialize(CheckpointIn &cp)
+        {
+            UNSERIALIZE_SCALAR(target_pc);
+            UNSERIALIZE_ARRAY(cur_tail, 2);
+            UNSERIALIZE_SCALAR(cur_count);
+            UNSERIALIZE_SCALAR(cID);
+            UNSERIALIZE_SCALAR(valid);
+            UNSERIALIZE_SCALAR(shift_times);
+            arrayParamIn(cp, "sample_count", sample_count.data(),
+                         sample_count.size());
+        }
+
         RangeTableEntry& update(
             Addr target_pc_in,
             Addr req_addr_in,
@@ -227,6 +461,9 @@ class DiffMatching : public Stride
 
     int rg_ptr;
 
+    /** target PC -> slot lookup for RangeTable */
+    PCTableIndex rgIndex;
+
     void insertRG(Addr req_addr_in, Addr target_pc_in, ContextID cID_in);
 
     bool rangeFilter(Addr pc_in, Addr addr_in, ContextID cID_in);
@@ -247,12 +484,33 @@ class DiffMatching : public Stride
             tried(0), matched(0) {};
 
         // init constructor
-        IndexQueueEntry(bool valid = false) {};
+        IndexQueueEntry(bool valid = false)
+          : index_pc(0), cID(0), valid(valid), tried(0), matched(0) {};
 
         ~IndexQueueEntry() = default;
 
         float getWeight() const { return (matched + 1) / (tried + 1e-8); };
 
+        void
+        serialize(CheckpointOut &cp) const
+        {
+            SERIALIZE_SCALAR(index_pc);
+            SERIALIZE_SCALAR(cID);
+            SERIALIZE_SCALAR(valid);
+            SERIALIZE_SCALAR(tried);
+            SERIALIZE_SCALAR(matched);
+        }
+
+        void
+        unserialize(CheckpointIn &cp)
+        {
+            UNSERIALIZE_SCALAR(index_pc);
+            UNSERIALIZE_SCALAR(cID);
+            UNSERIALIZE_SCALAR(valid);
+            UNSERIALIZE_SCALAR(tried);
+            UNSERIALIZE_SCALAR(matched);
+        }
+
         void validate() { valid = true; };
 
         void invalidate() { valid = false; };
@@ -303,6 +561,9 @@ class DiffMatching : public Stride
 
         bool updateMiss (Addr miss_pc, int miss_thred);
 
+        void serialize(CheckpointOut &cp) const;
+        void unserialize(CheckpointIn &cp);
+
         ICSEntry& update(Addr index_pc_in, ContextID cID_in) {
             index_pc = index_pc_in;
             cID = cID_in;
@@ -313,7 +574,7 @@ class DiffMatching : public Stride
     };
     std::vector<ICSEntry> indirectCandidateScoreboard;
 
-    int ics_ptr;
+    TablePartitions icsParts;
 
     void notifyICSMiss(Addr miss_addr, Addr miss_pc_in, ContextID cID_in);
 
@@ -324,6 +585,15 @@ class DiffMatching : public Stride
 
     bool auto_detect;
 
+    /** Write the PCs of the valid relations to a hint file at exit */
+    bool record_hints;
+
+    /**
+     * Write the index, target and range PCs of the valid relations to
+     * <name>.hints in the output directory, in the hint_file format.
+     */
+    void writeHints() const;
+
     int detect_period;
 
     int ics_miss_threshold;
@@ -337,20 +607,39 @@ class DiffMatching : public Stride
         Addr target_pc;
         Addr target_base_addr;
         unsigned int shift;
+        // width (bytes) and signedness of the index elements
+        int index_size;
+        bool index_signed;
         bool range;
+        // degree predicted at insertion, and scaled by the throttle
+        int base_degree;
         int range_degree;
+        // blocks prefetched beyond a range target
+        int range_ahead;
         ContextID cID;
         bool valid;
         int32_t priority;
+        // position in an indirect chain, 1 if index_pc is no target
+        int chain_level;
+        // aggressiveness, see DiffMatching::throttleFeedback
+        int throttle_level;
+        // usefulness feedback since the last throttle adjustment
+        int pf_useful;
+        int pf_late;
+        int pf_unused;
 
         // normal constructor
         RTEntry(
             Addr index_pc, Addr target_pc, Addr target_base_addr, 
-            unsigned int shift, bool range, int range_degree, 
-            ContextID cID, int32_t priority
+            unsigned int shift, int index_size, bool index_signed,
+            bool range, int range_degree, ContextID cID, int32_t priority,
+            int chain_level
         ) : index_pc(index_pc), target_pc(target_pc), target_base_addr(target_base_addr),
-            shift(shift), range(range), range_degree(range_degree), cID(cID), valid(false),
-            priority(priority)
+            shift(shift), index_size(index_size), index_signed(index_signed),
+            range(range), base_degree(range_degree),
+            range_degree(range_degree), range_ahead(0), cID(cID),
+            valid(false), priority(priority), chain_level(chain_level),
+            throttle_level(0), pf_useful(0), pf_late(0), pf_unused(0)
             {}
 
         // default constructor
@@ -360,35 +649,61 @@ class DiffMatching : public Stride
 
         void invalidate() { valid = false; };
 
+        void serialize(CheckpointOut &cp) const;
+        void unserialize(CheckpointIn &cp);
+
         // update for new relation
         RTEntry& update(
             Addr index_pc_in,
             Addr target_pc_in,
             Addr target_base_addr_in,
             unsigned int shift_in,
+            int index_size_in,
+            bool index_signed_in,
             bool range_in,
             int range_degree_in,
             ContextID cID_in,
             bool valid_in,
-            int32_t priority_in
+            int32_t priority_in,
+            int chain_level_in
         ) {
             index_pc = index_pc_in;
             target_pc = target_pc_in;
             target_base_addr = target_base_addr_in;
             shift = shift_in;
+            index_size = index_size_in;
+            index_signed = index_signed_in;
             range = range_in;
+            base_degree = range_degree_in;
             range_degree = range_degree_in;
+            range_ahead = 0;
             cID = cID_in;
             valid = valid_in;
             priority = priority_in;
+            chain_level = chain_level_in;
+            throttle_level = 0;
+            pf_useful = 0;
+            pf_late = 0;
+            pf_unused = 0;
             
             return *this;
         };
     };
     std::vector<RTEntry> relationTable;
 
-    // point to the next update position
-    int rt_ptr; 
+    // per-context partitions, point to the next update positions
+    TablePartitions rtParts;
+
+    /** index PC / target PC -> slot lookup for RelationTable */
+    PCTableIndex rtIndexPCIndex;
+    PCTableIndex rtTargetPCIndex;
+
+    /**
+     * Whether pc is the index PC of a valid relation, i.e. whether its
+     * data may trigger prefetches. Checked before the block lookup and
+     * line copy of every notified access and fill.
+     */
+    bool hasActiveRelation(Addr pc) const;
 
     bool findRTE(Addr index_pc, Addr target_pc, ContextID cID);
 
@@ -401,12 +716,72 @@ class DiffMatching : public Stride
 
     int32_t getPriority(Addr target_pc, ContextID cID);
 
+    /**
+     * Initial range degree of a range-type relation: the most frequent
+     * run length in the RangeTable histogram of its index PC, at most
+     * indir_range. indir_range if there is no histogram.
+     */
+    int predictRangeDegree(Addr index_pc, int index_size, ContextID cID);
+
+    /**
+     * Feedback-directed throttle (in the spirit of FDP). Each relation
+     * has an aggressiveness level in [1, ThrottleLevels], starting in
+     * the middle. Every throttle_period feedback events its accuracy
+     * (used / (used + unused), used = useful + late) and lateness
+     * (late / used) move the level:
+     *
+     *   accuracy >= high:       up if late, else keep
+     *   low <= accuracy < high: keep
+     *   accuracy < low:         down
+     *
+     * The level scales the range degree by 2^(level - middle) and
+     * moves range_ahead_dist by (level - middle) blocks.
+     */
+    static constexpr int ThrottleLevels = 5;
+    const int throttle_period;
+    const double throttle_acc_high;
+    const double throttle_acc_low;
+    const double throttle_late;
+    const int throttle_init_level;
+
+    enum class Feedback { Useful, Late, Unused };
+
+    /** Count feedback for relations targeting pc, adjust their level */
+    void throttleFeedback(Addr pc, Feedback kind);
+
+    /** Apply the throttle level of a relation to degree and distance */
+    void applyThrottle(RTEntry& rt_ent);
+
+    /**
+     * Chained indirect prefetch (e.g. A[B[C[i]]]): the target of a
+     * level N relation is the index of a level N+1 relation, so a
+     * prefetched level N line which fills generates level N+1
+     * prefetches in notifyFill. Fills of DMP's own prefetches only
+     * trigger relations up to chain_depth, demand data triggers any.
+     */
+    int chain_depth;
+
+    /**
+     * Index elements dereferenced per filled line by range relations
+     * of each chain level, the relation's range degree if not given.
+     */
+    const std::vector<int> chain_lookahead;
+
+    /** Chain level of a relation whose index is loaded by index_pc */
+    int getChainLevel(Addr index_pc, ContextID cID);
+
+    /**
+     * A relation producing index_pc got the given level, move the
+     * relations it feeds (transitively) further down the chain.
+     */
+    void updateChainLevel(Addr index_pc, int level, ContextID cID);
+
 
     /** DMP specific stats */
     struct DMPStats : public statistics::Group
     {
         DMPStats(statistics::Group *parent);
-        void regStatsPerPC(const std::vector<Addr>& PC_list);
+        void regStatsPerPC(const PCStatsIndex &stats_pc_index);
 
         // STATS
         statistics::Scalar dmp_pfIdentified;
@@ -414,12 +789,37 @@ class DiffMatching : public Stride
         statistics::Scalar dmp_noValidData;
         statistics::Vector dmp_noValidDataPerPC;
         statistics::Scalar dmp_dataFill;
+        statistics::Scalar dmp_notifyDropped;
+        statistics::Scalar dmp_pfGenDropped;
+        statistics::Scalar dmp_poolDemotions;
+        statistics::Scalar dmp_throttleUp;
+        statistics::Scalar dmp_throttleDown;
+        statistics::Distribution dmp_throttleLevel;
     } statsDMP;
 
-    std::vector<Addr> dmp_stats_pc;
+    /** PCs with per-PC DMP statistics */
+    PCStatsIndex dmp_stats_pc_index;
 
-    // A StridePrefetcher which helps DMP detection.
-    Stride* pf_helper;
+    // StridePrefetchers which help DMP detection,
+    // e.g. the per-core L1 helpers of a shared L2 DMP.
+    std::vector<Stride*> pf_helpers;
+
+    // discarded Stride candidates when helpers drive the stream,
+    // kept to reuse the storage on every notification
+    std::vector<AddrPriority> fake_addresses;
+
+    // helper belonging to the core of each ContextID
+    std::unordered_map<ContextID, Stride*> pf_helper_of_context;
+
+    // RequestorID last seen for each ContextID, selects the
+    // per-core PC table of DMP's own stride detection
+    std::unordered_map<ContextID, RequestorID> requestor_of_context;
+
+    /**
+     * Stride PC should be classified as Range. Query the helper of the
+     * requesting core, or DMP's own stream detection for that core.
+     */
+    bool checkRangeStride(Addr index_pc, ContextID cID) const;
 
     /** DMP functions */
 
@@ -447,10 +847,51 @@ class DiffMatching : public Stride
     void insertIndirectPrefetch(Addr pf_addr, Addr target_pc, 
                                 ContextID cID, int32_t priority);
 
-    void addPfHelper(Stride* s);
+    /** Train the TADT with a demand request */
+    void trainTarget(Addr pc, Addr vaddr, ContextID cID);
+
+    /** Train the IDDT with the data of a demand response */
+    void trainIndex(Addr pc, uint64_t resp_data, unsigned data_size,
+                    ContextID cID);
+
+    /**
+     * Trigger the relations of a filled line: each index it holds
+     * yields an indirect prefetch, generated now or through the
+     * pipeline.
+     */
+    void triggerRelations(Addr pc, Addr paddr, bool own_prefetch,
+                          const uint8_t *fill_data);
+
+    void notifyPrefetchUseful(Addr pc) override;
+    void notifyPrefetchLate(Addr pc) override;
+    void notifyPrefetchUnused(Addr pc) override;
+
+    /**
+     * Register a StridePrefetcher helper.
+     * @param s the helper
+     * @param context ContextID of the core the helper belongs to,
+     *        or -1 if it observes every core
+     */
+    void addPfHelper(Stride* s, int context);
 
     void calculatePrefetch(const PrefetchInfo &pfi,
                            std::vector<AddrPriority> &addresses) override;
+
+    /**
+     * Also accepts "indir_range", "range_ahead_dist" and "chain_depth".
+     * The degree and distance of the trained relations are updated too.
+     */
+    bool setRuntimeParam(const std::string &name,
+                         const std::string &value) override;
+
+    /**
+     * Checkpoint the training state: the tables (with their replacement
+     * pointers) and the requestor of each ContextID, by name. Tables
+     * are restored slot by slot, so a table whose geometry differs from
+     * the checkpoint one restarts empty.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 } // namespace prefetch
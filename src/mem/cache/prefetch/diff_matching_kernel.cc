@@ -0,0 +1,180 @@
+#include "mem/cache/prefetch/diff_matching_kernel.hh"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DMP_KERNEL_X86 1
+#include <immintrin.h>
+#else
+#define DMP_KERNEL_X86 0
+#endif
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+namespace
+{
+
+/** Match start offsets [first, num_starts) one by one */
+void
+matchScalar(const int64_t *idx, const int64_t *tgt, int tgt_len,
+            const unsigned *shifts, int num_shifts,
+            uint8_t *match_mask, int first, int num_starts)
+{
+    for (int i_start = first; i_start < num_starts; i_start++) {
+        for (int s = 0; s < num_shifts; s++) {
+            int t = 0;
+            while (t < tgt_len && idx[i_start + t] == (tgt[t] >> shifts[s])) {
+                t++;
+            }
+            if (t == tgt_len) {
+                match_mask[i_start] |= (1 << s);
+            }
+        }
+    }
+}
+
+#if DMP_KERNEL_X86
+
+/**
+ * Lanes hold consecutive start offsets, so each vector compare tests the
+ * same target diff against 2 (SSE4) or 4 (AVX2) windows at once.
+ */
+__attribute__((target("sse4.1")))
+void
+matchSSE4(const int64_t *idx, const int64_t *tgt, int tgt_len,
+          const unsigned *shifts, int num_shifts,
+          uint8_t *match_mask, int num_starts)
+{
+    int i0 = 0;
+    for (; i0 + 2 <= num_starts; i0 += 2) {
+        for (int s = 0; s < num_shifts; s++) {
+            __m128i acc = _mm_set1_epi64x(-1);
+            for (int t = 0; t < tgt_len; t++) {
+                __m128i v = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(idx + i0 + t));
+                __m128i b = _mm_set1_epi64x(tgt[t] >> shifts[s]);
+                acc = _mm_and_si128(acc, _mm_cmpeq_epi64(v, b));
+                if (_mm_testz_si128(acc, acc)) break;
+            }
+            int bits = _mm_movemask_pd(_mm_castsi128_pd(acc));
+            for (int lane = 0; lane < 2; lane++) {
+                if (bits & (1 << lane)) {
+                    match_mask[i0 + lane] |= (1 << s);
+                }
+            }
+        }
+    }
+    matchScalar(idx, tgt, tgt_len, shifts, num_shifts,
+                match_mask, i0, num_starts);
+}
+
+__attribute__((target("avx2")))
+void
+matchAVX2(const int64_t *idx, const int64_t *tgt, int tgt_len,
+          const unsigned *shifts, int num_shifts,
+          uint8_t *match_mask, int num_starts)
+{
+    int i0 = 0;
+    for (; i0 + 4 <= num_starts; i0 += 4) {
+        for (int s = 0; s < num_shifts; s++) {
+            __m256i acc = _mm256_set1_epi64x(-1);
+            for (int t = 0; t < tgt_len; t++) {
+                __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(idx + i0 + t));
+                __m256i b = _mm256_set1_epi64x(tgt[t] >> shifts[s]);
+                acc = _mm256_and_si256(acc, _mm256_cmpeq_epi64(v, b));
+                if (_mm256_testz_si256(acc, acc)) break;
+            }
+            int bits = _mm256_movemask_pd(_mm256_castsi256_pd(acc));
+            for (int lane = 0; lane < 4; lane++) {
+                if (bits & (1 << lane)) {
+                    match_mask[i0 + lane] |= (1 << s);
+                }
+            }
+        }
+    }
+    matchScalar(idx, tgt, tgt_len, shifts, num_shifts,
+                match_mask, i0, num_starts);
+}
+
+#endif // DMP_KERNEL_X86
+
+} // anonymous namespace
+
+bool
+diffMatchImplSupported(DiffMatchImpl impl)
+{
+    switch (impl) {
+      case DiffMatchImpl::Scalar:
+        return true;
+#if DMP_KERNEL_X86
+      case DiffMatchImpl::SSE4:
+        return __builtin_cpu_supports("sse4.1");
+      case DiffMatchImpl::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+      default:
+        return false;
+    }
+}
+
+DiffMatchImpl
+diffMatchBestImpl()
+{
+    static const DiffMatchImpl best =
+        diffMatchImplSupported(DiffMatchImpl::AVX2) ? DiffMatchImpl::AVX2 :
+        diffMatchImplSupported(DiffMatchImpl::SSE4) ? DiffMatchImpl::SSE4 :
+        DiffMatchImpl::Scalar;
+    return best;
+}
+
+void
+diffSeqMatch(DiffMatchImpl impl,
+             const int64_t *idx, int idx_len,
+             const int64_t *tgt, int tgt_len,
+             const unsigned *shifts, int num_shifts,
+             uint8_t *match_mask)
+{
+    assert(tgt_len <= idx_len);
+    assert(num_shifts <= MaxDiffMatchShifts);
+    assert(diffMatchImplSupported(impl));
+
+    const int num_starts = idx_len - tgt_len + 1;
+    std::memset(match_mask, 0, num_starts);
+
+    switch (impl) {
+#if DMP_KERNEL_X86
+      case DiffMatchImpl::AVX2:
+        matchAVX2(idx, tgt, tgt_len, shifts, num_shifts,
+                  match_mask, num_starts);
+        break;
+      case DiffMatchImpl::SSE4:
+        matchSSE4(idx, tgt, tgt_len, shifts, num_shifts,
+                  match_mask, num_starts);
+        break;
+#endif
+      default:
+        matchScalar(idx, tgt, tgt_len, shifts, num_shifts,
+                    match_mask, 0, num_starts);
+        break;
+    }
+}
+
+void
+diffSeqMatch(const int64_t *idx, int idx_len,
+             const int64_t *tgt, int tgt_len,
+             const unsigned *shifts, int num_shifts,
+             uint8_t *match_mask)
+{
+    diffSeqMatch(diffMatchBestImpl(), idx, idx_len, tgt, tgt_len,
+                 shifts, num_shifts, match_mask);
+}
+
+} // namespace prefetch
+} // namespace gem5
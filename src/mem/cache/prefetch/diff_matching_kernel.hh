@@ -0,0 +1,69 @@
+/**
+ * Difference-sequence matching kernel of the Difference-based prefetcher
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_DIFF_MATCHING_KERNEL_HH__
+#define __MEM_CACHE_PREFETCH_DIFF_MATCHING_KERNEL_HH__
+
+#include <cstdint>
+
+#include "base/compiler.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/** Host implementations of the matching kernel */
+enum class DiffMatchImpl
+{
+    Scalar,
+    SSE4,
+    AVX2
+};
+
+/** Maximum number of shift values tried by one kernel call */
+constexpr int MaxDiffMatchShifts = 8;
+
+/**
+ * Whether the host can run the given kernel implementation.
+ */
+bool diffMatchImplSupported(DiffMatchImpl impl);
+
+/** Fastest implementation supported by the host */
+DiffMatchImpl diffMatchBestImpl();
+
+/**
+ * Match a target-address diff sequence against every window of an
+ * index-data diff sequence, for every shift value at once.
+ *
+ * Both sequences are linearized, oldest difference first. For every
+ * start offset i in [0, idx_len - tgt_len], bit s of match_mask[i] is
+ * set iff idx[i + t] == (tgt[t] >> shifts[s]) for all t < tgt_len.
+ *
+ * @param idx index-data diff sequence
+ * @param idx_len length of idx
+ * @param tgt target-address diff sequence
+ * @param tgt_len length of tgt, must not exceed idx_len
+ * @param shifts shift values to try
+ * @param num_shifts number of shift values, at most MaxDiffMatchShifts
+ * @param match_mask output, idx_len - tgt_len + 1 entries
+ */
+void diffSeqMatch(const int64_t *idx, int idx_len,
+                  const int64_t *tgt, int tgt_len,
+                  const unsigned *shifts, int num_shifts,
+                  uint8_t *match_mask);
+
+/** Same as above, forcing a given (supported) implementation */
+void diffSeqMatch(DiffMatchImpl impl,
+                  const int64_t *idx, int idx_len,
+                  const int64_t *tgt, int tgt_len,
+                  const unsigned *shifts, int num_shifts,
+                  uint8_t *match_mask);
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_DIFF_MATCHING_KERNEL_HH__
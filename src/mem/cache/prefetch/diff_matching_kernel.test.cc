@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "mem/cache/prefetch/diff_matching_kernel.hh"
+
+using namespace gem5;
+using namespace gem5::prefetch;
+
+namespace
+{
+
+const unsigned shift_v[4] = {0, 1, 2, 3};
+
+/** Reference: the original scalar triple loop of DiffMatching */
+std::vector<uint8_t>
+referenceMatch(const std::vector<int64_t> &idx,
+               const std::vector<int64_t> &tgt)
+{
+    const int tgt_len = tgt.size();
+    const int num_starts = idx.size() - tgt_len + 1;
+    std::vector<uint8_t> mask(num_starts, 0);
+    for (int i_start = 0; i_start < num_starts; i_start++) {
+        for (int s = 0; s < 4; s++) {
+            int t = 0;
+            while (t < tgt_len) {
+                if (idx[i_start + t] != (tgt[t] >> shift_v[s])) break;
+                t++;
+            }
+            if (t == tgt_len) mask[i_start] |= (1 << s);
+        }
+    }
+    return mask;
+}
+
+std::vector<uint8_t>
+kernelMatch(DiffMatchImpl impl, const std::vector<int64_t> &idx,
+            const std::vector<int64_t> &tgt)
+{
+    std::vector<uint8_t> mask(idx.size() - tgt.size() + 1, 0xff);
+    diffSeqMatch(impl, idx.data(), idx.size(), tgt.data(), tgt.size(),
+                 shift_v, 4, mask.data());
+    return mask;
+}
+
+const DiffMatchImpl all_impls[] = {
+    DiffMatchImpl::Scalar, DiffMatchImpl::SSE4, DiffMatchImpl::AVX2
+};
+
+} // anonymous namespace
+
+/** A planted window is found at the right offset and shift only */
+TEST(DiffMatchingKernelTest, PlantedMatch)
+{
+    std::vector<int64_t> tgt = {16, 32, -8, 64, 4096, 8, 16, 24, -32, 40};
+    std::vector<int64_t> idx(12, 7);
+    for (size_t t = 0; t < tgt.size(); t++) {
+        idx[1 + t] = tgt[t] >> 2;
+    }
+
+    for (auto impl : all_impls) {
+        if (!diffMatchImplSupported(impl)) continue;
+        auto mask = kernelMatch(impl, idx, tgt);
+        ASSERT_EQ(mask.size(), 3u);
+        EXPECT_EQ(mask[0], 0);
+        EXPECT_EQ(mask[1], 1 << 2);
+        EXPECT_EQ(mask[2], 0);
+    }
+}
+
+/** Zero diffs match every shift at every offset */
+TEST(DiffMatchingKernelTest, AllShiftsMatch)
+{
+    std::vector<int64_t> tgt(10, 0);
+    std::vector<int64_t> idx(16, 0);
+
+    for (auto impl : all_impls) {
+        if (!diffMatchImplSupported(impl)) continue;
+        auto mask = kernelMatch(impl, idx, tgt);
+        ASSERT_EQ(mask.size(), 7u);
+        for (auto m : mask) {
+            EXPECT_EQ(m, 0xf);
+        }
+    }
+}
+
+/**
+ * Every vector implementation finds exactly the matches of the scalar
+ * loop, for many lengths and for sequences with partial and full matches.
+ */
+TEST(DiffMatchingKernelTest, SameAsScalar)
+{
+    std::mt19937_64 rng(0x5eed);
+
+    for (int iter = 0; iter < 20000; iter++) {
+        const int tgt_len = 1 + rng() % 12;
+        const int idx_len = tgt_len + rng() % 20;
+
+        // small value range so that partial and full matches occur
+        std::vector<int64_t> tgt(tgt_len);
+        for (auto &v : tgt) {
+            v = static_cast<int64_t>(rng() % 5) - 2;
+            v <<= rng() % 4;
+        }
+        std::vector<int64_t> idx(idx_len);
+        for (auto &v : idx) {
+            v = static_cast<int64_t>(rng() % 5) - 2;
+        }
+        // sometimes plant the target with a random shift
+        if (rng() % 2) {
+            const int at = rng() % (idx_len - tgt_len + 1);
+            const unsigned s = rng() % 4;
+            for (int t = 0; t < tgt_len; t++) {
+                idx[at + t] = tgt[t] >> s;
+            }
+        }
+
+        const auto expected = referenceMatch(idx, tgt);
+        for (auto impl : all_impls) {
+            if (!diffMatchImplSupported(impl)) continue;
+            ASSERT_EQ(kernelMatch(impl, idx, tgt), expected)
+                << "impl " << static_cast<int>(impl) << " iter " << iter;
+        }
+    }
+}
+
+/** The default entry point uses a supported implementation */
+TEST(DiffMatchingKernelTest, BestImplSupported)
+{
+    EXPECT_TRUE(diffMatchImplSupported(diffMatchBestImpl()));
+    EXPECT_TRUE(diffMatchImplSupported(DiffMatchImpl::Scalar));
+}
@@ -0,0 +1,70 @@
+#include "mem/cache/prefetch/dmp_hints.hh"
+
+#include <istream>
+#include <ostream>
+#include <set>
+#include <sstream>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/str.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+void
+DMPHints::addRelation(Addr index_pc, Addr target_pc, bool range)
+{
+    indexPCs.push_back(index_pc);
+    targetPCs.push_back(target_pc);
+    // range detection samples the runs of the index PC
+    if (range) {
+        rangePCs.push_back(index_pc);
+    }
+}
+
+void
+DMPHints::read(std::istream &is, const std::string &path)
+{
+    std::string line;
+    for (int line_num = 1; std::getline(is, line); line_num++) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string kind;
+        std::string pc_str;
+        if (!(fields >> kind)) continue;
+
+        Addr pc;
+        fatal_if(!(fields >> pc_str) || !to_number(pc_str, pc),
+                 "%s:%d: expected a PC after '%s'\n", path, line_num, kind);
+        if (kind == "index") {
+            indexPCs.push_back(pc);
+        } else if (kind == "target") {
+            targetPCs.push_back(pc);
+        } else if (kind == "range") {
+            rangePCs.push_back(pc);
+        } else {
+            fatal("%s:%d: unknown hint '%s'\n", path, line_num, kind);
+        }
+    }
+}
+
+void
+DMPHints::write(std::ostream &os) const
+{
+    for (Addr pc : std::set<Addr>(indexPCs.begin(), indexPCs.end())) {
+        ccprintf(os, "index %#x\n", pc);
+    }
+    for (Addr pc : std::set<Addr>(targetPCs.begin(), targetPCs.end())) {
+        ccprintf(os, "target %#x\n", pc);
+    }
+    for (Addr pc : std::set<Addr>(rangePCs.begin(), rangePCs.end())) {
+        ccprintf(os, "range %#x\n", pc);
+    }
+}
+
+} // namespace prefetch
+} // namespace gem5
@@ -0,0 +1,47 @@
+/**
+ * PC hints of the Difference-based prefetcher, the format of its
+ * hint_file and of the hints it records
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_DMP_HINTS_HH__
+#define __MEM_CACHE_PREFETCH_DMP_HINTS_HH__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/**
+ * PCs DMP trains on from the start. Each line of a hint file is
+ * "index|target|range <pc>", '#' starts a comment.
+ */
+struct DMPHints
+{
+    std::vector<Addr> indexPCs;
+    std::vector<Addr> targetPCs;
+    /** Index PCs of range relations, whose run lengths are sampled */
+    std::vector<Addr> rangePCs;
+
+    /** Add the PCs training a relation again */
+    void addRelation(Addr index_pc, Addr target_pc, bool range);
+
+    /** Add the PCs of a hint file, path names it in errors */
+    void read(std::istream &is, const std::string &path);
+
+    /** Write the PCs of each kind sorted and without duplicates */
+    void write(std::ostream &os) const;
+};
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_DMP_HINTS_HH__
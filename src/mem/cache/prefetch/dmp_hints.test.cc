@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <vector>
+
+#include "mem/cache/prefetch/dmp_hints.hh"
+
+using namespace gem5;
+using namespace gem5::prefetch;
+
+namespace
+{
+
+/** configs/dmp_pf/hints/spmv.hint */
+const char *spmvHint =
+    "# DiffMatchingPrefetcher hints of spmv_csr, see README\n"
+    "index 0x400598\n"
+    "index 0x4005b0\n"
+    "target 0x4005b0\n"
+    "target 0x4005bc\n"
+    "range 0x4005b0\n";
+
+DMPHints
+readString(const std::string &text)
+{
+    DMPHints hints;
+    std::istringstream is(text);
+    hints.read(is, "test.hint");
+    return hints;
+}
+
+} // anonymous namespace
+
+TEST(DMPHintsTest, Read)
+{
+    DMPHints hints = readString(spmvHint);
+
+    EXPECT_EQ(hints.indexPCs, std::vector<Addr>({0x400598, 0x4005b0}));
+    EXPECT_EQ(hints.targetPCs, std::vector<Addr>({0x4005b0, 0x4005bc}));
+    EXPECT_EQ(hints.rangePCs, std::vector<Addr>({0x4005b0}));
+}
+
+/** Recording the spmv relations gives back the shipped hints */
+TEST(DMPHintsTest, RecordSpmv)
+{
+    DMPHints recorded;
+    recorded.addRelation(0x400598, 0x4005b0, false);
+    recorded.addRelation(0x4005b0, 0x4005bc, true);
+
+    std::ostringstream os;
+    recorded.write(os);
+    DMPHints read_back = readString(os.str());
+    DMPHints shipped = readString(spmvHint);
+
+    EXPECT_EQ(read_back.indexPCs, shipped.indexPCs);
+    EXPECT_EQ(read_back.targetPCs, shipped.targetPCs);
+    EXPECT_EQ(read_back.rangePCs, shipped.rangePCs);
+}
+
+/** Relations sharing PCs write each PC once */
+TEST(DMPHintsTest, WriteUnique)
+{
+    DMPHints hints;
+    hints.addRelation(0x20, 0x30, true);
+    hints.addRelation(0x10, 0x30, true);
+    hints.addRelation(0x20, 0x40, false);
+
+    std::ostringstream os;
+    hints.write(os);
+    EXPECT_EQ(os.str(), "index 0x10\nindex 0x20\n"
+                        "target 0x30\ntarget 0x40\n"
+                        "range 0x10\nrange 0x20\n");
+}
@@ -28,6 +28,7 @@
 
  #include "mem/cache/prefetch/indirect_memory.hh"
 
+ #include "base/cprintf.hh"
  #include "mem/cache/base.hh"
  #include "mem/cache/prefetch/associative_set_impl.hh"
  #include "params/IndirectMemoryPrefetcher.hh"
@@ -245,6 +246,150 @@ IndirectMemory::trackMissIndex2(Addr miss_addr)
     }
 }
 
+void
+IndirectMemory::serialize(CheckpointOut &cp) const
+{
+    Queued::serialize(cp);
+
+    {
+        std::vector<const PrefetchTableEntry *> pt_entries;
+        for (const auto &pt_entry : prefetchTable) {
+            if (pt_entry.isValid()) pt_entries.push_back(&pt_entry);
+        }
+
+        ScopedCheckpointSection sec(cp, "prefetchTable");
+        paramOut(cp, "numEntries", (int)pt_entries.size());
+        for (int i = 0; i < pt_entries.size(); i++) {
+            const PrefetchTableEntry *pt_entry = pt_entries[i];
+            ScopedCheckpointSection entry_sec(cp, csprintf("Entry%d", i));
+            paramOut(cp, "pc", prefetchTable.regenerateAddr(pt_entry));
+            paramOut(cp, "address", pt_entry->address);
+            paramOut(cp, "secure", pt_entry->secure);
+            paramOut(cp, "streamCounter", pt_entry->streamCounter);
+            paramOut(cp, "enabled", pt_entry->enabled);
+            paramOut(cp, "index", pt_entry->index);
+            paramOut(cp, "baseAddr", pt_entry->baseAddr);
+            paramOut(cp, "shift", pt_entry->shift);
+            paramOut(cp, "indirectCounter", (int)pt_entry->indirectCounter);
+            paramOut(cp, "increasedIndirectCounter",
+                     pt_entry->increasedIndirectCounter);
+        }
+    }
+
+    {
+        std::vector<const IndirectPatternDetectorEntry *> ipd_entries;
+        for (const auto &ipd_entry : ipd) {
+            if (ipd_entry.isValid()) ipd_entries.push_back(&ipd_entry);
+        }
+
+        ScopedCheckpointSection sec(cp, "ipd");
+        paramOut(cp, "numEntries", (int)ipd_entries.size());
+        for (int i = 0; i < ipd_entries.size(); i++) {
+            const IndirectPatternDetectorEntry *ipd_entry = ipd_entries[i];
+            auto *pt_entry = (const PrefetchTableEntry *)
+                ipd.regenerateAddr(ipd_entry);
+            ScopedCheckpointSection entry_sec(cp, csprintf("Entry%d", i));
+            paramOut(cp, "ptPC", prefetchTable.regenerateAddr(pt_entry));
+            paramOut(cp, "idx1", ipd_entry->idx1);
+            paramOut(cp, "idx2", ipd_entry->idx2);
+            paramOut(cp, "secondIndexSet", ipd_entry->secondIndexSet);
+            paramOut(cp, "numMisses", ipd_entry->numMisses);
+            paramOut(cp, "trackingMisses",
+                     ipd_entry == ipdEntryTrackingMisses);
+            for (int m = 0; m < ipd_entry->numMisses; m++) {
+                arrayParamOut(cp, csprintf("baseAddr%d", m),
+                              ipd_entry->baseAddr[m]);
+            }
+        }
+    }
+}
+
+void
+IndirectMemory::unserialize(CheckpointIn &cp)
+{
+    Queued::unserialize(cp);
+
+    // checkpoints taken before prefetchers were serialized
+    if (!cp.sectionExists(Serializable::currentSection() +
+                          ".prefetchTable")) {
+        return;
+    }
+
+    {
+        ScopedCheckpointSection sec(cp, "prefetchTable");
+        int num_entries;
+        paramIn(cp, "numEntries", num_entries);
+        for (int i = 0; i < num_entries; i++) {
+            ScopedCheckpointSection entry_sec(cp, csprintf("Entry%d", i));
+            Addr pc;
+            paramIn(cp, "pc", pc);
+            PrefetchTableEntry *pt_entry = prefetchTable.findEntry(pc, false);
+            if (!pt_entry) {
+                pt_entry = prefetchTable.findVictim(pc);
+                prefetchTable.insertEntry(pc, false, pt_entry);
+            }
+            int indirect_counter;
+            paramIn(cp, "address", pt_entry->address);
+            paramIn(cp, "secure", pt_entry->secure);
+            paramIn(cp, "streamCounter", pt_entry->streamCounter);
+            paramIn(cp, "enabled", pt_entry->enabled);
+            paramIn(cp, "index", pt_entry->index);
+            paramIn(cp, "baseAddr", pt_entry->baseAddr);
+            paramIn(cp, "shift", pt_entry->shift);
+            paramIn(cp, "indirectCounter", indirect_counter);
+            paramIn(cp, "increasedIndirectCounter",
+                    pt_entry->increasedIndirectCounter);
+            // SatCounter8 has no setter, clear it and add the value
+            pt_entry->indirectCounter -= pt_entry->indirectCounter;
+            pt_entry->indirectCounter += indirect_counter;
+        }
+    }
+
+    ipdEntryTrackingMisses = nullptr;
+    {
+        ScopedCheckpointSection sec(cp, "ipd");
+        int num_entries;
+        paramIn(cp, "numEntries", num_entries);
+        for (int i = 0; i < num_entries; i++) {
+            ScopedCheckpointSection entry_sec(cp, csprintf("Entry%d", i));
+            Addr pt_pc;
+            int num_misses;
+            paramIn(cp, "ptPC", pt_pc);
+            paramIn(cp, "numMisses", num_misses);
+            PrefetchTableEntry *pt_entry =
+                prefetchTable.findEntry(pt_pc, false);
+
+            std::vector<std::vector<Addr>> base_addr(num_misses);
+            bool fits = pt_entry != nullptr &&
+                num_misses <= (int)ipd.begin()->baseAddr.size();
+            for (int m = 0; m < num_misses; m++) {
+                arrayParamIn(cp, csprintf("baseAddr%d", m), base_addr[m]);
+                fits = fits && base_addr[m].size() == shiftValues.size();
+            }
+            // entries of a PT entry which was not restored, or recorded
+            // with other shift values, restart the detection
+            if (!fits) continue;
+
+            Addr ipd_entry_addr = (Addr)pt_entry;
+            IndirectPatternDetectorEntry *ipd_entry =
+                ipd.findVictim(ipd_entry_addr);
+            ipd.insertEntry(ipd_entry_addr, false, ipd_entry);
+            paramIn(cp, "idx1", ipd_entry->idx1);
+            paramIn(cp, "idx2", ipd_entry->idx2);
+            paramIn(cp, "secondIndexSet", ipd_entry->secondIndexSet);
+            ipd_entry->numMisses = num_misses;
+            for (int m = 0; m < num_misses; m++) {
+                ipd_entry->baseAddr[m] = base_addr[m];
+            }
+            bool tracking;
+            paramIn(cp, "trackingMisses", tracking);
+            if (tracking) {
+                ipdEntryTrackingMisses = ipd_entry;
+            }
+        }
+    }
+}
+
 void
 IndirectMemory::checkAccessMatchOnActiveEntries(Addr addr)
 {
@@ -203,6 +203,14 @@ class IndirectMemory : public Queued
 
     void calculatePrefetch(const PrefetchInfo &pfi,
                            std::vector<AddrPriority> &addresses) override;
+
+    /**
+     * Entries are checkpointed by PC and reinserted on restore. IPD
+     * entries, tagged by the address of their PT entry, are
+     * checkpointed with the PC of that entry.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 } // namespace prefetch
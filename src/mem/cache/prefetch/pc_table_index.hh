@@ -0,0 +1,187 @@
+/**
+ * Open-addressing PC index for FIFO-replaced prefetcher tables
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_PC_TABLE_INDEX_HH__
+#define __MEM_CACHE_PREFETCH_PC_TABLE_INDEX_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/**
+ * Maps a PC to the slots of a table which currently hold that PC.
+ *
+ * The indexed table keeps its own allocation and replacement policy
+ * (e.g. the FIFO pointers of DMP tables). The index only has to be told
+ * which PC a slot was (re)assigned to, and turns "scan every slot for
+ * this PC" into a single probe sequence. Several slots may share a PC
+ * (e.g. same PC from different ContextIDs), so other tags such as the
+ * ContextID are still checked by the caller on the table entry.
+ *
+ * Linear probing is used with at most 50% load, and deletion shifts
+ * buckets backwards so no tombstones are needed.
+ */
+class PCTableIndex
+{
+    struct Bucket
+    {
+        Addr pc;
+        int slot;   // -1 if the bucket is empty
+    };
+
+    std::vector<Bucket> buckets;
+    const size_t mask;
+
+    /** PC currently assigned to each table slot */
+    std::vector<Addr> slotPC;
+    std::vector<bool> slotUsed;
+
+    /**
+     * Matching slots of in-flight lookups. Used as a stack so that a
+     * forEach() callback may itself do lookups in the same index.
+     */
+    mutable std::vector<int> scratch;
+
+    size_t
+    home(Addr pc) const
+    {
+        uint64_t h = pc ^ (pc >> 21);
+        h *= 0x9e3779b97f4a7c15ULL;
+        return (h >> 32) & mask;
+    }
+
+    void
+    insertBucket(Addr pc, int slot)
+    {
+        size_t pos = home(pc);
+        while (buckets[pos].slot != -1) {
+            pos = (pos + 1) & mask;
+        }
+        buckets[pos] = {pc, slot};
+    }
+
+    void
+    eraseBucket(Addr pc, int slot)
+    {
+        size_t pos = home(pc);
+        while (buckets[pos].slot != slot || buckets[pos].pc != pc) {
+            assert(buckets[pos].slot != -1);
+            pos = (pos + 1) & mask;
+        }
+
+        // backward-shift the following cluster into the hole
+        size_t hole = pos;
+        size_t next = (pos + 1) & mask;
+        while (buckets[next].slot != -1) {
+            size_t ideal = home(buckets[next].pc);
+            // move if the hole lies cyclically in [ideal, next)
+            if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+                buckets[hole] = buckets[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        buckets[hole].slot = -1;
+    }
+
+  public:
+    /**
+     * @param num_slots number of entries of the indexed table
+     */
+    explicit PCTableIndex(unsigned num_slots)
+      : buckets(size_t(1) << std::max(3, ceilLog2(2 * (size_t)num_slots)),
+                Bucket{0, -1}),
+        mask(buckets.size() - 1),
+        slotPC(num_slots, 0), slotUsed(num_slots, false)
+    {
+    }
+
+    /** Record that table slot now holds pc */
+    void
+    assign(int slot, Addr pc)
+    {
+        assert(slot >= 0 && slot < slotPC.size());
+        if (slotUsed[slot]) {
+            if (slotPC[slot] == pc) return;
+            eraseBucket(slotPC[slot], slot);
+        }
+        insertBucket(pc, slot);
+        slotPC[slot] = pc;
+        slotUsed[slot] = true;
+    }
+
+    /** Whether table slot holds a pc, and which one */
+    bool assigned(int slot) const { return slotUsed[slot]; }
+    Addr pcOf(int slot) const { return slotPC[slot]; }
+
+    /** Record that table slot no longer holds any pc */
+    void
+    release(int slot)
+    {
+        assert(slot >= 0 && slot < slotPC.size());
+        if (!slotUsed[slot]) return;
+        eraseBucket(slotPC[slot], slot);
+        slotUsed[slot] = false;
+    }
+
+    /**
+     * Call fn(slot) for every slot assigned to pc, in ascending slot
+     * order so iteration matches a linear scan of the table.
+     */
+    template <typename Fn>
+    void
+    forEach(Addr pc, Fn &&fn) const
+    {
+        const size_t base = scratch.size();
+        for (size_t pos = home(pc); buckets[pos].slot != -1;
+             pos = (pos + 1) & mask) {
+            if (buckets[pos].pc == pc) {
+                scratch.push_back(buckets[pos].slot);
+            }
+        }
+        const size_t end = scratch.size();
+        std::sort(scratch.begin() + base, scratch.begin() + end);
+
+        for (size_t i = base; i < end; i++) {
+            fn(scratch[i]);
+        }
+        scratch.resize(base);
+    }
+
+    /**
+     * Return the first slot (in ascending order) assigned to pc for
+     * which pred(slot) holds, or -1.
+     */
+    template <typename Pred>
+    int
+    findIf(Addr pc, Pred &&pred) const
+    {
+        int found = -1;
+        for (size_t pos = home(pc); buckets[pos].slot != -1;
+             pos = (pos + 1) & mask) {
+            const Bucket &b = buckets[pos];
+            if (b.pc == pc && (found == -1 || b.slot < found) &&
+                pred(b.slot)) {
+                found = b.slot;
+            }
+        }
+        return found;
+    }
+};
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_PC_TABLE_INDEX_HH__
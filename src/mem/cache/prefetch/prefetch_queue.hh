@@ -0,0 +1,345 @@
+/**
+ * Pooled priority queue with an address index for queued prefetchers
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_PREFETCH_QUEUE_HH__
+#define __MEM_CACHE_PREFETCH_PREFETCH_QUEUE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/logging.hh"
+#include "base/types.hh"
+#include "mem/cache/prefetch/pc_table_index.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/**
+ * Bounded queue of prefetch requests ordered by priority, then by age.
+ *
+ * Entries live in a fixed pool of slots, so their addresses stay valid
+ * until they are erased (needed for in-flight translations), and no
+ * allocation happens after construction. Two indexed binary heaps over
+ * the slots give the issue order (highest priority, oldest first) and
+ * the replacement order (lowest priority, oldest first), and a hash on
+ * the block address replaces the linear duplicate search.
+ *
+ * The order is the one of the sorted list it replaces: an entry goes
+ * behind every entry of the same or higher priority, and changing the
+ * priority of an entry makes it the youngest of its new level.
+ */
+template <typename T>
+class PrefetchQueue
+{
+    enum { IssueHeap = 0, ReplHeap = 1 };
+
+    struct Meta
+    {
+        int32_t priority;
+        /** insertion order, also tells reused slots apart */
+        uint64_t seq;
+        bool secure;
+        /** position of the slot in each heap */
+        int pos[2];
+    };
+
+    const unsigned cap;
+
+    std::vector<std::optional<T>> entries;
+    std::vector<Meta> meta;
+    std::vector<int> freeSlots;
+    std::vector<int> heaps[2];
+
+    PCTableIndex addrIndex;
+
+    uint64_t nextSeq;
+
+    /** best-first frontier used when walking the issue order */
+    std::vector<int> frontier;
+    /**
+     * Slots (and their seq) visited by in-flight walks. Used as a stack
+     * so a callback may walk another queue or this one again.
+     */
+    std::vector<std::pair<int, uint64_t>> visit;
+
+    /** Whether slot a goes before slot b in the given heap */
+    bool
+    before(int h, int a, int b) const
+    {
+        const Meta &ma = meta[a];
+        const Meta &mb = meta[b];
+        if (ma.priority != mb.priority) {
+            return h == IssueHeap ? ma.priority > mb.priority :
+                                    ma.priority < mb.priority;
+        }
+        return ma.seq < mb.seq;
+    }
+
+    void
+    place(int h, int pos, int slot)
+    {
+        heaps[h][pos] = slot;
+        meta[slot].pos[h] = pos;
+    }
+
+    void
+    siftUp(int h, int pos)
+    {
+        std::vector<int> &heap = heaps[h];
+        const int slot = heap[pos];
+        while (pos > 0) {
+            const int parent = (pos - 1) / 2;
+            if (!before(h, slot, heap[parent])) break;
+            place(h, pos, heap[parent]);
+            pos = parent;
+        }
+        place(h, pos, slot);
+    }
+
+    void
+    siftDown(int h, int pos)
+    {
+        std::vector<int> &heap = heaps[h];
+        const int n = heap.size();
+        const int slot = heap[pos];
+        while (true) {
+            int child = 2 * pos + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(h, heap[child + 1], heap[child])) {
+                child++;
+            }
+            if (!before(h, heap[child], slot)) break;
+            place(h, pos, heap[child]);
+            pos = child;
+        }
+        place(h, pos, slot);
+    }
+
+    void
+    heapInsert(int h, int slot)
+    {
+        heaps[h].push_back(slot);
+        siftUp(h, heaps[h].size() - 1);
+    }
+
+    void
+    heapRemove(int h, int slot)
+    {
+        std::vector<int> &heap = heaps[h];
+        const int pos = meta[slot].pos[h];
+        const int last = heap.back();
+        heap.pop_back();
+        if (last == slot) return;
+        place(h, pos, last);
+        siftUp(h, pos);
+        siftDown(h, meta[last].pos[h]);
+    }
+
+    void
+    heapUpdate(int h, int slot)
+    {
+        const int pos = meta[slot].pos[h];
+        siftUp(h, pos);
+        siftDown(h, meta[slot].pos[h]);
+    }
+
+  public:
+    /**
+     * @param capacity maximum number of queued entries
+     */
+    explicit PrefetchQueue(unsigned capacity)
+      : cap(capacity), entries(capacity), meta(capacity),
+        addrIndex(capacity), nextSeq(0)
+    {
+        fatal_if(capacity == 0, "Prefetch queue needs at least one entry");
+        freeSlots.reserve(capacity);
+        for (int slot = capacity - 1; slot >= 0; slot--) {
+            freeSlots.push_back(slot);
+        }
+        heaps[IssueHeap].reserve(capacity);
+        heaps[ReplHeap].reserve(capacity);
+        frontier.reserve(capacity);
+        visit.reserve(capacity);
+    }
+
+    PrefetchQueue(const PrefetchQueue &) = delete;
+    PrefetchQueue &operator=(const PrefetchQueue &) = delete;
+
+    size_t size() const { return heaps[IssueHeap].size(); }
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == cap; }
+    unsigned capacity() const { return cap; }
+
+    T &operator[](int slot) { assert(entries[slot]); return *entries[slot]; }
+    const T &
+    operator[](int slot) const
+    {
+        assert(entries[slot]);
+        return *entries[slot];
+    }
+
+    int32_t priority(int slot) const { return meta[slot].priority; }
+
+    /** Slot of the entry to issue next */
+    int top() const { assert(!empty()); return heaps[IssueHeap][0]; }
+
+    /** Slot of the lowest priority, oldest entry */
+    int
+    replacementCandidate() const
+    {
+        assert(!empty());
+        return heaps[ReplHeap][0];
+    }
+
+    /**
+     * Queue a copy of an entry. The queue must not be full.
+     * @param entry entry to copy into the pool
+     * @param addr (block) address used for lookups
+     * @param secure secure space of the address
+     * @param prio priority of the entry
+     * @return the slot holding the entry
+     */
+    int
+    push(const T &entry, Addr addr, bool secure, int32_t prio)
+    {
+        assert(!full());
+        const int slot = freeSlots.back();
+        freeSlots.pop_back();
+
+        entries[slot].emplace(entry);
+        meta[slot].priority = prio;
+        meta[slot].seq = nextSeq++;
+        meta[slot].secure = secure;
+        heapInsert(IssueHeap, slot);
+        heapInsert(ReplHeap, slot);
+        addrIndex.assign(slot, addr);
+        return slot;
+    }
+
+    /** Remove the entry of a slot, which becomes free for reuse */
+    void
+    erase(int slot)
+    {
+        assert(entries[slot]);
+        heapRemove(IssueHeap, slot);
+        heapRemove(ReplHeap, slot);
+        addrIndex.release(slot);
+        entries[slot].reset();
+        freeSlots.push_back(slot);
+    }
+
+    /** Change the priority of an entry, making it the youngest at it */
+    void
+    updatePriority(int slot, int32_t prio)
+    {
+        assert(entries[slot]);
+        meta[slot].priority = prio;
+        meta[slot].seq = nextSeq++;
+        heapUpdate(IssueHeap, slot);
+        heapUpdate(ReplHeap, slot);
+    }
+
+    /** Slot of an entry for this address, or -1 */
+    int
+    find(Addr addr, bool secure) const
+    {
+        return addrIndex.findIf(addr, [&](int slot) {
+            return meta[slot].secure == secure;
+        });
+    }
+
+    /**
+     * Call fn(slot) for every entry of this address. fn may erase the
+     * entry it is given.
+     */
+    template <typename Fn>
+    void
+    forEachAddr(Addr addr, bool secure, Fn &&fn)
+    {
+        addrIndex.forEach(addr, [&](int slot) {
+            if (entries[slot] && meta[slot].secure == secure) {
+                fn(slot);
+            }
+        });
+    }
+
+    /** Call fn(slot) for every entry, in no particular order */
+    template <typename Fn>
+    void
+    forEach(Fn &&fn) const
+    {
+        for (int slot : heaps[IssueHeap]) {
+            fn(slot);
+        }
+    }
+
+    /** Slots of all the entries in issue order, e.g. to checkpoint them */
+    std::vector<int>
+    slotsInOrder() const
+    {
+        std::vector<int> slots(heaps[IssueHeap]);
+        std::sort(slots.begin(), slots.end(), [this](int a, int b) {
+            return before(IssueHeap, a, b);
+        });
+        return slots;
+    }
+
+    /**
+     * Call fn(slot) for the first max entries in issue order. fn may
+     * erase the entry it is given, or push to and erase from this
+     * queue; entries removed before their turn are skipped.
+     */
+    template <typename Fn>
+    void
+    forEachInOrder(size_t max, Fn &&fn)
+    {
+        const std::vector<int> &heap = heaps[IssueHeap];
+        max = std::min(max, heap.size());
+        if (max == 0) return;
+
+        // best-first walk of the heap: the next entry in order is always
+        // a child of one already taken
+        auto later = [&](int a, int b) {
+            return before(IssueHeap, heap[b], heap[a]);
+        };
+        const size_t base = visit.size();
+        frontier.clear();
+        frontier.push_back(0);
+        while (visit.size() - base < max) {
+            std::pop_heap(frontier.begin(), frontier.end(), later);
+            const int pos = frontier.back();
+            frontier.pop_back();
+            visit.emplace_back(heap[pos], meta[heap[pos]].seq);
+            for (int child = 2 * pos + 1; child <= 2 * pos + 2; child++) {
+                if (child < (int)heap.size()) {
+                    frontier.push_back(child);
+                    std::push_heap(frontier.begin(), frontier.end(), later);
+                }
+            }
+        }
+
+        const size_t end = visit.size();
+        for (size_t i = base; i < end; i++) {
+            const int slot = visit[i].first;
+            if (entries[slot] && meta[slot].seq == visit[i].second) {
+                fn(slot);
+            }
+        }
+        visit.resize(base);
+    }
+};
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_PREFETCH_QUEUE_HH__
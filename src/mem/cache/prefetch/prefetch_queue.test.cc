@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <list>
+#include <random>
+#include <vector>
+
+#include "mem/cache/prefetch/prefetch_queue.hh"
+
+using namespace gem5;
+using namespace gem5::prefetch;
+
+namespace
+{
+
+struct Entry
+{
+    Addr addr;
+    int32_t prio;
+};
+
+std::vector<Addr>
+issueOrder(PrefetchQueue<Entry> &queue, size_t max)
+{
+    std::vector<Addr> order;
+    queue.forEachInOrder(max, [&](int slot) {
+        order.push_back(queue[slot].addr);
+    });
+    return order;
+}
+
+} // anonymous namespace
+
+/** Higher priority first, FIFO within a priority */
+TEST(PrefetchQueueTest, Order)
+{
+    PrefetchQueue<Entry> queue(8);
+
+    queue.push({0x100, 1}, 0x100, false, 1);
+    queue.push({0x200, 3}, 0x200, false, 3);
+    queue.push({0x300, 1}, 0x300, false, 1);
+    queue.push({0x400, 3}, 0x400, false, 3);
+
+    EXPECT_EQ(queue.size(), 4u);
+    EXPECT_EQ(issueOrder(queue, 8),
+              std::vector<Addr>({0x200, 0x400, 0x100, 0x300}));
+    EXPECT_EQ(issueOrder(queue, 2), std::vector<Addr>({0x200, 0x400}));
+
+    std::vector<Addr> all;
+    for (int slot : queue.slotsInOrder()) all.push_back(queue[slot].addr);
+    EXPECT_EQ(all, issueOrder(queue, 8));
+    EXPECT_EQ(queue[queue.top()].addr, 0x200);
+    EXPECT_EQ(queue[queue.replacementCandidate()].addr, 0x100);
+}
+
+/** A raised entry becomes the youngest of its new priority */
+TEST(PrefetchQueueTest, UpdatePriority)
+{
+    PrefetchQueue<Entry> queue(8);
+
+    queue.push({0x100, 2}, 0x100, false, 2);
+    int slot = queue.push({0x200, 1}, 0x200, false, 1);
+    queue.push({0x300, 1}, 0x300, false, 1);
+
+    queue.updatePriority(slot, 2);
+    EXPECT_EQ(issueOrder(queue, 8),
+              std::vector<Addr>({0x100, 0x200, 0x300}));
+    EXPECT_EQ(queue[queue.replacementCandidate()].addr, 0x300);
+}
+
+/** Lookups by address honour the secure flag and follow erasure */
+TEST(PrefetchQueueTest, Find)
+{
+    PrefetchQueue<Entry> queue(4);
+
+    int a = queue.push({0x100, 0}, 0x100, false, 0);
+    int b = queue.push({0x100, 0}, 0x100, true, 0);
+
+    EXPECT_EQ(queue.find(0x100, false), a);
+    EXPECT_EQ(queue.find(0x100, true), b);
+    EXPECT_EQ(queue.find(0x200, false), -1);
+
+    queue.erase(a);
+    EXPECT_EQ(queue.find(0x100, false), -1);
+    EXPECT_EQ(queue.find(0x100, true), b);
+
+    int squashed = 0;
+    queue.forEachAddr(0x100, true, [&](int slot) {
+        queue.erase(slot);
+        squashed++;
+    });
+    EXPECT_EQ(squashed, 1);
+    EXPECT_TRUE(queue.empty());
+}
+
+/** Entries erased during a walk before their turn are skipped */
+TEST(PrefetchQueueTest, EraseDuringWalk)
+{
+    PrefetchQueue<Entry> queue(4);
+
+    queue.push({0x100, 2}, 0x100, false, 2);
+    int victim = queue.push({0x200, 1}, 0x200, false, 1);
+    queue.push({0x300, 0}, 0x300, false, 0);
+
+    std::vector<Addr> seen;
+    queue.forEachInOrder(3, [&](int slot) {
+        seen.push_back(queue[slot].addr);
+        if (queue[slot].addr == 0x100) {
+            queue.erase(victim);
+        }
+        queue.erase(slot);
+    });
+    EXPECT_EQ(seen, std::vector<Addr>({0x100, 0x300}));
+    EXPECT_TRUE(queue.empty());
+}
+
+/**
+ * Random operations give the same order as the sorted list the queue
+ * replaces.
+ */
+TEST(PrefetchQueueTest, SameAsSortedList)
+{
+    const unsigned capacity = 16;
+    PrefetchQueue<Entry> queue(capacity);
+    std::list<Entry> ref;
+    std::mt19937_64 rng(0x5eed);
+
+    auto ref_insert = [&](Entry e) {
+        auto it = ref.begin();
+        while (it != ref.end() && it->prio >= e.prio) it++;
+        ref.insert(it, e);
+    };
+
+    for (int iter = 0; iter < 20000; iter++) {
+        const Addr addr = 0x40 * (rng() % 48);
+        const int32_t prio = rng() % 4;
+        const int op = rng() % 4;
+
+        if (op == 0 && !ref.empty()) {
+            // issue
+            ASSERT_EQ(queue[queue.top()].addr, ref.front().addr);
+            queue.erase(queue.top());
+            ref.pop_front();
+        } else if (op == 1) {
+            // raise the priority of a queued address
+            int slot = queue.find(addr, false);
+            auto it = ref.begin();
+            while (it != ref.end() && it->addr != addr) it++;
+            ASSERT_EQ(slot != -1, it != ref.end());
+            if (slot != -1 && queue.priority(slot) < prio) {
+                queue[slot].prio = prio;
+                queue.updatePriority(slot, prio);
+                ref.erase(it);
+                ref_insert({addr, prio});
+            }
+        } else if (queue.find(addr, false) == -1) {
+            // insert, replacing the lowest priority oldest when full
+            if (queue.full()) {
+                auto victim = ref.end();
+                --victim;
+                while (victim != ref.begin() &&
+                       std::prev(victim)->prio == victim->prio) {
+                    --victim;
+                }
+                int slot = queue.replacementCandidate();
+                ASSERT_EQ(queue[slot].addr, victim->addr);
+                queue.erase(slot);
+                ref.erase(victim);
+            }
+            queue.push({addr, prio}, addr, false, prio);
+            ref_insert({addr, prio});
+        }
+
+        ASSERT_EQ(queue.size(), ref.size());
+        if (iter % 64 == 0) {
+            std::vector<Addr> expected;
+            for (auto &e : ref) expected.push_back(e.addr);
+            ASSERT_EQ(issueOrder(queue, capacity), expected);
+        }
+    }
+}
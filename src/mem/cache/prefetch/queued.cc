@@ -40,13 +40,16 @@
 #include <cassert>
 
 #include "arch/generic/tlb.hh"
+#include "base/cprintf.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/HWPrefetch.hh"
 #include "debug/HWPrefetchQueue.hh"
 #include "mem/cache/base.hh"
+#include "mem/cache/prefetch/associative_set_impl.hh"
 #include "mem/request.hh"
 #include "params/QueuedPrefetcher.hh"
+#include "sim/system.hh"
 
 namespace gem5
 {
@@ -62,8 +65,7 @@ Queued::DeferredPacket::createPkt(Addr paddr, unsigned blk_size,
                                             Tick t, 
                                             bool tag_vaddr) {
     /* Create a prefetch memory request */
-    RequestPtr req = std::make_shared<Request>(paddr, blk_size,
-                                                0, requestor_id);
+    RequestPtr req = Request::create(paddr, blk_size, 0, requestor_id);
 
     if (pfInfo.isSecure()) {
         req->setFlags(Request::SECURE);
@@ -98,9 +100,23 @@ Queued::DeferredPacket::finish(const Fault &fault,
     const RequestPtr &req, ThreadContext *tc, BaseMMU::Mode mode)
 {
     assert(ongoingTranslation);
-    ongoingTranslation = false;
     bool failed = (fault != NoFault);
-    owner->translationComplete(this, failed);
+
+    // the TLB of a core on another event queue completes the walk on
+    // its queue, the prefetcher learns of it a quantum later; the
+    // entry stays in the queue meanwhile as its translation is ongoing
+    if (curEventQueue() != owner->eventQueue()) {
+        owner->eventQueue()->schedule(new EventFunctionWrapper(
+            [this, failed]() {
+                ongoingTranslation = false;
+                owner->walkComplete(this, failed);
+            }, owner->name() + ".walk_complete", true),
+            curTick() + simQuantum);
+        return;
+    }
+
+    ongoingTranslation = false;
+    owner->walkComplete(this, failed);
 }
 
 Queued::Queued(const QueuedPrefetcherParams &p)
@@ -111,25 +127,48 @@ Queued::Queued(const QueuedPrefetcherParams &p)
       queueFilter(p.queue_filter), cacheSnoop(p.cache_snoop),
       tagPrefetch(p.tag_prefetch), tagVaddr(p.tag_vaddr),
       crossPageCtrl(p.cross_page_ctrl),
-      throttleControlPct(p.throttle_control_percentage), statsQueued(this)
+      throttleControlPct(p.throttle_control_percentage),
+      pfq(p.queue_size), pfqMissingTranslation(p.queue_size),
+      usePfTLB(p.use_pf_tlb),
+      pfTLB(p.pf_tlb_assoc, p.pf_tlb_entries, p.pf_tlb_indexing_policy,
+            p.pf_tlb_replacement_policy),
+      statsQueued(this)
 {
     assert(useVirtualAddresses == tagVaddr);
 
-    if (!p.stats_pc_list.empty()) {
-        statsQueued.regQueuedPerPC(stats_pc_list);
-    }
+    statsQueued.regQueuedPerPC(stats_pc_index);
 }
 
 Queued::~Queued()
 {
     // Delete the queued prefetch packets
-    for (DeferredPacket &p : pfq) {
-        delete p.pkt;
+    pfq.forEach([&](int slot) { delete pfq[slot].pkt; });
+}
+
+void
+Queued::squashPrefetches()
+{
+    DPRINTF(HWPrefetch, "Squashing %d queued prefetches.\n", pfq.size());
+    while (!pfq.empty()) {
+        delete pfq[pfq.top()].pkt;
+        pfq.erase(pfq.top());
+    }
+
+    // the TLB still calls back the translations in flight, they are
+    // dropped on completion
+    std::vector<int> slots;
+    pfqMissingTranslation.forEach([&](int slot) {
+        if (!pfqMissingTranslation[slot].ongoingTranslation) {
+            slots.push_back(slot);
+        }
+    });
+    for (int slot : slots) {
+        pfqMissingTranslation.erase(slot);
     }
 }
 
 void
-Queued::printQueue(const std::list<DeferredPacket> &queue) const
+Queued::printQueue(DeferredQueue &queue)
 {
     int pos = 0;
     std::string queue_name = "";
@@ -140,14 +179,15 @@ Queued::printQueue(const std::list<DeferredPacket> &queue) const
         queue_name = "PFTransQ";
     }
 
-    for (const_iterator it = queue.cbegin(); it != queue.cend();
-                                                            it++, pos++) {
-        Addr vaddr = it->pfInfo.getAddr();
+    queue.forEachInOrder(queue.size(), [&](int slot) {
+        const DeferredPacket &dp = queue[slot];
+        Addr vaddr = dp.pfInfo.getAddr();
         /* Set paddr to 0 if not yet translated */
-        Addr paddr = it->pkt ? it->pkt->getAddr() : 0;
+        Addr paddr = dp.pkt ? dp.pkt->getAddr() : 0;
         DPRINTF(HWPrefetchQueue, "%s[%d]: Prefetch Req VA: %#x PA: %#x "
-                "prio: %3d\n", queue_name, pos, vaddr, paddr, it->priority);
-    }
+                "prio: %3d\n", queue_name, pos, vaddr, paddr, dp.priority);
+        pos++;
+    });
 }
 
 void
@@ -197,34 +237,27 @@ Queued::notify(const PacketPtr &pkt, const PrefetchInfo &pfi)
 
     // Squash queued prefetches if demand miss to same line
     if (queueSquash) {
-        auto itr = pfq.begin();
-        while (itr != pfq.end()) {
-            if (itr->pfInfo.getAddr() == blk_addr &&
-                itr->pfInfo.isSecure() == is_secure) {
-                DPRINTF(HWPrefetch, "Removing pf candidate addr: %#x "
-                        "(cl: %#x), demand request going to the same addr\n",
-                        itr->pfInfo.getAddr(),
-                        blockAddress(itr->pfInfo.getAddr()));
-                statsQueued.pfRemovedDemand++;
-                if (itr->pfInfo.hasPC()) {
-                    Addr req_pc = itr->pfInfo.getPC();
-                    for (int i = 0; i < stats_pc_list.size(); i++) {
-                        if (req_pc == stats_pc_list[i]) {
-                            statsQueued.pfRemovedDemandPerPfPC[i]++;
-                            break;
-                        }
-                    }
+        pfq.forEachAddr(blk_addr, is_secure, [&](int slot) {
+            DeferredPacket &dp = pfq[slot];
+            DPRINTF(HWPrefetch, "Removing pf candidate addr: %#x "
+                    "(cl: %#x), demand request going to the same addr\n",
+                    dp.pfInfo.getAddr(),
+                    blockAddress(dp.pfInfo.getAddr()));
+            statsQueued.pfRemovedDemand++;
+            if (dp.pfInfo.hasPC()) {
+                Addr req_pc = dp.pfInfo.getPC();
+                if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                    statsQueued.pfRemovedDemandPerPfPC[i]++;
                 }
-                delete itr->pkt;
-                itr = pfq.erase(itr);
-            } else {
-                ++itr;
             }
-        }
+            delete dp.pkt;
+            pfq.erase(slot);
+        });
     }
 
     // Calculate prefetches given this access
-    std::vector<AddrPriority> addresses;
+    std::vector<AddrPriority> &addresses = pfCandidates;
+    addresses.clear();
     calculatePrefetch(pfi, addresses);
 
     // Get the maximu number of prefetches that we are allowed to generate
@@ -279,19 +312,16 @@ Queued::getPacket()
         return nullptr;
     }
 
-    PacketPtr pkt = pfq.front().pkt;
-    pfq.pop_front();
+    PacketPtr pkt = pfq[pfq.top()].pkt;
+    pfq.erase(pfq.top());
 
     prefetchStats.pfIssued++;
     issuedPrefetches += 1;
 
     if (pkt->req->hasPC()) {
         Addr req_pc = pkt->req->getPC();
-        for (int i = 0; i < stats_pc_list.size(); i++) {
-            if (req_pc == stats_pc_list[i]) {
-                prefetchStats.pfIssuedPerPfPC[i]++;
-                break;
-            }
+        if (int i = stats_pc_index.find(req_pc); i >= 0) {
+            prefetchStats.pfIssuedPerPfPC[i]++;
         }
     }
 
@@ -333,11 +363,23 @@ Queued::QueuedStats::QueuedStats(statistics::Group *parent)
              "when there is a chance for prefetch"),
     ADD_STAT(pfTransFailedPerPfPC, statistics::units::Count::get(),
              "number of pfq empty and translation not avaliable immediately "
-             "when there is a chance for prefetch")
+             "when there is a chance for prefetch"),
+    ADD_STAT(pfTranslationsIssued, statistics::units::Count::get(),
+             "number of prefetch translations sent to the TLB"),
+    ADD_STAT(pfTranslationsCoalesced, statistics::units::Count::get(),
+             "number of prefetch translations completed by the walk of "
+             "another prefetch to the same page"),
+    ADD_STAT(pfTLBHits, statistics::units::Count::get(),
+             "number of prefetch translations served by the prefetcher TLB")
+{
+}
+
+void
+Queued::QueuedStats::regQueuedPerPC(const PCStatsIndex &stats_pc_index)
 {
     using namespace statistics;
 
-    int max_per_pc = 32;
+    const int max_per_pc = stats_pc_index.statSize();
 
     pfBufferHitPerPfPC
         .init(max_per_pc)
@@ -359,139 +401,330 @@ Queued::QueuedStats::QueuedStats(statistics::Group *parent)
         .init(max_per_pc)
         .flags(total | nozero | nonan)
         ;
+
+    stats_pc_index.addNamer([this](int i, const std::string &pc_name) {
+        pfBufferHitPerPfPC.subname(i, pc_name);
+        pfInCachePerPfPC.subname(i, pc_name);
+        pfRemovedDemandPerPfPC.subname(i, pc_name);
+        pfRemovedFullPerPfPC.subname(i, pc_name);
+        pfTransFailedPerPfPC.subname(i, pc_name);
+    });
 }
 
+
 void
-Queued::QueuedStats::regQueuedPerPC(const std::vector<Addr>& stats_pc_list)
+Queued::serialize(CheckpointOut &cp) const
 {
-    using namespace statistics;
+    Base::serialize(cp);
+
+    {
+        ScopedCheckpointSection sec(cp, "pfq");
+        serializeQueue(cp, pfq);
+    }
+    {
+        ScopedCheckpointSection sec(cp, "pfqMissingTranslation");
+        serializeQueue(cp, pfqMissingTranslation);
+    }
+}
 
-    int max_per_pc = 32;
-    assert(stats_pc_list.size() < max_per_pc);
+void
+Queued::unserialize(CheckpointIn &cp)
+{
+    Base::unserialize(cp);
 
-    for (int i = 0; i < stats_pc_list.size(); i++) {
+    // checkpoints taken before prefetchers were serialized
+    if (!cp.sectionExists(Serializable::currentSection() + ".pfq")) {
+        return;
+    }
 
-        std::stringstream stream;
-        stream << std::hex << stats_pc_list[i];
-        std::string pc_name = stream.str();
+    {
+        ScopedCheckpointSection sec(cp, "pfq");
+        unserializeQueue(cp, pfq);
+    }
+    {
+        ScopedCheckpointSection sec(cp, "pfqMissingTranslation");
+        unserializeQueue(cp, pfqMissingTranslation);
+    }
+}
 
-        pfBufferHitPerPfPC.subname(i, pc_name);
-        pfInCachePerPfPC.subname(i, pc_name);
-        pfRemovedDemandPerPfPC.subname(i, pc_name);
-        pfRemovedFullPerPfPC.subname(i, pc_name);
-        pfTransFailedPerPfPC.subname(i, pc_name);
+void
+Queued::serializeQueue(CheckpointOut &cp, const DeferredQueue &queue) const
+{
+    const std::vector<int> slots = queue.slotsInOrder();
+    paramOut(cp, "numEntries", (int)slots.size());
+    for (int i = 0; i < slots.size(); i++) {
+        const DeferredPacket &dp = queue[slots[i]];
+        ScopedCheckpointSection sec(cp, csprintf("Entry%d", i));
+
+        dp.pfInfo.serialize(cp);
+        paramOut(cp, "requestor", requestorName(dp.pfInfo.getRequestorId()));
+        paramOut(cp, "priority", dp.priority);
+        paramOut(cp, "tick", dp.tick);
+        paramOut(cp, "hasPkt", dp.pkt != nullptr);
+        if (dp.pkt) {
+            paramOut(cp, "paddr", dp.pkt->getAddr());
+        } else {
+            const RequestPtr &req = dp.translationRequest;
+            paramOut(cp, "vaddr", req->getVaddr());
+            paramOut(cp, "flags", (Request::FlagsType)req->getFlags());
+            paramOut(cp, "contextId", req->contextId());
+        }
     }
 }
 
+void
+Queued::unserializeQueue(CheckpointIn &cp, DeferredQueue &queue)
+{
+    int num_entries;
+    paramIn(cp, "numEntries", num_entries);
+    for (int i = 0; i < num_entries; i++) {
+        ScopedCheckpointSection sec(cp, csprintf("Entry%d", i));
+
+        std::string requestor;
+        paramIn(cp, "requestor", requestor);
+        RequestorID requestor_id = requestorByName(requestor);
+        if (requestor_id == Request::invldRequestorId) {
+            requestor_id = requestorId;
+        }
+        PrefetchInfo pfi(0, 0, requestor_id, 0);
+        pfi.unserialize(cp, requestor_id);
+
+        int32_t priority;
+        Tick tick;
+        bool has_pkt;
+        paramIn(cp, "priority", priority);
+        paramIn(cp, "tick", tick);
+        paramIn(cp, "hasPkt", has_pkt);
+
+        DeferredPacket dpp(this, pfi, 0, priority);
+        if (has_pkt) {
+            Addr paddr;
+            paramIn(cp, "paddr", paddr);
+            dpp.createPkt(paddr, blkSize, requestorId, tagPrefetch, tick,
+                          tagVaddr);
+        } else {
+            Addr vaddr;
+            Request::FlagsType flags;
+            ContextID context_id;
+            paramIn(cp, "vaddr", vaddr);
+            paramIn(cp, "flags", flags);
+            paramIn(cp, "contextId", context_id);
+            if (context_id < 0 ||
+                context_id >= (int)cache->system->threads.size()) {
+                DPRINTF(HWPrefetch, "Dropping checkpointed prefetch of "
+                        "missing context %d\n", context_id);
+                continue;
+            }
+            dpp.setTranslationRequest(Request::create(
+                vaddr, blkSize, flags, requestorId, pfi.getPC(),
+                context_id));
+            dpp.tc = cache->system->threads[context_id];
+        }
+
+        addToQueue(queue, dpp);
+    }
+}
 
 void
 Queued::processMissingTranslations(unsigned max)
 {
-    unsigned count = 0;
-    iterator it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end() && count < max) {
-        DeferredPacket &dp = *it;
-        // Increase the iterator first because dp.startTranslation can end up
-        // calling finishTranslation, which will erase "it"
-        it++;
-        dp.startTranslation(tlb);
-        count += 1;
+    // startTranslation can end up calling translationComplete, which
+    // erases the visited entry
+    pfqMissingTranslation.forEachInOrder(max, [&](int slot) {
+        startTranslation(pfqMissingTranslation[slot]);
+    });
+}
+
+void
+Queued::startTranslation(DeferredPacket &dp)
+{
+    assert(dp.translationRequest != nullptr);
+    if (dp.ongoingTranslation) {
+        return;
     }
+
+    const RequestPtr &req = dp.translationRequest;
+    const ContextID context = req->contextId();
+    const bool secure = dp.pfInfo.isSecure();
+
+    Addr paddr;
+    if (pfTLBTranslate(req->getVaddr(), context, secure, paddr)) {
+        req->setPaddr(paddr);
+        translationComplete(&dp, false);
+        return;
+    }
+
+    const Addr vpage = pageAddress(req->getVaddr());
+    auto it = pendingWalks.find(vpage);
+    if (it == pendingWalks.end()) {
+        pendingWalks.emplace(vpage, PendingWalk{context, secure, {}});
+        dp.walkLeader = true;
+    } else if (it->second.context == context &&
+               it->second.secure == secure) {
+        DPRINTF(HWPrefetch, "Translation of vaddr %#x joins the walk of "
+                "page %#x\n", req->getVaddr(), vpage);
+        statsQueued.pfTranslationsCoalesced++;
+        dp.ongoingTranslation = true;
+        it->second.waiters.push_back(&dp);
+        return;
+    }
+
+    // the TLB may complete the walk, and erase dp, before returning
+    statsQueued.pfTranslationsIssued++;
+    // the TLB may be on the event queue of a core, whose state is
+    // locked while it translates
+    EventQueue::ScopedEntry enter(tlb->eventQueue());
+    dp.startTranslation(tlb);
 }
 
 void
-Queued::translationComplete(DeferredPacket *dp, bool failed)
+Queued::walkComplete(DeferredPacket *dp, bool failed)
 {
-    auto it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end()) {
-        if (&(*it) == dp) {
-            break;
-        }
-        it++;
+    const Addr vaddr = dp->translationRequest->getVaddr();
+    const Addr paddr = dp->translationRequest->getPaddr();
+    const ContextID context = dp->translationRequest->contextId();
+    const bool secure = dp->pfInfo.isSecure();
+
+    std::vector<DeferredPacket *> waiters;
+    if (dp->walkLeader) {
+        auto it = pendingWalks.find(pageAddress(vaddr));
+        assert(it != pendingWalks.end());
+        waiters = std::move(it->second.waiters);
+        pendingWalks.erase(it);
     }
-    assert(it != pfqMissingTranslation.end());
+
     if (!failed) {
-        DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
-                "paddr %#x \n", tlb->name(),
-                it->translationRequest->getVaddr(),
-                it->translationRequest->getPaddr());
-        Addr target_paddr = it->translationRequest->getPaddr();
-        // check if this prefetch is already redundant
-        if (cacheSnoop && (inCache(target_paddr, it->pfInfo.isSecure()) ||
-                    inMissQueue(target_paddr, it->pfInfo.isSecure()))) {
-            statsQueued.pfInCache++;
-            if (it->pfInfo.hasPC()) {
-                Addr req_pc = it->pfInfo.getPC();
-                for (int i = 0; i < stats_pc_list.size(); i++) {
-                    if (req_pc == stats_pc_list[i]) {
-                        statsQueued.pfInCachePerPfPC[i]++;
-                        break;
-                    }
-                }
-            }
+        pfTLBFill(vaddr, context, secure, paddr);
+    }
 
-            DPRINTF(HWPrefetch, "Dropping redundant in "
-                    "cache/MSHR prefetch addr:%#x\n", target_paddr);
-        } else {
-            Tick pf_time = curTick() + clockPeriod() * latency;
-            it->createPkt(target_paddr, blkSize, requestorId, tagPrefetch,
-                          pf_time, tagVaddr);
-            addToQueue(pfq, *it);
+    translationComplete(dp, failed);
+
+    // the waiters are in the same page, so they share the outcome
+    for (DeferredPacket *waiter : waiters) {
+        assert(waiter->ongoingTranslation);
+        waiter->ongoingTranslation = false;
+        if (!failed) {
+            const RequestPtr &req = waiter->translationRequest;
+            req->setPaddr(pageAddress(paddr) + pageOffset(req->getVaddr()));
         }
+        translationComplete(waiter, failed);
+    }
+
+    // the walk completed outside of an access of the cache
+    cache->schedulePrefetch();
+}
+
+void
+Queued::translationComplete(DeferredPacket *dp, bool failed)
+{
+    const int slot = dp->queueSlot;
+    assert(&pfqMissingTranslation[slot] == dp);
+    if (!enabled) {
+        DPRINTF(HWPrefetch, "Dropping translated prefetch %#x, the "
+                "prefetcher is off\n", dp->translationRequest->getVaddr());
+    } else if (!failed) {
+        DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
+                "paddr %#x \n", tlb->name(),
+                dp->translationRequest->getVaddr(),
+                dp->translationRequest->getPaddr());
+        queueTranslated(*dp, dp->translationRequest->getPaddr());
     } else {
         DPRINTF(HWPrefetch, "%s Translation of vaddr %#x failed, dropping "
                 "prefetch request %#x \n", tlb->name(),
-                it->translationRequest->getVaddr());
+                dp->translationRequest->getVaddr());
 
         statsQueued.pfTransFailed += 1;
-        if (it->pfInfo.hasPC()) {
-            Addr req_pc = it->pfInfo.getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    statsQueued.pfTransFailedPerPfPC[i]++;
-                    break;
-                }
+        if (dp->pfInfo.hasPC()) {
+            Addr req_pc = dp->pfInfo.getPC();
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                statsQueued.pfTransFailedPerPfPC[i]++;
             }
         }
     }
-    pfqMissingTranslation.erase(it);
+    pfqMissingTranslation.erase(slot);
+}
+
+void
+Queued::queueTranslated(DeferredPacket &dp, Addr paddr)
+{
+    // check if this prefetch is already redundant
+    if (cacheSnoop && (inCache(paddr, dp.pfInfo.isSecure()) ||
+                inMissQueue(paddr, dp.pfInfo.isSecure()))) {
+        statsQueued.pfInCache++;
+        if (dp.pfInfo.hasPC()) {
+            Addr req_pc = dp.pfInfo.getPC();
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                statsQueued.pfInCachePerPfPC[i]++;
+            }
+        }
+
+        DPRINTF(HWPrefetch, "Dropping redundant in "
+                "cache/MSHR prefetch addr:%#x\n", paddr);
+    } else {
+        Tick pf_time = curTick() + clockPeriod() * latency;
+        dp.createPkt(paddr, blkSize, requestorId, tagPrefetch,
+                     pf_time, tagVaddr);
+        addToQueue(pfq, dp);
+    }
 }
 
 bool
-Queued::alreadyInQueue(std::list<DeferredPacket> &queue,
-                                 const PrefetchInfo &pfi, int32_t priority)
+Queued::pfTLBTranslate(Addr vaddr, ContextID context, bool secure,
+                       Addr &paddr)
 {
-    bool found = false;
-    iterator it;
-    for (it = queue.begin(); it != queue.end() && !found; it++) {
-        found = it->pfInfo.sameAddr(pfi);
+    if (!usePfTLB) {
+        return false;
+    }
+    PfTLBEntry *entry = pfTLB.findEntry(vaddr / pageBytes, secure);
+    if (entry == nullptr || entry->context != context) {
+        return false;
     }
+    pfTLB.accessEntry(entry);
+    statsQueued.pfTLBHits++;
+    paddr = entry->ppage + pageOffset(vaddr);
+    return true;
+}
+
+void
+Queued::pfTLBFill(Addr vaddr, ContextID context, bool secure, Addr paddr)
+{
+    if (!usePfTLB) {
+        return;
+    }
+    const Addr vpn = vaddr / pageBytes;
+    PfTLBEntry *entry = pfTLB.findEntry(vpn, secure);
+    if (entry == nullptr) {
+        entry = pfTLB.findVictim(vpn);
+    } else {
+        // the page of another context, or a remapped one
+        pfTLB.invalidate(entry);
+    }
+    entry->context = context;
+    entry->ppage = pageAddress(paddr);
+    pfTLB.insertEntry(vpn, secure, entry);
+}
+
+bool
+Queued::alreadyInQueue(DeferredQueue &queue,
+                                 const PrefetchInfo &pfi, int32_t priority)
+{
+    const int slot = queue.find(pfi.getAddr(), pfi.isSecure());
+    bool found = slot != -1;
 
     /* If the address is already in the queue, update priority and leave */
-    if (it != queue.end()) {
+    if (found) {
         statsQueued.pfBufferHit++;
         if (pfi.hasPC()) {
             Addr req_pc = pfi.getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    statsQueued.pfBufferHitPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                statsQueued.pfBufferHitPerPfPC[i]++;
             }
         }
 
-        if (it->priority < priority) {
+        if (queue[slot].priority < priority) {
             /* Update priority value and position in the queue */
-            it->priority = priority;
-            iterator prev = it;
-            while (prev != queue.begin()) {
-                prev--;
-                /* If the packet has higher priority, swap */
-                if (*it > *prev) {
-                    std::swap(*it, *prev);
-                    it = prev;
-                }
-            }
+            queue[slot].priority = priority;
+            queue.updatePriority(slot, priority);
             DPRINTF(HWPrefetch, "Prefetch addr already in "
                 "prefetch queue, priority updated\n");
         } else {
@@ -506,17 +739,27 @@ RequestPtr
 Queued::createPrefetchRequest(Addr addr, PrefetchInfo const &pfi,
                                         PacketPtr pkt)
 {
-    RequestPtr translation_req = std::make_shared<Request>(
+    RequestPtr translation_req = Request::create(
             addr, blkSize, pkt->req->getFlags(), requestorId, pfi.getPC(),
             pkt->req->contextId());
     translation_req->setFlags(Request::PREFETCH);
     return translation_req;
 }
 
+bool
+Queued::trainingOnly() const
+{
+    return cache->system->isAtomicMode();
+}
+
 void
 Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
                          int32_t priority)
 {
+    if (trainingOnly()) {
+        return;
+    }
+
     if (queueFilter) {
         if (alreadyInQueue(pfq, new_pfi, priority)) {
             return;
@@ -589,11 +832,8 @@ Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
         statsQueued.pfInCache++;
         if (new_pfi.hasPC()) {
             Addr req_pc = new_pfi.getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    statsQueued.pfInCachePerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                statsQueued.pfInCachePerPfPC[i]++;
             }
         }
 
@@ -623,59 +863,38 @@ Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
 }
 
 void
-Queued::addToQueue(std::list<DeferredPacket> &queue,
+Queued::addToQueue(DeferredQueue &queue,
                              DeferredPacket &dpp)
 {
     /* Verify prefetch buffer space for request */
-    if (queue.size() == queueSize) {
+    if (queue.full()) {
         statsQueued.pfRemovedFull++;
         if (dpp.pfInfo.hasPC()) {
             Addr req_pc = dpp.pfInfo.getPC();
-            for (int i = 0; i < stats_pc_list.size(); i++) {
-                if (req_pc == stats_pc_list[i]) {
-                    statsQueued.pfRemovedFullPerPfPC[i]++;
-                    break;
-                }
+            if (int i = stats_pc_index.find(req_pc); i >= 0) {
+                statsQueued.pfRemovedFullPerPfPC[i]++;
             }
         }
-        /* Lowest priority packet */
-        iterator it = queue.end();
-        panic_if (it == queue.begin(),
-            "Prefetch queue is both full and empty!");
-        --it;
-        /* Look for oldest in that level of priority */
-        panic_if (it == queue.begin(),
-            "Prefetch queue is full with 1 element!");
-        iterator prev = it;
-        bool cont = true;
-        /* While not at the head of the queue */
-        while (cont && prev != queue.begin()) {
-            prev--;
-            /* While at the same level of priority */
-            cont = prev->priority == it->priority;
-            if (cont)
-                /* update pointer */
-                it = prev;
+        /* Lowest priority, oldest packet */
+        const int victim = queue.replacementCandidate();
+        if (queue[victim].ongoingTranslation) {
+            /* The TLB still owns it, drop the new packet instead */
+            DPRINTF(HWPrefetch, "Prefetch queue full, dropping packet, "
+                    "addr: %#x\n", dpp.pfInfo.getAddr());
+            delete dpp.pkt;
+            return;
         }
         DPRINTF(HWPrefetch, "Prefetch queue full, removing lowest priority "
-                            "oldest packet, addr: %#x\n",it->pfInfo.getAddr());
-        delete it->pkt;
-        queue.erase(it);
+                "oldest packet, addr: %#x\n",
+                queue[victim].pfInfo.getAddr());
+        delete queue[victim].pkt;
+        queue.erase(victim);
     }
 
-    if ((queue.size() == 0) || (dpp <= queue.back())) {
-        queue.emplace_back(dpp);
-    } else {
-        iterator it = queue.end();
-        do {
-            --it;
-        } while (it != queue.begin() && dpp > *it);
-        /* If we reach the head, we have to see if the new element is new head
-         * or not */
-        if (it == queue.begin() && dpp <= *it)
-            it++;
-        queue.insert(it, dpp);
-    }
+    /* Queued behind every packet of the same or higher priority */
+    const int slot = queue.push(dpp, dpp.pfInfo.getAddr(),
+                                dpp.pfInfo.isSecure(), dpp.priority);
+    queue[slot].queueSlot = slot;
 
     if (debug::HWPrefetchQueue)
         printQueue(queue);
@@ -39,13 +39,16 @@
 #define __MEM_CACHE_PREFETCH_QUEUED_HH__
 
 #include <cstdint>
-#include <list>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "arch/generic/mmu.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
+#include "mem/cache/prefetch/associative_set.hh"
 #include "mem/cache/prefetch/base.hh"
+#include "mem/cache/prefetch/prefetch_queue.hh"
 #include "mem/packet.hh"
 
 namespace gem5
@@ -75,7 +78,12 @@ class Queued : public Base
         /** Request used when a translation is needed */
         RequestPtr translationRequest;
         ThreadContext *tc;
+        /** Translating, or waiting for the walk of its page */
         bool ongoingTranslation;
+        /** Whether the walk of its page was issued for this packet */
+        bool walkLeader;
+        /** Slot of this packet in the queue holding it */
+        int queueSlot;
 
         /**
          * Constructor
@@ -88,20 +96,7 @@ class Queued : public Base
         DeferredPacket(Queued *o, PrefetchInfo const &pfi, Tick t,
             int32_t prio) : owner(o), pfInfo(pfi), tick(t), pkt(nullptr),
             priority(prio), translationRequest(), tc(nullptr),
-            ongoingTranslation(false) {
-        }
-
-        bool operator>(const DeferredPacket& that) const
-        {
-            return priority > that.priority;
-        }
-        bool operator<(const DeferredPacket& that) const
-        {
-            return priority < that.priority;
-        }
-        bool operator<=(const DeferredPacket& that) const
-        {
-            return !(*this > that);
+            ongoingTranslation(false), walkLeader(false), queueSlot(-1) {
         }
 
         /**
@@ -140,11 +135,23 @@ class Queued : public Base
         void startTranslation(BaseTLB *tlb);
     };
 
-    std::list<DeferredPacket> pfq;
-    std::list<DeferredPacket> pfqMissingTranslation;
+    using DeferredQueue = PrefetchQueue<DeferredPacket>;
+
+    /** Entry of the prefetcher TLB, tagged with the virtual page number */
+    struct PfTLBEntry : public TaggedEntry
+    {
+        ContextID context = InvalidContextID;
+        /** Physical address of the page */
+        Addr ppage = 0;
+    };
 
-    using const_iterator = std::list<DeferredPacket>::const_iterator;
-    using iterator = std::list<DeferredPacket>::iterator;
+    /** Packets of a page waiting for the walk issued for another one */
+    struct PendingWalk
+    {
+        ContextID context;
+        bool secure;
+        std::vector<DeferredPacket *> waiters;
+    };
 
     // PARAMETERS
 
@@ -180,10 +187,24 @@ class Queued : public Base
     /** Percentage of requests that can be throttled */
     const unsigned int throttleControlPct;
 
+    DeferredQueue pfq;
+    DeferredQueue pfqMissingTranslation;
+
+    /** Look translations up in the prefetcher TLB before the TLB */
+    const bool usePfTLB;
+    /** Small TLB of the prefetcher, filled by its own walks */
+    AssociativeSet<PfTLBEntry> pfTLB;
+
+    /**
+     * In-flight walks by virtual page. Only one translation per page is
+     * sent to the TLB, the other packets of the page complete with it.
+     */
+    std::unordered_map<Addr, PendingWalk> pendingWalks;
+
     struct QueuedStats : public statistics::Group
     {
         QueuedStats(statistics::Group *parent);
-        void regQueuedPerPC(const std::vector<Addr>& stats_pc_list);
+        void regQueuedPerPC(const PCStatsIndex &stats_pc_index);
         // STATS
         statistics::Scalar pfIdentified;
         statistics::Scalar pfBufferHit;
@@ -198,6 +219,9 @@ class Queued : public Base
         statistics::Scalar pfUsefulSpanPage;
         statistics::Scalar pfTransFailed;
         statistics::Vector pfTransFailedPerPfPC;
+        statistics::Scalar pfTranslationsIssued;
+        statistics::Scalar pfTranslationsCoalesced;
+        statistics::Scalar pfTLBHits;
     } statsQueued;
   public:
     using AddrPriority = std::pair<Addr, int32_t>;
@@ -215,21 +239,41 @@ class Queued : public Base
 
     Tick nextPrefetchReadyTime() const override
     {
-        return pfq.empty() ? MaxTick : pfq.front().tick;
+        return pfq.empty() ? MaxTick : pfq[pfq.top()].tick;
     }
 
-    void printQueue(const std::list<DeferredPacket> &queue) const;
+    void squashPrefetches() override;
+
+    void printQueue(DeferredQueue &queue);
 
     void printSize() const;
 
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
   protected:
 
+    /**
+     * Checkpoint the packets of a queue in issue order. Packets waiting
+     * for a translation are restored without it, so it is redone with
+     * the TLBs of the restoring system.
+     */
+    void serializeQueue(CheckpointOut &cp, const DeferredQueue &queue) const;
+    void unserializeQueue(CheckpointIn &cp, DeferredQueue &queue);
+
+    /**
+     * Whether prefetches are only trained and not queued. Prefetches are
+     * never issued in atomic mode, where caches with prefetch_warming
+     * still notify the prefetcher to train it during fast-forward.
+     */
+    bool trainingOnly() const;
+
     /**
      * Adds a DeferredPacket to the specified queue
      * @param queue selected queue to use
      * @param dpp DeferredPacket to add
      */
-    void addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp);
+    void addToQueue(DeferredQueue &queue, DeferredPacket &dpp);
 
     /**
      * Starts the translations of the queued prefetches with a
@@ -240,6 +284,22 @@ class Queued : public Base
      */
     void processMissingTranslations(unsigned max);
 
+    /**
+     * Translates the address of a packet of the missing translation
+     * queue: from the prefetcher TLB, by joining the walk in flight for
+     * its page, or by sending it to the TLB.
+     * @param dp the deferred packet to translate
+     */
+    void startTranslation(DeferredPacket &dp);
+
+    /**
+     * Completes the walk issued for a packet, and the translations of
+     * the packets of the same page waiting for it.
+     * @param dp the deferred packet the walk was issued for
+     * @param failed whether the translation was successful
+     */
+    void walkComplete(DeferredPacket *dp, bool failed);
+
     /**
      * Indicates that the translation of the address of the provided  deferred
      * packet has been successfully completed, and it can be enqueued as a
@@ -249,6 +309,28 @@ class Queued : public Base
      */
     void translationComplete(DeferredPacket *dp, bool failed);
 
+    /**
+     * Queues a translated prefetch as ready, unless the cache snoop
+     * finds it redundant.
+     * @param dp the deferred packet of the prefetch, copied to pfq
+     * @param paddr physical address of the prefetch
+     */
+    void queueTranslated(DeferredPacket &dp, Addr paddr);
+
+    /**
+     * Translates an address with the prefetcher TLB.
+     * @param vaddr virtual address to translate
+     * @param context context of the address space
+     * @param secure whether the address is secure
+     * @param paddr the physical address, on a hit
+     * @return True if the prefetcher TLB holds the page
+     */
+    bool pfTLBTranslate(Addr vaddr, ContextID context, bool secure,
+                        Addr &paddr);
+
+    /** Inserts the translation of a page in the prefetcher TLB */
+    void pfTLBFill(Addr vaddr, ContextID context, bool secure, Addr paddr);
+
     /**
      * Checks whether the specified prefetch request is already in the
      * specified queue. If the request is found, its priority is updated.
@@ -257,7 +339,7 @@ class Queued : public Base
      * @param priority priority of the prefetch request to be added
      * @return True if the prefetch request was found in the queue
      */
-    bool alreadyInQueue(std::list<DeferredPacket> &queue,
+    bool alreadyInQueue(DeferredQueue &queue,
                         const PrefetchInfo &pfi, int32_t priority);
 
     /**
@@ -272,6 +354,10 @@ class Queued : public Base
 
     RequestPtr createPrefetchRequest(Addr addr, PrefetchInfo const &pfi,
                                         PacketPtr pkt);
+
+  private:
+    /** Candidates of the current notification, kept to reuse its storage */
+    std::vector<AddrPriority> pfCandidates;
 };
 
 } // namespace prefetch
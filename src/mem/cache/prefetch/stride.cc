@@ -46,11 +46,14 @@
 
 #include "mem/cache/prefetch/stride.hh"
 
+#include <algorithm>
 #include <cassert>
 
+#include "base/cprintf.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/random.hh"
+#include "base/str.hh"
 #include "base/trace.hh"
 #include "debug/HWPrefetch.hh"
 #include "mem/cache/prefetch/associative_set_impl.hh"
@@ -130,6 +133,18 @@ Stride::checkStride(Addr addr) const
     return false;
 }
 
+bool
+Stride::checkStride(Addr addr, int context) const
+{
+    auto it = pcTables.find(useRequestorId ? context : 0);
+    if (it == pcTables.end()) {
+        return false;
+    }
+
+    StrideEntry* entry = it->second.findEntry(addr, false);
+    return entry && entry->confidence.calcSaturation() >= threshConf;
+}
+
 void
 Stride::calculatePrefetch(const PrefetchInfo &pfi,
                                     std::vector<AddrPriority> &addresses)
@@ -209,6 +224,127 @@ Stride::calculatePrefetch(const PrefetchInfo &pfi,
     }
 }
 
+bool
+Stride::setRuntimeParam(const std::string &name, const std::string &value)
+{
+    if (name == "degree") {
+        int new_degree;
+        if (!to_number(value, new_degree) || new_degree < 0) {
+            return false;
+        }
+        degree = new_degree;
+        return true;
+    }
+    return Queued::setRuntimeParam(name, value);
+}
+
+void
+Stride::serialize(CheckpointOut &cp) const
+{
+    Queued::serialize(cp);
+
+    std::vector<int> contexts;
+    for (const auto &table : pcTables) {
+        if (!useRequestorId || !requestorName(table.first).empty()) {
+            contexts.push_back(table.first);
+        }
+    }
+    std::sort(contexts.begin(), contexts.end());
+
+    ScopedCheckpointSection sec(cp, "pcTables");
+    paramOut(cp, "numPCTables", (int)contexts.size());
+    for (int i = 0; i < contexts.size(); i++) {
+        const PCTable &table = pcTables.at(contexts[i]);
+
+        std::vector<Addr> pcs;
+        std::vector<bool> secure;
+        std::vector<Addr> last_addr;
+        std::vector<int> strides;
+        std::vector<int> confidence;
+        for (const auto &entry : table) {
+            if (!entry.isValid()) continue;
+            pcs.push_back(table.regenerateAddr(&entry));
+            secure.push_back(entry.isSecure());
+            last_addr.push_back(entry.lastAddr);
+            strides.push_back(entry.stride);
+            confidence.push_back((uint8_t)entry.confidence);
+        }
+
+        ScopedCheckpointSection table_sec(cp, csprintf("pcTable%d", i));
+        if (useRequestorId) {
+            paramOut(cp, "requestor", requestorName(contexts[i]));
+        }
+        arrayParamOut(cp, "pc", pcs);
+        arrayParamOut(cp, "secure", secure);
+        arrayParamOut(cp, "lastAddr", last_addr);
+        arrayParamOut(cp, "stride", strides);
+        arrayParamOut(cp, "confidence", confidence);
+    }
+}
+
+void
+Stride::unserialize(CheckpointIn &cp)
+{
+    Queued::unserialize(cp);
+
+    // checkpoints taken before prefetchers were serialized
+    if (!cp.sectionExists(Serializable::currentSection() + ".pcTables")) {
+        return;
+    }
+
+    ScopedCheckpointSection sec(cp, "pcTables");
+    int num_tables;
+    paramIn(cp, "numPCTables", num_tables);
+    for (int i = 0; i < num_tables; i++) {
+        ScopedCheckpointSection table_sec(cp, csprintf("pcTable%d", i));
+
+        int context = 0;
+        if (useRequestorId) {
+            std::string requestor;
+            // the checkpoint may come from a run without use_requestor_id
+            if (optParamIn(cp, "requestor", requestor, false)) {
+                context = requestorByName(requestor);
+                if (context == Request::invldRequestorId) {
+                    warn("%s: no requestor %s, dropping its stride table\n",
+                         name(), requestor);
+                    continue;
+                }
+            }
+        }
+
+        std::vector<Addr> pcs;
+        std::vector<bool> secure;
+        std::vector<Addr> last_addr;
+        std::vector<int> strides;
+        std::vector<int> confidence;
+        arrayParamIn(cp, "pc", pcs);
+        arrayParamIn(cp, "secure", secure);
+        arrayParamIn(cp, "lastAddr", last_addr);
+        arrayParamIn(cp, "stride", strides);
+        arrayParamIn(cp, "confidence", confidence);
+        fatal_if(secure.size() != pcs.size() ||
+                 last_addr.size() != pcs.size() ||
+                 strides.size() != pcs.size() ||
+                 confidence.size() != pcs.size(),
+                 "Inconsistent stride table in %s\n",
+                 Serializable::currentSection());
+
+        PCTable *table = findTable(context);
+        for (size_t e = 0; e < pcs.size(); e++) {
+            StrideEntry *entry = table->findEntry(pcs[e], secure[e]);
+            if (!entry) {
+                entry = table->findVictim(pcs[e]);
+                table->insertEntry(pcs[e], secure[e], entry);
+            }
+            entry->lastAddr = last_addr[e];
+            entry->stride = strides[e];
+            // SatCounter8 has no setter, clear it and add the value
+            entry->confidence -= entry->confidence;
+            entry->confidence += confidence[e];
+        }
+    }
+}
+
 uint32_t
 StridePrefetcherHashedSetAssociative::extractSet(const Addr pc) const
 {
@@ -223,5 +359,12 @@ StridePrefetcherHashedSetAssociative::extractTag(const Addr addr) const
     return addr;
 }
 
+Addr
+StridePrefetcherHashedSetAssociative::regenerateAddr(const Addr tag,
+    const ReplaceableEntry *entry) const
+{
+    return tag;
+}
+
 } // namespace prefetch
 } // namespace gem5
@@ -85,6 +85,11 @@ class StridePrefetcherHashedSetAssociative : public SetAssociative
     uint32_t extractSet(const Addr addr) const override;
     Addr extractTag(const Addr addr) const override;
 
+  public:
+    /** The tag is the whole address */
+    Addr regenerateAddr(const Addr tag,
+                        const ReplaceableEntry *entry) const override;
+
   public:
     StridePrefetcherHashedSetAssociative(
         const StridePrefetcherHashedSetAssociativeParams &p)
@@ -105,7 +110,7 @@ class Stride : public Queued
 
     const bool useRequestorId;
 
-    const int degree;
+    int degree;
 
     /**
      * Information used to create a new PC table. All of them behave equally.
@@ -169,8 +174,26 @@ class Stride : public Queued
 
     bool checkStride(Addr addr) const;
 
+    /**
+     * Same as checkStride(addr), but only consult the PC table of the
+     * given context (requestor ID when use_requestor_id is set).
+     */
+    bool checkStride(Addr addr, int context) const;
+
     void calculatePrefetch(const PrefetchInfo &pfi,
                            std::vector<AddrPriority> &addresses) override;
+
+    /** Also accepts "degree" */
+    bool setRuntimeParam(const std::string &name,
+                         const std::string &value) override;
+
+    /**
+     * The PC tables are checkpointed by requestor name (see
+     * Base::requestorName()) and entries are reinserted on restore, so
+     * they can be restored with another table geometry.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 } // namespace prefetch
@@ -0,0 +1,187 @@
+/**
+ * Per-context partitioning of FIFO-replaced prefetcher tables
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_TABLE_PARTITION_HH__
+#define __MEM_CACHE_PREFETCH_TABLE_PARTITION_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/logging.hh"
+#include "sim/serialize.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/**
+ * Splits the slots of a table into num_parts private partitions of
+ * part_entries slots each, followed by a shared overflow pool holding
+ * the remaining slots:
+ *
+ * slot:  | part 0 | part 1 | ... | part n-1 |  shared pool  |
+ *
+ * Every partition and the pool are FIFO-replaced on their own, so the
+ * entries of one context can only be replaced by that context or, once
+ * demoted to the pool, by the pool's FIFO. Keys (ContextID or core id)
+ * without a partition allocate directly in the pool.
+ *
+ * With num_parts == 0 the whole table is the pool, which is the plain
+ * shared FIFO table.
+ *
+ * The class only manages slot ranges and replacement pointers, the
+ * table storage stays with its owner.
+ */
+class TablePartitions
+{
+    const int numEntries;
+    const int numParts;
+    const int partEntries;
+
+    /** first slot of the shared pool */
+    const int poolBase;
+
+    std::vector<int> partPtr;
+    int poolPtr;
+
+  public:
+    /**
+     * @param num_entries total slots of the table
+     * @param num_parts number of private partitions, 0 to share all
+     * @param part_entries slots of each partition
+     */
+    TablePartitions(int num_entries, int num_parts, int part_entries)
+      : numEntries(num_entries), numParts(num_parts),
+        partEntries(num_parts > 0 ? part_entries : 0),
+        poolBase(numParts * partEntries),
+        partPtr(num_parts, 0), poolPtr(0)
+    {
+        fatal_if(num_parts < 0, "Negative number of table partitions");
+        fatal_if(num_parts > 0 && part_entries <= 0,
+                 "Table partitions need at least one entry each");
+        fatal_if(poolBase > numEntries,
+                 "%d partitions of %d entries exceed table size %d",
+                 num_parts, part_entries, num_entries);
+    }
+
+    int poolSize() const { return numEntries - poolBase; }
+
+    /** Entries a partition (-1 for the pool) holds before dropping any */
+    int
+    capacity(int part) const
+    {
+        return (part >= 0 ? partEntries : 0) + poolSize();
+    }
+
+    bool inPool(int slot) const { return slot >= poolBase; }
+
+    /**
+     * Partition serving a key, or -1 for the shared pool. Keys beyond
+     * the partitions fold onto them if there is no pool to fall back to.
+     */
+    int
+    partOf(int key) const
+    {
+        if (numParts == 0) return -1;
+        if (key >= 0 && key < numParts) return key;
+        if (poolSize() > 0) return -1;
+        return (key % numParts + numParts) % numParts;
+    }
+
+    /** Take the next FIFO slot of the pool */
+    int
+    allocatePool()
+    {
+        assert(poolSize() > 0);
+        int slot = poolBase + poolPtr;
+        poolPtr = (poolPtr + 1) % poolSize();
+        return slot;
+    }
+
+    /** Take the next FIFO slot of a partition (-1 for the pool) */
+    int
+    allocate(int part)
+    {
+        if (part < 0) return allocatePool();
+
+        assert(part < numParts);
+        int slot = part * partEntries + partPtr[part];
+        partPtr[part] = (partPtr[part] + 1) % partEntries;
+        return slot;
+    }
+
+    /**
+     * Pool slot the current occupant of a partition slot should move to
+     * before being replaced, or -1 if it is simply dropped.
+     */
+    int
+    demote(int slot, bool occupied)
+    {
+        if (!occupied || inPool(slot) || poolSize() == 0) return -1;
+        return allocatePool();
+    }
+
+    /** Checkpoint the replacement pointers */
+    void
+    serialize(CheckpointOut &cp) const
+    {
+        SERIALIZE_CONTAINER(partPtr);
+        SERIALIZE_SCALAR(poolPtr);
+    }
+
+    /**
+     * Restore the replacement pointers, unless the checkpoint was taken
+     * with another partitioning.
+     * @return whether the pointers were restored
+     */
+    bool
+    unserialize(CheckpointIn &cp)
+    {
+        std::vector<int> part_ptr;
+        int pool_ptr;
+        arrayParamIn(cp, "partPtr", part_ptr);
+        paramIn(cp, "poolPtr", pool_ptr);
+
+        if (part_ptr.size() != partPtr.size() ||
+            pool_ptr < 0 || pool_ptr >= std::max(poolSize(), 1)) {
+            return false;
+        }
+        for (int ptr : part_ptr) {
+            if (ptr < 0 || ptr >= partEntries) return false;
+        }
+        partPtr = part_ptr;
+        poolPtr = pool_ptr;
+        return true;
+    }
+
+    /**
+     * Call fn(slot) for every slot an entry of the given partition may
+     * live in: the partition itself, then the shared pool.
+     */
+    template <typename Fn>
+    void
+    forEachSlot(int part, Fn &&fn) const
+    {
+        if (part >= 0) {
+            assert(part < numParts);
+            for (int slot = part * partEntries;
+                 slot < (part + 1) * partEntries; slot++) {
+                fn(slot);
+            }
+        }
+        for (int slot = poolBase; slot < numEntries; slot++) {
+            fn(slot);
+        }
+    }
+};
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_TABLE_PARTITION_HH__
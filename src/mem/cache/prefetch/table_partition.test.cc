@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "mem/cache/prefetch/table_partition.hh"
+
+using namespace gem5;
+using namespace gem5::prefetch;
+
+namespace
+{
+
+std::vector<int>
+slotsOf(const TablePartitions &parts, int part)
+{
+    std::vector<int> slots;
+    parts.forEachSlot(part, [&](int slot) { slots.push_back(slot); });
+    return slots;
+}
+
+} // anonymous namespace
+
+/** Without partitions the whole table is one FIFO */
+TEST(TablePartitionsTest, Shared)
+{
+    TablePartitions parts(4, 0, 0);
+
+    EXPECT_EQ(parts.poolSize(), 4);
+    EXPECT_EQ(parts.partOf(0), -1);
+    EXPECT_EQ(parts.partOf(7), -1);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(parts.allocate(parts.partOf(0)), i % 4);
+    }
+    EXPECT_EQ(slotsOf(parts, -1), std::vector<int>({0, 1, 2, 3}));
+    // nothing to demote to, the pool is the table
+    EXPECT_EQ(parts.demote(0, true), -1);
+}
+
+/** Partitions replace on their own and see only themselves and the pool */
+TEST(TablePartitionsTest, Partitioned)
+{
+    TablePartitions parts(8, 2, 3);
+
+    EXPECT_EQ(parts.poolSize(), 2);
+    EXPECT_EQ(parts.partOf(0), 0);
+    EXPECT_EQ(parts.partOf(1), 1);
+    // no partition left for this key, use the pool
+    EXPECT_EQ(parts.partOf(2), -1);
+
+    EXPECT_EQ(parts.allocate(1), 3);
+    EXPECT_EQ(parts.allocate(0), 0);
+    EXPECT_EQ(parts.allocate(1), 4);
+    EXPECT_EQ(parts.allocate(1), 5);
+    EXPECT_EQ(parts.allocate(1), 3);
+    EXPECT_EQ(parts.allocate(-1), 6);
+
+    EXPECT_EQ(slotsOf(parts, 0), std::vector<int>({0, 1, 2, 6, 7}));
+    EXPECT_EQ(slotsOf(parts, 1), std::vector<int>({3, 4, 5, 6, 7}));
+    EXPECT_EQ(slotsOf(parts, -1), std::vector<int>({6, 7}));
+}
+
+/** Replaced partition entries move to the pool, pool entries are dropped */
+TEST(TablePartitionsTest, Demote)
+{
+    TablePartitions parts(6, 2, 2);
+
+    EXPECT_EQ(parts.demote(1, false), -1);
+    EXPECT_EQ(parts.demote(1, true), 4);
+    EXPECT_EQ(parts.demote(2, true), 5);
+    EXPECT_EQ(parts.demote(3, true), 4);
+    EXPECT_EQ(parts.demote(5, true), -1);
+}
+
+/** Without a pool, keys beyond the partitions fold onto them */
+TEST(TablePartitionsTest, NoPool)
+{
+    TablePartitions parts(4, 2, 2);
+
+    EXPECT_EQ(parts.poolSize(), 0);
+    EXPECT_EQ(parts.partOf(3), 1);
+    EXPECT_EQ(parts.partOf(4), 0);
+    EXPECT_EQ(parts.partOf(-1), 1);
+    EXPECT_EQ(parts.demote(0, true), -1);
+    EXPECT_EQ(slotsOf(parts, 1), std::vector<int>({2, 3}));
+}
+
+/**
+ * More entries than a partition holds, inserted like the DMP init PCs:
+ * the replaced ones move to the pool, none is lost up to the capacity
+ */
+TEST(TablePartitionsTest, FillBeyondPartition)
+{
+    TablePartitions parts(8, 2, 2);
+    const int part = parts.partOf(0);
+    ASSERT_EQ(parts.capacity(part), 6);
+
+    std::vector<int> table(8, -1);
+    for (int key = 0; key < parts.capacity(part); key++) {
+        int slot = parts.allocate(part);
+        int demoted = parts.demote(slot, table[slot] != -1);
+        if (demoted != -1)
+            table[demoted] = table[slot];
+        table[slot] = key;
+    }
+
+    std::vector<int> kept;
+    parts.forEachSlot(part, [&](int slot) { kept.push_back(table[slot]); });
+    std::sort(kept.begin(), kept.end());
+    EXPECT_EQ(kept, std::vector<int>({0, 1, 2, 3, 4, 5}));
+    // the other partition is untouched
+    EXPECT_EQ(table[2], -1);
+    EXPECT_EQ(table[3], -1);
+}
@@ -80,9 +80,10 @@ class Queue : public Drainable, public Named
      * The total number of entries in this queue. This number is set
      * as the number of entries requested plus any reserve. This
      * allows for the same number of effective entries while still
-     * maintaining an overflow reserve.
+     * maintaining an overflow reserve. It may be lowered after
+     * construction, see setNumEntries().
      */
-    const int numEntries;
+    int numEntries;
 
     /**
      * The number of entries to hold as a temporary overflow
@@ -142,6 +143,24 @@ class Queue : public Drainable, public Named
         }
     }
 
+    /**
+     * Change the number of entries in use, e.g. in the children of a
+     * forked parameter sweep. The storage is not reallocated, so the
+     * queue can't grow beyond the number of entries it was built with.
+     *
+     * @param num_entries The number of entries, without the reserve.
+     * @return false if num_entries is out of range.
+     */
+    bool setNumEntries(int num_entries)
+    {
+        if (num_entries < 1 ||
+            num_entries + numReserve > (int)entries.size()) {
+            return false;
+        }
+        numEntries = num_entries + numReserve;
+        return true;
+    }
+
     bool isEmpty() const
     {
         return allocated == 0;
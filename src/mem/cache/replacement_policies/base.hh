@@ -30,6 +30,7 @@
 #define __MEM_CACHE_REPLACEMENT_POLICIES_BASE_HH__
 
 #include <memory>
+#include <vector>
 
 #include "base/compiler.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
@@ -110,6 +111,34 @@ class Base : public SimObject
      * @return A shared pointer to the new replacement data.
      */
     virtual std::shared_ptr<ReplacementData> instantiateEntry() = 0;
+
+    /**
+     * Save replacement data, e.g. to checkpoint the contents of a cache.
+     * Policies that do not save their data return no words, and their
+     * restored entries are reset as if they had just been inserted.
+     *
+     * @param replacement_data Replacement data to be saved.
+     * @return The words describing the replacement data.
+     */
+    virtual std::vector<uint64_t>
+    saveEntry(const std::shared_ptr<ReplacementData>& replacement_data) const
+    {
+        return {};
+    }
+
+    /**
+     * Restore replacement data saved by saveEntry.
+     *
+     * @param replacement_data Replacement data to be restored.
+     * @param words The words returned by saveEntry.
+     * @return Whether the words could be restored.
+     */
+    virtual bool
+    restoreEntry(const std::shared_ptr<ReplacementData>& replacement_data,
+                 const std::vector<uint64_t>& words) const
+    {
+        return false;
+    }
 };
 
 } // namespace replacement_policy
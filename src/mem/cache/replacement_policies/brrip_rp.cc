@@ -148,5 +148,31 @@ BRRIP::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new BRRIPReplData(numRRPVBits));
 }
 
+std::vector<uint64_t>
+BRRIP::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    std::shared_ptr<BRRIPReplData> casted_replacement_data =
+        std::static_pointer_cast<BRRIPReplData>(replacement_data);
+    return {(uint8_t)casted_replacement_data->rrpv,
+            casted_replacement_data->valid};
+}
+
+bool
+BRRIP::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 2) return false;
+
+    std::shared_ptr<BRRIPReplData> casted_replacement_data =
+        std::static_pointer_cast<BRRIPReplData>(replacement_data);
+    // the counter saturates if the checkpoint had more RRPV bits
+    casted_replacement_data->rrpv.reset();
+    casted_replacement_data->rrpv += words[0];
+    casted_replacement_data->valid = words[1];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
@@ -158,6 +158,27 @@ class BRRIP : public Base
      * @return A shared pointer to the new replacement data.
      */
     std::shared_ptr<ReplacementData> instantiateEntry() override;
+
+    /**
+     * Save the RRPV and validity of an entry.
+     *
+     * @param replacement_data Replacement data to be saved.
+     * @return The words describing the replacement data.
+     */
+    std::vector<uint64_t> saveEntry(
+        const std::shared_ptr<ReplacementData>& replacement_data) const
+                                                                    override;
+
+    /**
+     * Restore the RRPV and validity of an entry.
+     *
+     * @param replacement_data Replacement data to be restored.
+     * @param words The words returned by saveEntry.
+     * @return Whether the words could be restored.
+     */
+    bool restoreEntry(
+        const std::shared_ptr<ReplacementData>& replacement_data,
+        const std::vector<uint64_t>& words) const override;
 };
 
 } // namespace replacement_policy
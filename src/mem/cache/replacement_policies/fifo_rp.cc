@@ -95,5 +95,25 @@ FIFO::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new FIFOReplData());
 }
 
+std::vector<uint64_t>
+FIFO::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return {std::static_pointer_cast<FIFOReplData>(
+        replacement_data)->tickInserted};
+}
+
+bool
+FIFO::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 1) return false;
+
+    std::static_pointer_cast<FIFOReplData>(
+        replacement_data)->tickInserted = words[0];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
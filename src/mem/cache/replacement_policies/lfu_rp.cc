@@ -93,5 +93,25 @@ LFU::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new LFUReplData());
 }
 
+std::vector<uint64_t>
+LFU::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return {std::static_pointer_cast<LFUReplData>(
+        replacement_data)->refCount};
+}
+
+bool
+LFU::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 1) return false;
+
+    std::static_pointer_cast<LFUReplData>(
+        replacement_data)->refCount = words[0];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
@@ -97,5 +97,25 @@ LRU::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new LRUReplData());
 }
 
+std::vector<uint64_t>
+LRU::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return {std::static_pointer_cast<LRUReplData>(
+        replacement_data)->lastTouchTick};
+}
+
+bool
+LRU::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 1) return false;
+
+    std::static_pointer_cast<LRUReplData>(
+        replacement_data)->lastTouchTick = words[0];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
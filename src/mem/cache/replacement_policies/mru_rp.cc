@@ -102,5 +102,25 @@ MRU::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new MRUReplData());
 }
 
+std::vector<uint64_t>
+MRU::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return {std::static_pointer_cast<MRUReplData>(
+        replacement_data)->lastTouchTick};
+}
+
+bool
+MRU::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 1) return false;
+
+    std::static_pointer_cast<MRUReplData>(
+        replacement_data)->lastTouchTick = words[0];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
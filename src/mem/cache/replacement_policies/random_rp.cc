@@ -96,5 +96,25 @@ Random::instantiateEntry()
     return std::shared_ptr<ReplacementData>(new RandomReplData());
 }
 
+std::vector<uint64_t>
+Random::saveEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return {std::static_pointer_cast<RandomReplData>(
+        replacement_data)->valid};
+}
+
+bool
+Random::restoreEntry(
+    const std::shared_ptr<ReplacementData>& replacement_data,
+    const std::vector<uint64_t>& words) const
+{
+    if (words.size() != 1) return false;
+
+    std::static_pointer_cast<RandomReplData>(
+        replacement_data)->valid = words[0];
+    return true;
+}
+
 } // namespace replacement_policy
 } // namespace gem5
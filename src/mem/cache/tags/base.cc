@@ -139,6 +139,18 @@ BaseTags::moveBlock(CacheBlk *src_blk, CacheBlk *dest_blk)
     assert(!src_blk->isValid());
 }
 
+void
+BaseTags::serializeContents(std::ostream &os) const
+{
+    fatal("%s: these tags cannot checkpoint their contents\n", name());
+}
+
+void
+BaseTags::unserializeContents(std::istream &is)
+{
+    fatal("%s: these tags cannot restore their contents\n", name());
+}
+
 Addr
 BaseTags::extractTag(const Addr addr) const
 {
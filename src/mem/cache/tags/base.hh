@@ -49,6 +49,7 @@
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <iosfwd>
 #include <string>
 
 #include "base/callback.hh"
@@ -349,6 +350,23 @@ class BaseTags : public ClockedObject
      */
     virtual bool anyBlk(std::function<bool(CacheBlk &)> visitor) = 0;
 
+    /**
+     * Write the valid blocks, with their state, replacement data and
+     * data, to a binary stream so a checkpoint restores the cache warm.
+     * Tags that do not support it fail.
+     *
+     * @param os The stream to write to.
+     */
+    virtual void serializeContents(std::ostream &os) const;
+
+    /**
+     * Repopulate the tags from a stream written by serializeContents.
+     * The geometry of the tags must match the checkpointed one.
+     *
+     * @param is The stream to read from.
+     */
+    virtual void unserializeContents(std::istream &is);
+
   private:
     /**
      * Update the reference stats using data from the input block
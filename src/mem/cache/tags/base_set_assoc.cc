@@ -45,9 +45,14 @@
 
 #include "mem/cache/tags/base_set_assoc.hh"
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "base/intmath.hh"
+#include "mem/cache/tags/cache_contents.hh"
+#include "sim/system.hh"
 
 namespace gem5
 {
@@ -109,4 +114,122 @@ BaseSetAssoc::moveBlock(CacheBlk *src_blk, CacheBlk *dest_blk)
     replacementPolicy->reset(dest_blk->replacementData);
 }
 
+void
+BaseSetAssoc::serializeContents(std::ostream &os) const
+{
+    cache_contents::Header header;
+    header.numBlocks = numBlocks;
+    header.blkSize = blkSize;
+
+    // requestors are saved by name, as their ids depend on the order
+    // in which they are registered
+    std::map<int, uint32_t> requestor_ids;
+    std::vector<const CacheBlk *> valid_blks;
+    for (const CacheBlk &blk : blks) {
+        if (!blk.isValid()) continue;
+        valid_blks.push_back(&blk);
+        requestor_ids.emplace(blk.getSrcRequestorId(), 0);
+    }
+    for (auto &requestor : requestor_ids) {
+        requestor.second = header.requestors.size();
+        header.requestors.push_back(
+            system->getRequestorName(requestor.first));
+    }
+    header.numValid = valid_blks.size();
+    header.write(os);
+
+    cache_contents::Blk saved;
+    for (const CacheBlk *blk : valid_blks) {
+        saved.index = blk - blks.data();
+        saved.tag = blk->getTag();
+        saved.secure = blk->isSecure();
+        saved.prefetched = blk->wasPrefetched();
+        saved.prefetchedAllocate = blk->fromPrefetched();
+        saved.coherenceBits = 0;
+        for (unsigned bit : {CacheBlk::WritableBit, CacheBlk::ReadableBit,
+                             CacheBlk::DirtyBit}) {
+            saved.coherenceBits |= blk->isSet(bit) ? bit : 0;
+        }
+        saved.refCount = blk->getRefCount();
+        saved.requestor = requestor_ids.at(blk->getSrcRequestorId());
+        saved.taskId = blk->getTaskId();
+        saved.pc = blk->getPC();
+        saved.replWords = replacementPolicy->saveEntry(blk->replacementData);
+        saved.data.assign(blk->data, blk->data + blkSize);
+        saved.write(os);
+    }
+}
+
+void
+BaseSetAssoc::unserializeContents(std::istream &is)
+{
+    cache_contents::Header header;
+    header.read(is, name());
+    fatal_if(header.numBlocks != numBlocks || header.blkSize != blkSize,
+             "%s: the checkpoint has %d blocks of %d bytes, the cache %d "
+             "blocks of %d bytes\n", name(), header.numBlocks,
+             header.blkSize, numBlocks, blkSize);
+
+    std::vector<RequestorID> requestors;
+    for (const std::string &requestor_name : header.requestors) {
+        RequestorID requestor = system->lookupRequestorId(requestor_name);
+        if (requestor == Request::invldRequestorId) {
+            // the requestor is gone, e.g. after switching CPU models
+            requestor = Request::funcRequestorId;
+        }
+        requestors.push_back(requestor);
+    }
+
+    // the checkpoint replaces whatever is cached
+    for (CacheBlk &blk : blks) {
+        if (blk.isValid()) {
+            invalidate(&blk);
+        }
+    }
+
+    unsigned unrestored_repl = 0;
+    cache_contents::Blk saved;
+    for (uint64_t i = 0; i < header.numValid; i++) {
+        saved.read(is, blkSize, name());
+        fatal_if(saved.index >= numBlocks, "%s: invalid block %d in the "
+                 "checkpointed cache contents\n", name(), saved.index);
+        CacheBlk &blk = blks[saved.index];
+        fatal_if(saved.requestor >= requestors.size() || blk.isValid(),
+                 "%s: corrupted checkpoint of the cache contents\n",
+                 name());
+        const RequestorID requestor = requestors[saved.requestor];
+
+        blk.insert(saved.tag, saved.secure, requestor, saved.taskId);
+        blk.restore(saved.coherenceBits, saved.refCount);
+        if (saved.prefetched) {
+            blk.setPrefetched();
+        }
+        if (saved.prefetchedAllocate) {
+            blk.setPrefetchedAllocate();
+        }
+        blk.setPC(saved.pc);
+        std::copy(saved.data.begin(), saved.data.end(), blk.data);
+
+        // the block must be where the indexing policy looks for it
+        const std::vector<ReplaceableEntry *> entries =
+            indexingPolicy->getPossibleEntries(regenerateBlkAddr(&blk));
+        fatal_if(std::find(entries.begin(), entries.end(), &blk) ==
+                 entries.end(), "%s: the checkpointed cache contents were "
+                 "indexed differently\n", name());
+
+        stats.occupancies[requestor]++;
+        stats.tagsInUse++;
+
+        replacementPolicy->reset(blk.replacementData);
+        if (!saved.replWords.empty() &&
+            !replacementPolicy->restoreEntry(blk.replacementData,
+                                             saved.replWords)) {
+            unrestored_repl++;
+        }
+    }
+
+    warn_if(unrestored_repl, "%s: replacement data of %d blocks could not "
+            "be restored, they were reset\n", name(), unrestored_repl);
+}
+
 } // namespace gem5
@@ -247,6 +247,9 @@ class BaseSetAssoc : public BaseTags
         }
         return false;
     }
+
+    void serializeContents(std::ostream &os) const override;
+    void unserializeContents(std::istream &is) override;
 };
 
 } // namespace gem5
@@ -0,0 +1,119 @@
+#include "mem/cache/tags/cache_contents.hh"
+
+#include <istream>
+#include <ostream>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace cache_contents
+{
+
+namespace
+{
+
+/** Version of the format */
+const uint32_t version = 1;
+
+template <typename T>
+void
+putRaw(std::ostream &os, const T &value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+T
+getRaw(std::istream &is, const std::string &name)
+{
+    T value;
+    is.read(reinterpret_cast<char *>(&value), sizeof(value));
+    fatal_if(!is, "%s: truncated checkpoint of the cache contents\n", name);
+    return value;
+}
+
+} // anonymous namespace
+
+void
+Header::write(std::ostream &os) const
+{
+    putRaw(os, version);
+    putRaw(os, numBlocks);
+    putRaw(os, blkSize);
+
+    putRaw<uint32_t>(os, requestors.size());
+    for (const std::string &requestor : requestors) {
+        putRaw<uint32_t>(os, requestor.size());
+        os.write(requestor.data(), requestor.size());
+    }
+
+    putRaw(os, numValid);
+}
+
+void
+Header::read(std::istream &is, const std::string &name)
+{
+    const uint32_t file_version = getRaw<uint32_t>(is, name);
+    fatal_if(file_version != version, "%s: unsupported version %d of the "
+             "checkpointed cache contents\n", name, file_version);
+    numBlocks = getRaw<uint64_t>(is, name);
+    blkSize = getRaw<uint32_t>(is, name);
+
+    requestors.resize(getRaw<uint32_t>(is, name));
+    for (std::string &requestor : requestors) {
+        requestor.resize(getRaw<uint32_t>(is, name));
+        is.read(&requestor[0], requestor.size());
+    }
+
+    numValid = getRaw<uint64_t>(is, name);
+}
+
+void
+Blk::write(std::ostream &os) const
+{
+    putRaw(os, index);
+    putRaw<uint64_t>(os, tag);
+    putRaw<uint8_t>(os, secure | prefetched << 1 | prefetchedAllocate << 2);
+    putRaw(os, coherenceBits);
+    putRaw(os, refCount);
+    putRaw(os, requestor);
+    putRaw(os, taskId);
+    putRaw<uint64_t>(os, pc);
+
+    putRaw<uint8_t>(os, replWords.size());
+    for (uint64_t word : replWords) {
+        putRaw(os, word);
+    }
+
+    os.write(reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+void
+Blk::read(std::istream &is, uint32_t blk_size, const std::string &name)
+{
+    index = getRaw<uint64_t>(is, name);
+    tag = getRaw<uint64_t>(is, name);
+    const uint8_t flags = getRaw<uint8_t>(is, name);
+    secure = flags & 0x1;
+    prefetched = flags & 0x2;
+    prefetchedAllocate = flags & 0x4;
+    coherenceBits = getRaw<uint32_t>(is, name);
+    refCount = getRaw<uint32_t>(is, name);
+    requestor = getRaw<uint32_t>(is, name);
+    taskId = getRaw<uint32_t>(is, name);
+    pc = getRaw<uint64_t>(is, name);
+
+    replWords.resize(getRaw<uint8_t>(is, name));
+    for (uint64_t &word : replWords) {
+        word = getRaw<uint64_t>(is, name);
+    }
+
+    data.resize(blk_size);
+    is.read(reinterpret_cast<char *>(data.data()), data.size());
+    fatal_if(!is, "%s: truncated checkpoint of the cache contents\n", name);
+}
+
+} // namespace cache_contents
+} // namespace gem5
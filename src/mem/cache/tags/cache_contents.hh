@@ -0,0 +1,65 @@
+/**
+ * Format of the checkpointed contents of a cache, the side file written
+ * by BaseTags::serializeContents
+ */
+
+#ifndef __MEM_CACHE_TAGS_CACHE_CONTENTS_HH__
+#define __MEM_CACHE_TAGS_CACHE_CONTENTS_HH__
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace cache_contents
+{
+
+/**
+ * Geometry of the tags, followed by numValid blocks. Errors name the
+ * tags being restored.
+ */
+struct Header
+{
+    uint64_t numBlocks = 0;
+    uint32_t blkSize = 0;
+    /** Requestors by name, as their ids depend on registration order */
+    std::vector<std::string> requestors;
+    uint64_t numValid = 0;
+
+    void write(std::ostream &os) const;
+    void read(std::istream &is, const std::string &name);
+};
+
+/** A valid block, with its state, replacement data and data */
+struct Blk
+{
+    /** Index of the block in the tags */
+    uint64_t index = 0;
+    Addr tag = 0;
+    bool secure = false;
+    bool prefetched = false;
+    bool prefetchedAllocate = false;
+    uint32_t coherenceBits = 0;
+    uint32_t refCount = 0;
+    /** Index of the source requestor in the header */
+    uint32_t requestor = 0;
+    uint32_t taskId = 0;
+    Addr pc = 0;
+    /** Words of replacement_policy::Base::saveEntry */
+    std::vector<uint64_t> replWords;
+    std::vector<uint8_t> data;
+
+    void write(std::ostream &os) const;
+    /** Read a block whose data is blk_size bytes */
+    void read(std::istream &is, uint32_t blk_size, const std::string &name);
+};
+
+} // namespace cache_contents
+} // namespace gem5
+
+#endif // __MEM_CACHE_TAGS_CACHE_CONTENTS_HH__
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mem/cache/cache_blk.hh"
+#include "mem/cache/tags/cache_contents.hh"
+
+using namespace gem5;
+using namespace gem5::cache_contents;
+
+namespace
+{
+
+const uint32_t blkSize = 64;
+
+/** A set of a 4-way cache, with the words LRU or BRRIP would save */
+std::vector<Blk>
+makeSet()
+{
+    std::vector<Blk> set(4);
+    for (int way = 0; way < set.size(); way++) {
+        Blk &blk = set[way];
+        blk.index = 4 * 5 + way;
+        blk.tag = 0x1230 + way;
+        blk.taskId = way;
+        blk.data.resize(blkSize);
+        for (int i = 0; i < blkSize; i++) {
+            blk.data[i] = way * blkSize + i;
+        }
+    }
+
+    set[0].coherenceBits = CacheBlk::ReadableBit;
+    set[0].replWords = {123456};
+    set[0].refCount = 3;
+
+    set[1].coherenceBits = CacheBlk::ReadableBit | CacheBlk::WritableBit |
+        CacheBlk::DirtyBit;
+    set[1].secure = true;
+    set[1].requestor = 1;
+    // BRRIP: rrpv and valid
+    set[1].replWords = {2, 1};
+
+    set[2].coherenceBits = CacheBlk::ReadableBit | CacheBlk::WritableBit;
+    set[2].prefetched = true;
+    set[2].prefetchedAllocate = true;
+    set[2].pc = 0x4005b0;
+
+    // no replacement words, the policy does not save its entries
+    set[3].coherenceBits = CacheBlk::ReadableBit | CacheBlk::DirtyBit;
+    return set;
+}
+
+std::string
+writeSet(const std::vector<Blk> &set)
+{
+    Header header;
+    header.numBlocks = 1024;
+    header.blkSize = blkSize;
+    header.requestors = {"system.cpu.dcache.prefetcher", "system.cpu.data"};
+    header.numValid = set.size();
+
+    std::ostringstream os;
+    header.write(os);
+    for (const Blk &blk : set) {
+        blk.write(os);
+    }
+    return os.str();
+}
+
+void
+expectEqual(const Blk &restored, const Blk &saved)
+{
+    EXPECT_EQ(restored.index, saved.index);
+    EXPECT_EQ(restored.tag, saved.tag);
+    EXPECT_EQ(restored.secure, saved.secure);
+    EXPECT_EQ(restored.prefetched, saved.prefetched);
+    EXPECT_EQ(restored.prefetchedAllocate, saved.prefetchedAllocate);
+    EXPECT_EQ(restored.coherenceBits, saved.coherenceBits);
+    EXPECT_EQ(restored.refCount, saved.refCount);
+    EXPECT_EQ(restored.requestor, saved.requestor);
+    EXPECT_EQ(restored.taskId, saved.taskId);
+    EXPECT_EQ(restored.pc, saved.pc);
+    EXPECT_EQ(restored.replWords, saved.replWords);
+    EXPECT_EQ(restored.data, saved.data);
+}
+
+} // anonymous namespace
+
+/** Saving and restoring a set gives back every block as it was */
+TEST(CacheContentsTest, RoundTripSet)
+{
+    const std::vector<Blk> set = makeSet();
+    std::istringstream is(writeSet(set));
+
+    Header header;
+    header.read(is, "test.tags");
+    EXPECT_EQ(header.numBlocks, 1024);
+    EXPECT_EQ(header.blkSize, blkSize);
+    EXPECT_EQ(header.requestors, std::vector<std::string>(
+        {"system.cpu.dcache.prefetcher", "system.cpu.data"}));
+    ASSERT_EQ(header.numValid, set.size());
+
+    for (const Blk &saved : set) {
+        Blk restored;
+        restored.read(is, header.blkSize, "test.tags");
+        expectEqual(restored, saved);
+    }
+    // nothing follows the last block
+    EXPECT_EQ(is.peek(), std::char_traits<char>::eof());
+}
+
+/** A block read over a previous one keeps none of its state */
+TEST(CacheContentsTest, ReuseBlk)
+{
+    const std::vector<Blk> set = makeSet();
+    std::istringstream is(writeSet(set));
+
+    Header header;
+    header.read(is, "test.tags");
+    Blk restored;
+    for (const Blk &saved : set) {
+        restored.read(is, header.blkSize, "test.tags");
+        expectEqual(restored, saved);
+    }
+}
+
+TEST(CacheContentsTest, Truncated)
+{
+    const std::string contents = writeSet(makeSet());
+    std::istringstream is(contents.substr(0, contents.size() - 1));
+
+    Header header;
+    header.read(is, "test.tags");
+    Blk restored;
+    for (int way = 0; way < 3; way++) {
+        restored.read(is, header.blkSize, "test.tags");
+    }
+    ASSERT_ANY_THROW(restored.read(is, header.blkSize, "test.tags"));
+}
+
+TEST(CacheContentsTest, UnknownVersion)
+{
+    std::string contents = writeSet(makeSet());
+    contents[0]++;
+    std::istringstream is(contents);
+
+    Header header;
+    ASSERT_ANY_THROW(header.read(is, "test.tags"));
+}
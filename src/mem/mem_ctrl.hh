@@ -53,7 +53,9 @@
 #include <vector>
 
 #include "base/callback.hh"
+#include "base/free_list.hh"
 #include "base/statistics.hh"
+#include "config/use_mem_pools.hh"
 #include "enums/MemSched.hh"
 #include "mem/qos/mem_ctrl.hh"
 #include "mem/qport.hh"
@@ -213,6 +215,29 @@ class MemPacket
           burstHelper(NULL), _qosValue(_pkt->qosValue())
     { }
 
+#if USE_MEM_POOLS
+    static void *
+    operator new(size_t size)
+    {
+        if (size != sizeof(MemPacket)) {
+            return ::operator new(size);
+        }
+        return FreeList<sizeof(MemPacket), alignof(MemPacket)>::local()
+            .allocate();
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        if (size != sizeof(MemPacket)) {
+            ::operator delete(p);
+        } else {
+            FreeList<sizeof(MemPacket), alignof(MemPacket)>::local()
+                .deallocate(p);
+        }
+    }
+#endif
+
 };
 
 // The memory packets are store in a multiple dequeue structure,
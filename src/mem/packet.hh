@@ -56,11 +56,13 @@
 #include "base/cast.hh"
 #include "base/compiler.hh"
 #include "base/flags.hh"
+#include "base/free_list.hh"
 #include "base/logging.hh"
 #include "base/printable.hh"
 #include "base/types.hh"
 #include "mem/htm.hh"
 #include "mem/request.hh"
+#include "config/use_mem_pools.hh"
 #include "sim/byteswap.hh"
 
 namespace gem5
@@ -1051,6 +1053,28 @@ class Packet : public Printable
         deleteData();
     }
 
+#if USE_MEM_POOLS
+    /** Packets are allocated from the free list of the host thread */
+    static void *
+    operator new(size_t size)
+    {
+        if (size != sizeof(Packet)) {
+            return ::operator new(size);
+        }
+        return FreeList<sizeof(Packet), alignof(Packet)>::local().allocate();
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        if (size != sizeof(Packet)) {
+            ::operator delete(p);
+        } else {
+            FreeList<sizeof(Packet), alignof(Packet)>::local().deallocate(p);
+        }
+    }
+#endif
+
     /**
      * Take a request packet and modify it in place to be suitable for
      * returning as a response to that request.
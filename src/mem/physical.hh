@@ -158,6 +158,11 @@ class PhysicalMemory : public Serializable
 
     long pageSize;
 
+    // Checkpoint the stores in the sparse format, and with how many
+    // host threads
+    const bool sparseCheckpoint;
+    const unsigned checkpointThreads;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -191,7 +196,9 @@ class PhysicalMemory : public Serializable
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
                    const std::string& shared_backstore,
-                   bool auto_unlink_shared_backstore);
+                   bool auto_unlink_shared_backstore,
+                   bool sparse_checkpoint = false,
+                   unsigned checkpoint_threads = 0);
 
     /**
      * Unmap all the backing store we have used.
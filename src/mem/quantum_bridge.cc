@@ -0,0 +1,346 @@
+#include "mem/quantum_bridge.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/QuantumBridge.hh"
+#include "mem/cache/mshr.hh"
+
+namespace gem5
+{
+
+namespace
+{
+
+/**
+ * The MSHR of the cache above which waits for the response to a
+ * request, and is told while the request crosses the bridge
+ */
+MSHR *
+pendingMSHR(PacketPtr pkt)
+{
+    return pkt->needsResponse() ? pkt->findNextSenderState<MSHR>() : nullptr;
+}
+
+} // anonymous namespace
+
+QuantumBridge::QuantumBridge(const Params &p)
+    : SimObject(p),
+      cpuSidePort(p.name + ".cpu_side_port", *this),
+      memSidePort(p.name + ".mem_side_port", *this),
+      cpuSideQueue(getEventQueue(p.cpu_side_eventq_index)),
+      delay(p.delay),
+      reqChannel(*this, eventQueue(), p.name + ".req",
+                 [this](PacketPtr pkt) { return sendTimingReq(pkt); }),
+      snoopRespChannel(*this, eventQueue(), p.name + ".snoop_resp",
+                       [this](PacketPtr pkt) {
+                           return memSidePort.sendTimingSnoopResp(pkt);
+                       }),
+      respChannel(*this, cpuSideQueue, p.name + ".resp",
+                  [this](PacketPtr pkt) {
+                      return cpuSidePort.sendTimingResp(pkt);
+                  })
+{
+}
+
+Port &
+QuantumBridge::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "cpu_side_port")
+        return cpuSidePort;
+    else if (if_name == "mem_side_port")
+        return memSidePort;
+    else
+        return SimObject::getPort(if_name, idx);
+}
+
+void
+QuantumBridge::init()
+{
+    fatal_if(!cpuSidePort.isConnected() || !memSidePort.isConnected(),
+             "Both ports of %s are not connected.", name());
+
+    const auto &p = params();
+    if (cpuSideQueue != eventQueue()) {
+        fatal_if(delay < simQuantum, "The delay of %s (%d) is shorter than "
+                 "the simulation quantum (%d).", name(), delay, simQuantum);
+        fatal_if(memSidePort.isSnooping() &&
+                 p.cpu_side_eventq_index < p.eventq_index,
+                 "The snooping side of %s must have the higher event queue "
+                 "index.", name());
+    }
+
+    cpuSidePort.sendRangeChange();
+}
+
+DrainState
+QuantumBridge::drain()
+{
+    if (reqChannel.empty() && snoopRespChannel.empty() &&
+        respChannel.empty()) {
+        return DrainState::Drained;
+    }
+    return DrainState::Draining;
+}
+
+void
+QuantumBridge::delivered()
+{
+    if (drainState() != DrainState::Draining)
+        return;
+
+    std::lock_guard<std::mutex> lock(drainLock);
+    if (reqChannel.empty() && snoopRespChannel.empty() &&
+        respChannel.empty()) {
+        signalDrainDone();
+    }
+}
+
+bool
+QuantumBridge::sendTimingReq(PacketPtr pkt)
+{
+    MSHR *mshr = pendingMSHR(pkt);
+    if (!mshr)
+        return memSidePort.sendTimingReq(pkt);
+
+    // the MSHR is of a cache of the CPU side, whose queue is entered
+    // to update it, but not to send, as the caches below may snoop the
+    // ones of the CPU side
+    {
+        EventQueue::ScopedEntry enter(cpuSideQueue);
+        mshr->forwardingDownstream();
+    }
+    const bool accepted = memSidePort.sendTimingReq(pkt);
+    EventQueue::ScopedEntry enter(cpuSideQueue);
+    mshr->forwardedDownstream(accepted);
+    return accepted;
+}
+
+bool
+QuantumBridge::trySatisfyFunctional(PacketPtr pkt)
+{
+    pkt->pushLabel(name());
+    const bool done = reqChannel.trySatisfyFunctional(pkt) ||
+        snoopRespChannel.trySatisfyFunctional(pkt) ||
+        respChannel.trySatisfyFunctional(pkt);
+    pkt->popLabel();
+
+    if (done)
+        pkt->makeResponse();
+    return done;
+}
+
+QuantumBridge::Channel::Channel(QuantumBridge &bridge, EventQueue *to,
+                                const std::string &name,
+                                std::function<bool(PacketPtr)> send)
+    : Named(name), bridge(bridge), to(to), send(std::move(send))
+{
+}
+
+void
+QuantumBridge::Channel::push(PacketPtr pkt)
+{
+    // the packet pays for its header and payload on the bridge, and
+    // arrives after the packets pushed before it
+    Tick when = curTick() + bridge.delay + pkt->headerDelay +
+        pkt->payloadDelay;
+    pkt->headerDelay = pkt->payloadDelay = 0;
+
+    inFlight++;
+    {
+        std::lock_guard<std::mutex> lock(crossingLock);
+        when = std::max(when, lastArrival);
+        lastArrival = when;
+        crossing.push_back(pkt);
+    }
+
+    DPRINTF(QuantumBridge, "%s arrives at %d\n", pkt->print(), when);
+
+    // the event of a queue on another thread is inserted at the end
+    // of the quantum, which is before it is due; each event arrives
+    // the oldest crossing packet, so that the order is kept among
+    // events of the same time
+    to->schedule(new EventFunctionWrapper([this]() { arrive(); },
+                                          name(), true), when);
+}
+
+void
+QuantumBridge::Channel::arrive()
+{
+    {
+        std::lock_guard<std::mutex> lock(crossingLock);
+        assert(!crossing.empty());
+        arrived.push_back(crossing.front());
+        crossing.pop_front();
+    }
+
+    if (!waitingRetry)
+        trySend();
+}
+
+bool
+QuantumBridge::Channel::trySatisfyFunctional(PacketPtr pkt)
+{
+    std::lock_guard<std::mutex> lock(crossingLock);
+    for (PacketPtr held : crossing) {
+        if (pkt->trySatisfyFunctional(held))
+            return true;
+    }
+    for (PacketPtr held : arrived) {
+        if (pkt->trySatisfyFunctional(held))
+            return true;
+    }
+    return false;
+}
+
+void
+QuantumBridge::Channel::retry()
+{
+    waitingRetry = false;
+    trySend();
+}
+
+void
+QuantumBridge::Channel::trySend()
+{
+    while (!arrived.empty()) {
+        PacketPtr pkt = arrived.front();
+        if (!send(pkt)) {
+            DPRINTF(QuantumBridge, "%s waits for a retry\n", pkt->print());
+            waitingRetry = true;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(crossingLock);
+            arrived.pop_front();
+        }
+        inFlight--;
+        bridge.delivered();
+    }
+}
+
+QuantumBridge::CpuSidePort::CpuSidePort(const std::string &name,
+                                        QuantumBridge &bridge)
+    : ResponsePort(name, &bridge), bridge(bridge)
+{
+}
+
+AddrRangeList
+QuantumBridge::CpuSidePort::getAddrRanges() const
+{
+    return bridge.memSidePort.getAddrRanges();
+}
+
+bool
+QuantumBridge::CpuSidePort::recvTimingReq(PacketPtr pkt)
+{
+    // like a cache buffering the request, snoops are ordered before
+    // it until it is forwarded (see MSHR::handleSnoop)
+    if (MSHR *mshr = pendingMSHR(pkt))
+        mshr->setDownstreamPending();
+
+    bridge.reqChannel.push(pkt);
+    return true;
+}
+
+bool
+QuantumBridge::CpuSidePort::recvTimingSnoopResp(PacketPtr pkt)
+{
+    bridge.snoopRespChannel.push(pkt);
+    return true;
+}
+
+void
+QuantumBridge::CpuSidePort::recvRespRetry()
+{
+    bridge.respChannel.retry();
+}
+
+Tick
+QuantumBridge::CpuSidePort::recvAtomic(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(bridge.eventQueue());
+    return bridge.memSidePort.sendAtomic(pkt);
+}
+
+Tick
+QuantumBridge::CpuSidePort::recvAtomicBackdoor(PacketPtr pkt,
+                                               MemBackdoorPtr &backdoor)
+{
+    // a backdoor would bypass the queue of the memory side
+    return recvAtomic(pkt);
+}
+
+void
+QuantumBridge::CpuSidePort::recvFunctional(PacketPtr pkt)
+{
+    if (bridge.trySatisfyFunctional(pkt))
+        return;
+
+    EventQueue::ScopedMigration migrate(bridge.eventQueue());
+    bridge.memSidePort.sendFunctional(pkt);
+}
+
+QuantumBridge::MemSidePort::MemSidePort(const std::string &name,
+                                        QuantumBridge &bridge)
+    : RequestPort(name, &bridge), bridge(bridge)
+{
+}
+
+bool
+QuantumBridge::MemSidePort::isSnooping() const
+{
+    return bridge.cpuSidePort.isSnooping();
+}
+
+bool
+QuantumBridge::MemSidePort::recvTimingResp(PacketPtr pkt)
+{
+    bridge.respChannel.push(pkt);
+    return true;
+}
+
+void
+QuantumBridge::MemSidePort::recvReqRetry()
+{
+    bridge.reqChannel.retry();
+}
+
+void
+QuantumBridge::MemSidePort::recvTimingSnoopReq(PacketPtr pkt)
+{
+    EventQueue::ScopedEntry enter(bridge.cpuSideQueue);
+    bridge.cpuSidePort.sendTimingSnoopReq(pkt);
+}
+
+void
+QuantumBridge::MemSidePort::recvRetrySnoopResp()
+{
+    bridge.snoopRespChannel.retry();
+}
+
+Tick
+QuantumBridge::MemSidePort::recvAtomicSnoop(PacketPtr pkt)
+{
+    EventQueue::ScopedEntry enter(bridge.cpuSideQueue);
+    return bridge.cpuSidePort.sendAtomicSnoop(pkt);
+}
+
+void
+QuantumBridge::MemSidePort::recvFunctionalSnoop(PacketPtr pkt)
+{
+    if (bridge.trySatisfyFunctional(pkt))
+        return;
+
+    EventQueue::ScopedEntry enter(bridge.cpuSideQueue);
+    bridge.cpuSidePort.sendFunctionalSnoop(pkt);
+}
+
+void
+QuantumBridge::MemSidePort::recvRangeChange()
+{
+    bridge.cpuSidePort.sendRangeChange();
+}
+
+} // namespace gem5
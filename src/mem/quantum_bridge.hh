@@ -0,0 +1,190 @@
+/**
+ * Bridge between partitions of the memory system on different event
+ * queues, synchronized by the simulation quantum
+ */
+
+#ifndef __MEM_QUANTUM_BRIDGE_HH__
+#define __MEM_QUANTUM_BRIDGE_HH__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "base/named.hh"
+#include "mem/port.hh"
+#include "params/QuantumBridge.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+namespace gem5
+{
+
+/**
+ * A QuantumBridge connects a requestor on one event queue, e.g. the L1
+ * caches of a core, to a responder on another, e.g. the crossbar of
+ * the shared caches, for a simulation in which the queues run on
+ * separate host threads.
+ *
+ * Timing requests, responses and snoop responses cross the bridge as
+ * events on the queue of the receiving side, scheduled the bridge
+ * delay into the future. As the delay is at least the simulation
+ * quantum, the events are inserted at the end of the current quantum,
+ * and a side never sees a packet of the other side before its own
+ * time. Each direction is a FIFO with unbounded buffering, the bridge
+ * only holds packets back when the receiving port asks for a retry.
+ *
+ * Express snoops from the responder side are delivered without delay,
+ * by entering the queue of the requestor side, as the coherence
+ * protocol needs their outcome at once. The requestor side must thus
+ * have a higher event queue index than the responder side (see
+ * EventQueue::ScopedEntry). Atomic and functional accesses migrate to
+ * the queue of the other side like a ThreadBridge, functional ones once
+ * checked against the packets crossing like a Bridge.
+ *
+ * When both sides are on the same queue, the bridge is a plain
+ * latency, which gives the single queue reference timing of a
+ * partitioned system.
+ */
+class QuantumBridge : public SimObject
+{
+  public:
+    PARAMS(QuantumBridge);
+    QuantumBridge(const Params &p);
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+    void init() override;
+
+    DrainState drain() override;
+
+  private:
+    class CpuSidePort : public ResponsePort
+    {
+      public:
+        CpuSidePort(const std::string &name, QuantumBridge &bridge);
+
+      protected:
+        AddrRangeList getAddrRanges() const override;
+
+        bool recvTimingReq(PacketPtr pkt) override;
+        bool recvTimingSnoopResp(PacketPtr pkt) override;
+        bool tryTiming(PacketPtr pkt) override { return true; }
+        void recvRespRetry() override;
+
+        Tick recvAtomic(PacketPtr pkt) override;
+        Tick recvAtomicBackdoor(PacketPtr pkt,
+                                MemBackdoorPtr &backdoor) override;
+        void recvFunctional(PacketPtr pkt) override;
+
+      private:
+        QuantumBridge &bridge;
+    };
+
+    class MemSidePort : public RequestPort
+    {
+      public:
+        MemSidePort(const std::string &name, QuantumBridge &bridge);
+
+        bool isSnooping() const override;
+
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+        void recvReqRetry() override;
+        void recvTimingSnoopReq(PacketPtr pkt) override;
+        void recvRetrySnoopResp() override;
+
+        Tick recvAtomicSnoop(PacketPtr pkt) override;
+        void recvFunctionalSnoop(PacketPtr pkt) override;
+
+        void recvRangeChange() override;
+
+      private:
+        QuantumBridge &bridge;
+    };
+
+    /** Packets crossing in one direction, and in the same order */
+    class Channel : public Named
+    {
+      public:
+        /**
+         * @param to Event queue of the receiving side
+         * @param send Send a packet to the receiving port, false if it
+         *             asks for a retry
+         */
+        Channel(QuantumBridge &bridge, EventQueue *to,
+                const std::string &name,
+                std::function<bool(PacketPtr)> send);
+
+        /** Send a packet to the other side, called by the sender */
+        void push(PacketPtr pkt);
+
+        /** The receiving port is ready again after a retry */
+        void retry();
+
+        /** No packet is crossing or waiting for a retry */
+        bool empty() const { return inFlight == 0; }
+
+        /** Check a functional access against the packets held */
+        bool trySatisfyFunctional(PacketPtr pkt);
+
+      private:
+        /** A packet arrived on the receiving side */
+        void arrive();
+
+        /** Send the arrived packets until a retry is asked for */
+        void trySend();
+
+        QuantumBridge &bridge;
+        EventQueue *const to;
+        const std::function<bool(PacketPtr)> send;
+
+        /**
+         * Packets in the order they were pushed, to be arrived; the lock
+         * also guards the arrived packets against functional accesses
+         * from the sending side
+         */
+        std::mutex crossingLock;
+        std::deque<PacketPtr> crossing;
+        /** Arrival time of the last packet, they arrive in order */
+        Tick lastArrival = 0;
+
+        /** Arrived packets, sent by the receiving side only */
+        std::deque<PacketPtr> arrived;
+        bool waitingRetry = false;
+
+        std::atomic<uint64_t> inFlight{0};
+    };
+
+    /** A packet was delivered, which may complete a drain */
+    void delivered();
+
+    /** Send a request, which may be pending in the caches above */
+    bool sendTimingReq(PacketPtr pkt);
+
+    /** Check a functional access against the packets of all channels */
+    bool trySatisfyFunctional(PacketPtr pkt);
+
+    CpuSidePort cpuSidePort;
+    MemSidePort memSidePort;
+
+    /** Queue of the requestor side, the bridge is on the responder's */
+    EventQueue *const cpuSideQueue;
+
+    /** Latency of a packet crossing the bridge */
+    const Tick delay;
+
+    /** Requests and responses crossing the bridge */
+    Channel reqChannel;
+    Channel snoopRespChannel;
+    Channel respChannel;
+
+    /** The channels of both sides complete a drain only once */
+    std::mutex drainLock;
+};
+
+} // namespace gem5
+
+#endif // __MEM_QUANTUM_BRIDGE_HH__
@@ -54,12 +54,15 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/amo.hh"
 #include "base/compiler.hh"
 #include "base/flags.hh"
+#include "base/free_list.hh"
 #include "base/types.hh"
+#include "config/use_mem_pools.hh"
 #include "cpu/inst_seq.hh"
 #include "mem/htm.hh"
 #include "sim/cur_tick.hh"
@@ -522,6 +525,23 @@ class Request
 
     ~Request() {}
 
+    /**
+     * Create a request, like std::make_shared. With USE_MEM_POOLS, the
+     * request and its reference count are allocated from the free list
+     * of the host thread, as requests are created for every access.
+     */
+    template <typename... Args>
+    static RequestPtr
+    create(Args&&... args)
+    {
+#if USE_MEM_POOLS
+        return std::allocate_shared<Request>(FreeListAllocator<Request>(),
+                                             std::forward<Args>(args)...);
+#else
+        return std::make_shared<Request>(std::forward<Args>(args)...);
+#endif
+    }
+
     /**
      * Factory method for creating memory management requests, with
      * unspecified addr and size.
@@ -529,7 +549,7 @@ class Request
     static RequestPtr
     createMemManagement(Flags flags, RequestorID id)
     {
-        auto mgmt_req = std::make_shared<Request>();
+        auto mgmt_req = create();
         mgmt_req->_flags.set(flags);
         mgmt_req->_requestorId = id;
         mgmt_req->_time = curTick();
@@ -611,8 +631,8 @@ class Request
         assert(hasVaddr());
         assert(!hasPaddr());
         assert(split_addr > _vaddr && split_addr < _vaddr + _size);
-        req1 = std::make_shared<Request>(*this);
-        req2 = std::make_shared<Request>(*this);
+        req1 = create(*this);
+        req2 = create(*this);
         req1->_size = split_addr - _vaddr;
         req2->_vaddr = split_addr;
         req2->_size = _size - req1->_size;
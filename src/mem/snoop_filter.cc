@@ -42,6 +42,9 @@
 
 #include "mem/snoop_filter.hh"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/SnoopFilter.hh"
@@ -414,4 +417,62 @@ SnoopFilter::regStats()
     SimObject::regStats();
 }
 
+void
+SnoopFilter::serialize(CheckpointOut &cp) const
+{
+    if (!checkpointContents) {
+        return;
+    }
+
+    // one (line, holder) pair per holder, lines sorted so the same state
+    // always gives the same checkpoint
+    std::vector<Addr> lines;
+    lines.reserve(cachedLocations.size());
+    for (const auto &entry : cachedLocations) {
+        lines.push_back(entry.first);
+    }
+    std::sort(lines.begin(), lines.end());
+
+    std::vector<Addr> line_addrs;
+    std::vector<unsigned> line_holders;
+    for (Addr line : lines) {
+        const SnoopItem &sf_item = cachedLocations.at(line);
+        panic_if(sf_item.requested.any(), "%s: line %#x is still requested, "
+                 "the system must be drained\n", name(), line);
+        for (unsigned i = 0; i < cpuSidePorts.size(); i++) {
+            if (sf_item.holder[i]) {
+                line_addrs.push_back(line);
+                line_holders.push_back(i);
+            }
+        }
+    }
+    SERIALIZE_CONTAINER(line_addrs);
+    SERIALIZE_CONTAINER(line_holders);
+}
+
+void
+SnoopFilter::unserialize(CheckpointIn &cp)
+{
+    if (!checkpointContents ||
+        !cp.entryExists(Serializable::currentSection(), "line_addrs")) {
+        return;
+    }
+
+    std::vector<Addr> line_addrs;
+    std::vector<unsigned> line_holders;
+    UNSERIALIZE_CONTAINER(line_addrs);
+    UNSERIALIZE_CONTAINER(line_holders);
+    fatal_if(line_addrs.size() != line_holders.size(),
+             "%s: inconsistent checkpoint of the tracked lines\n", name());
+
+    cachedLocations.clear();
+    for (size_t i = 0; i < line_addrs.size(); i++) {
+        fatal_if(line_holders[i] >= cpuSidePorts.size(), "%s: the "
+                 "checkpoint has more snooping ports than the crossbar\n",
+                 name());
+        cachedLocations[line_addrs[i]].holder.set(line_holders[i]);
+    }
+    reqLookupResult.it = cachedLocations.end();
+}
+
 } // namespace gem5
@@ -99,6 +99,7 @@ class SnoopFilter : public SimObject
         SimObject(p), reqLookupResult(cachedLocations.end()),
         linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
         maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
+        checkpointContents(p.checkpoint_contents),
         stats(this)
     {
     }
@@ -202,6 +203,15 @@ class SnoopFilter : public SimObject
 
     virtual void regStats();
 
+    /**
+     * The lines tracked by the filter are only checkpointed when
+     * checkpointContents is set, to go with caches that checkpoint
+     * their contents. Otherwise those caches restore empty, and so
+     * does the filter.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
   protected:
 
     /**
@@ -307,6 +317,8 @@ class SnoopFilter : public SimObject
     const Cycles lookupLatency;
     /** Max capacity in terms of cache blocks tracked, for sanity checking */
     const unsigned maxEntryCount;
+    /** Whether the tracked lines are saved in checkpoints */
+    const bool checkpointContents;
 
     /**
      * Use the lower bits of the address to keep track of the line status
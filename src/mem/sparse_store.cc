@@ -0,0 +1,442 @@
+/**
+ * Sparse, chunked checkpoint format of memory backing stores
+ */
+
+#include "mem/sparse_store.hh"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace sparse_store
+{
+
+namespace
+{
+
+constexpr char HeaderMagic[8] = {'g', 'e', 'm', '5', 's', 'p', 'm', 0};
+constexpr char TrailerMagic[8] = {'g', 'e', 'm', '5', 's', 'p', 'i', 0};
+constexpr uint32_t Version = 1;
+
+constexpr uint64_t ChunkBytes = uint64_t(PageBytes) * ChunkPages;
+constexpr unsigned BitmapWords = ChunkPages / 64;
+static_assert(ChunkPages % 64 == 0, "Chunk bitmaps are made of words");
+
+enum Codec : uint32_t { Raw = 0, Zlib = 1 };
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pageBytes;
+    uint32_t chunkPages;
+    uint32_t reserved;
+    uint64_t storeSize;
+};
+
+struct IndexEntry
+{
+    uint64_t chunk;
+    /** Offset of the stored data in the file */
+    uint64_t offset;
+    /** Bytes of the stored data */
+    uint64_t storedBytes;
+    /** Bytes of the non-zero pages of the chunk */
+    uint64_t rawBytes;
+    uint32_t codec;
+    uint32_t numPages;
+    /** Non-zero pages of the chunk */
+    uint64_t bitmap[BitmapWords];
+};
+
+struct Trailer
+{
+    uint64_t numEntries;
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+/** Chunk being encoded by a writer thread */
+struct EncodedChunk
+{
+    IndexEntry entry;
+    /** Data to write, into pmem, raw or compressed */
+    const uint8_t *data;
+    /** Non-zero pages gathered back to back */
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> compressed;
+};
+
+unsigned
+hostThreads(unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max(threads, 1u);
+}
+
+/**
+ * Run fn(i, worker) for i in [0, n) on up to threads host threads,
+ * worker being the index of the thread running it.
+ */
+template <typename Fn>
+void
+parallelFor(uint64_t n, unsigned threads, Fn &&fn)
+{
+    threads = std::min<uint64_t>(threads, n);
+    if (threads <= 1) {
+        for (uint64_t i = 0; i < n; i++) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    std::atomic<uint64_t> next(0);
+    auto work = [&](unsigned worker) {
+        for (uint64_t i = next++; i < n; i = next++) {
+            fn(i, worker);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned worker = 1; worker < threads; worker++) {
+        pool.emplace_back(work, worker);
+    }
+    work(0);
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+bool
+pageIsZero(const uint8_t *page, uint64_t bytes)
+{
+    uint64_t word;
+    uint64_t i = 0;
+    for (; i + sizeof(word) <= bytes; i += sizeof(word)) {
+        std::memcpy(&word, page + i, sizeof(word));
+        if (word != 0) {
+            return false;
+        }
+    }
+    for (; i < bytes; i++) {
+        if (page[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Bytes of a page of a chunk, the last page of a store may be short */
+uint64_t
+pageSize(uint64_t chunk_offset, uint32_t page, uint64_t size)
+{
+    const uint64_t start = chunk_offset + uint64_t(page) * PageBytes;
+    return start >= size ? 0 : std::min<uint64_t>(PageBytes, size - start);
+}
+
+void
+writeAll(int fd, const void *buf, uint64_t bytes, const std::string &path)
+{
+    const uint8_t *ptr = static_cast<const uint8_t *>(buf);
+    while (bytes > 0) {
+        ssize_t written = ::write(fd, ptr, std::min<uint64_t>(bytes, 1 << 30));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        fatal_if(written <= 0, "Write failed on memory checkpoint file "
+                 "'%s': %s\n", path, strerror(errno));
+        ptr += written;
+        bytes -= written;
+    }
+}
+
+/** Read bytes at offset, false on error or end of file */
+bool
+readAt(int fd, void *buf, uint64_t bytes, uint64_t offset)
+{
+    uint8_t *ptr = static_cast<uint8_t *>(buf);
+    while (bytes > 0) {
+        ssize_t got = ::pread(fd, ptr, std::min<uint64_t>(bytes, 1 << 30),
+                              offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        ptr += got;
+        bytes -= got;
+        offset += got;
+    }
+    return true;
+}
+
+void
+encodeChunk(EncodedChunk &enc, uint64_t chunk, const uint8_t *pmem,
+            uint64_t size)
+{
+    IndexEntry &entry = enc.entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.chunk = chunk;
+
+    const uint64_t chunk_offset = chunk * ChunkBytes;
+    const uint8_t *base = pmem + chunk_offset;
+    [[maybe_unused]] const uint64_t chunk_bytes =
+        std::min(ChunkBytes, size - chunk_offset);
+    uint32_t pages = 0;
+    for (uint32_t page = 0; page < ChunkPages; page++) {
+        const uint64_t bytes = pageSize(chunk_offset, page, size);
+        if (bytes == 0) {
+            break;
+        }
+        pages++;
+        if (!pageIsZero(base + uint64_t(page) * PageBytes, bytes)) {
+            entry.bitmap[page / 64] |= uint64_t(1) << (page % 64);
+            entry.numPages++;
+            entry.rawBytes += bytes;
+        }
+    }
+    if (entry.numPages == 0) {
+        return;
+    }
+
+    // a full chunk is compressed in place, others are gathered first
+    const uint8_t *raw = base;
+    if (entry.numPages != pages) {
+        enc.raw.resize(entry.rawBytes);
+        uint64_t pos = 0;
+        for (uint32_t page = 0; page < pages; page++) {
+            if (entry.bitmap[page / 64] & (uint64_t(1) << (page % 64))) {
+                const uint64_t bytes = pageSize(chunk_offset, page, size);
+                std::memcpy(enc.raw.data() + pos,
+                            base + uint64_t(page) * PageBytes, bytes);
+                pos += bytes;
+            }
+        }
+        raw = enc.raw.data();
+    } else {
+        assert(entry.rawBytes == chunk_bytes);
+    }
+
+    uLongf compressed_bytes = compressBound(entry.rawBytes);
+    enc.compressed.resize(compressed_bytes);
+    if (compress2(enc.compressed.data(), &compressed_bytes, raw,
+                  entry.rawBytes, Z_BEST_SPEED) == Z_OK &&
+        compressed_bytes < entry.rawBytes) {
+        entry.codec = Zlib;
+        entry.storedBytes = compressed_bytes;
+        enc.data = enc.compressed.data();
+    } else {
+        entry.codec = Raw;
+        entry.storedBytes = entry.rawBytes;
+        enc.data = raw;
+    }
+}
+
+} // anonymous namespace
+
+void
+write(const std::string &path, const uint8_t *pmem, uint64_t size,
+      unsigned threads)
+{
+    threads = hostThreads(threads);
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    fatal_if(fd < 0, "Can't open memory checkpoint file '%s': %s\n", path,
+             strerror(errno));
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, HeaderMagic, sizeof(header.magic));
+    header.version = Version;
+    header.pageBytes = PageBytes;
+    header.chunkPages = ChunkPages;
+    header.storeSize = size;
+    writeAll(fd, &header, sizeof(header), path);
+    uint64_t offset = sizeof(header);
+
+    // chunks are encoded a window at a time and written in order, so
+    // the memory used does not grow with the store
+    const uint64_t num_chunks = (size + ChunkBytes - 1) / ChunkBytes;
+    const uint64_t window = uint64_t(threads) * 4;
+    std::vector<EncodedChunk> encoded(std::min(window, num_chunks));
+    std::vector<IndexEntry> index;
+
+    for (uint64_t first = 0; first < num_chunks; first += window) {
+        const uint64_t count = std::min(window, num_chunks - first);
+        parallelFor(count, threads, [&](uint64_t i, unsigned) {
+            encodeChunk(encoded[i], first + i, pmem, size);
+        });
+        for (uint64_t i = 0; i < count; i++) {
+            EncodedChunk &enc = encoded[i];
+            if (enc.entry.numPages == 0) {
+                continue;
+            }
+            enc.entry.offset = offset;
+            writeAll(fd, enc.data, enc.entry.storedBytes, path);
+            offset += enc.entry.storedBytes;
+            index.push_back(enc.entry);
+        }
+    }
+
+    Trailer trailer;
+    std::memset(&trailer, 0, sizeof(trailer));
+    trailer.numEntries = index.size();
+    trailer.indexOffset = offset;
+    std::memcpy(trailer.magic, TrailerMagic, sizeof(trailer.magic));
+    writeAll(fd, index.data(), index.size() * sizeof(IndexEntry), path);
+    writeAll(fd, &trailer, sizeof(trailer), path);
+
+    fatal_if(::close(fd) != 0, "Close failed on memory checkpoint file "
+             "'%s'\n", path);
+}
+
+void
+read(const std::string &path, uint8_t *pmem, uint64_t size,
+     unsigned threads)
+{
+    threads = hostThreads(threads);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Can't open memory checkpoint file '%s': %s\n", path,
+             strerror(errno));
+
+    struct stat st;
+    fatal_if(fstat(fd, &st) != 0, "Can't stat memory checkpoint file "
+             "'%s'\n", path);
+    const uint64_t file_size = st.st_size;
+
+    Header header;
+    Trailer trailer;
+    fatal_if(file_size < sizeof(header) + sizeof(trailer) ||
+             !readAt(fd, &header, sizeof(header), 0) ||
+             !readAt(fd, &trailer, sizeof(trailer),
+                     file_size - sizeof(trailer)) ||
+             std::memcmp(header.magic, HeaderMagic, sizeof(header.magic)) ||
+             std::memcmp(trailer.magic, TrailerMagic, sizeof(trailer.magic)),
+             "'%s' is not a sparse memory checkpoint file\n", path);
+    fatal_if(header.version != Version || header.pageBytes != PageBytes ||
+             header.chunkPages != ChunkPages,
+             "Memory checkpoint file '%s' has an unsupported version %d\n",
+             path, header.version);
+    fatal_if(header.storeSize != size, "Memory checkpoint file '%s' holds "
+             "%lld bytes, expected %lld\n", path, header.storeSize, size);
+
+    const uint64_t num_chunks = (size + ChunkBytes - 1) / ChunkBytes;
+    std::vector<IndexEntry> index(trailer.numEntries);
+    fatal_if(trailer.numEntries > num_chunks ||
+             trailer.indexOffset + trailer.numEntries * sizeof(IndexEntry) +
+             sizeof(trailer) != file_size ||
+             !readAt(fd, index.data(), index.size() * sizeof(IndexEntry),
+                     trailer.indexOffset),
+             "Corrupt index in memory checkpoint file '%s'\n", path);
+
+    // per thread buffers
+    std::vector<std::vector<uint8_t>> raw_bufs(threads);
+    std::vector<std::vector<uint8_t>> stored_bufs(threads);
+
+    std::mutex error_lock;
+    std::string error;
+    auto fail = [&](const IndexEntry &entry, const char *what) {
+        std::lock_guard<std::mutex> guard(error_lock);
+        if (error.empty()) {
+            error = csprintf("chunk %d: %s", entry.chunk, what);
+        }
+    };
+
+    parallelFor(index.size(), threads, [&](uint64_t i, unsigned worker) {
+        const IndexEntry &entry = index[i];
+        if (entry.chunk >= num_chunks ||
+            entry.offset + entry.storedBytes > trailer.indexOffset) {
+            fail(entry, "out of bounds");
+            return;
+        }
+
+        const uint64_t chunk_offset = entry.chunk * ChunkBytes;
+        uint8_t *base = pmem + chunk_offset;
+        const uint64_t chunk_bytes =
+            std::min(ChunkBytes, size - chunk_offset);
+        if (entry.rawBytes > chunk_bytes) {
+            fail(entry, "too many pages");
+            return;
+        }
+        // all the pages present, the data is the chunk itself
+        const bool full = entry.rawBytes == chunk_bytes;
+
+        uint8_t *raw = base;
+        if (!full) {
+            raw_bufs[worker].resize(entry.rawBytes);
+            raw = raw_bufs[worker].data();
+        }
+
+        if (entry.codec == Raw) {
+            if (entry.storedBytes != entry.rawBytes ||
+                !readAt(fd, raw, entry.storedBytes, entry.offset)) {
+                fail(entry, "short read");
+                return;
+            }
+        } else if (entry.codec == Zlib) {
+            std::vector<uint8_t> &stored = stored_bufs[worker];
+            stored.resize(entry.storedBytes);
+            uLongf raw_bytes = entry.rawBytes;
+            if (!readAt(fd, stored.data(), entry.storedBytes, entry.offset)) {
+                fail(entry, "short read");
+                return;
+            }
+            if (uncompress(raw, &raw_bytes, stored.data(),
+                           entry.storedBytes) != Z_OK ||
+                raw_bytes != entry.rawBytes) {
+                fail(entry, "bad compressed data");
+                return;
+            }
+        } else {
+            fail(entry, "unknown codec");
+            return;
+        }
+
+        if (full) {
+            return;
+        }
+
+        // scatter the non-zero pages, the others stay untouched
+        uint64_t pos = 0;
+        for (uint32_t page = 0; page < ChunkPages; page++) {
+            if (!(entry.bitmap[page / 64] & (uint64_t(1) << (page % 64)))) {
+                continue;
+            }
+            const uint64_t bytes = pageSize(chunk_offset, page, size);
+            if (bytes == 0 || pos + bytes > entry.rawBytes) {
+                fail(entry, "bitmap does not match the data");
+                return;
+            }
+            std::memcpy(base + uint64_t(page) * PageBytes, raw + pos, bytes);
+            pos += bytes;
+        }
+    });
+
+    ::close(fd);
+    fatal_if(!error.empty(), "Corrupt memory checkpoint file '%s', %s\n",
+             path, error);
+}
+
+} // namespace sparse_store
+} // namespace memory
+} // namespace gem5
@@ -0,0 +1,70 @@
+/**
+ * Sparse, chunked checkpoint format of memory backing stores
+ */
+
+#ifndef __MEM_SPARSE_STORE_HH__
+#define __MEM_SPARSE_STORE_HH__
+
+#include <cstdint>
+#include <string>
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * Checkpoint file of a backing store which only holds its non-zero
+ * pages, so mostly empty memories are saved and restored quickly.
+ *
+ * The store is cut in chunks of ChunkPages pages. Each chunk with a
+ * non-zero page is stored on its own: its non-zero pages, back to back,
+ * compressed with zlib at its fastest level, or raw if that does not
+ * shrink them. An index at the end of the file gives the offset,
+ * codec and page bitmap of every stored chunk.
+ *
+ * Chunks are independent, so they are compressed and decompressed by
+ * several host threads. Raw chunks whose pages are all present are
+ * read straight into the store.
+ *
+ * Layout, in host byte order:
+ *   header:  magic, version, page size, chunk pages, store size
+ *   chunks:  the stored data of each non-empty chunk
+ *   index:   one IndexEntry per non-empty chunk, by chunk number
+ *   trailer: number of entries, offset of the index, magic
+ */
+namespace sparse_store
+{
+
+/** Bytes of a page, the unit of zero elimination */
+constexpr uint32_t PageBytes = 4096;
+/** Pages of a chunk, the unit of compression */
+constexpr uint32_t ChunkPages = 256;
+
+/**
+ * Write the contents of a store.
+ * @param path file to write
+ * @param pmem host memory of the store
+ * @param size bytes of the store
+ * @param threads host threads to compress with, 0 for all the cores
+ */
+void write(const std::string &path, const uint8_t *pmem, uint64_t size,
+           unsigned threads);
+
+/**
+ * Read the contents of a store written by write(). Pages which are not
+ * in the file are left untouched, i.e. zero in a fresh store.
+ * @param path file to read
+ * @param pmem host memory of the store
+ * @param size bytes of the store, which must match the file
+ * @param threads host threads to decompress with, 0 for all the cores
+ */
+void read(const std::string &path, uint8_t *pmem, uint64_t size,
+          unsigned threads);
+
+} // namespace sparse_store
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_SPARSE_STORE_HH__
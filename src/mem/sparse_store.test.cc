@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/sparse_store.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+namespace
+{
+
+class SparseStoreTest : public testing::Test
+{
+  protected:
+    std::string path;
+
+    void
+    SetUp() override
+    {
+        char name[] = "/tmp/sparse_store.test.XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = name;
+    }
+
+    void TearDown() override { unlink(path.c_str()); }
+
+    void
+    roundTrip(const std::vector<uint8_t> &store, unsigned threads)
+    {
+        sparse_store::write(path, store.data(), store.size(), threads);
+        std::vector<uint8_t> restored(store.size(), 0);
+        sparse_store::read(path, restored.data(), restored.size(),
+                           threads);
+        ASSERT_EQ(store, restored);
+    }
+};
+
+} // anonymous namespace
+
+/** A store of zeros only takes a header, trailer and no index */
+TEST_F(SparseStoreTest, Empty)
+{
+    std::vector<uint8_t> store(4 << 20, 0);
+    roundTrip(store, 4);
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, 0, SEEK_END);
+    EXPECT_LT(std::ftell(file), 128);
+    std::fclose(file);
+}
+
+/**
+ * A mix of zero, compressible and random pages, with a chunk whose
+ * pages are all present and a short last chunk and page.
+ */
+TEST_F(SparseStoreTest, Sparse)
+{
+    const uint64_t chunk = uint64_t(sparse_store::PageBytes) *
+        sparse_store::ChunkPages;
+    std::vector<uint8_t> store(3 * chunk + 5 * sparse_store::PageBytes + 100);
+    std::mt19937 rng(42);
+
+    // all the pages of the first chunk, half of them random
+    for (uint64_t i = 0; i < chunk; i++) {
+        store[i] = (i / sparse_store::PageBytes) % 2 ? rng() : i % 7;
+    }
+    // a few pages of the third chunk
+    for (uint64_t i = 0; i < 64; i++) {
+        store[2 * chunk + 3 * sparse_store::PageBytes + i] = i + 1;
+        store[2 * chunk + 200 * sparse_store::PageBytes + i] = rng();
+    }
+    // the last bytes of the short last page
+    store[store.size() - 1] = 0xff;
+    store[store.size() - 100] = 0x11;
+
+    roundTrip(store, 1);
+    roundTrip(store, 4);
+}
+
+/** Random data is stored raw and read straight into the store */
+TEST_F(SparseStoreTest, Incompressible)
+{
+    std::vector<uint8_t> store(2 * sparse_store::PageBytes *
+                               sparse_store::ChunkPages);
+    std::mt19937 rng(7);
+    for (auto &byte : store) {
+        byte = rng() | 1;
+    }
+    roundTrip(store, 0);
+}
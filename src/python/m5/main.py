@@ -143,6 +143,15 @@ def parse_options():
         help="Port (e.g., gdb) listener mode (auto: Enable if running "
         "interactively) [Default: %default]",
     )
+    option(
+        "--event-queue",
+        metavar="{list,calendar}",
+        choices=("list", "calendar"),
+        default="list",
+        help="Event queue backend, a sorted list of time/priority bins or "
+        "a calendar queue, faster with thousands of pending events. Both "
+        "service events in the same order [Default: %default]",
+    )
     option(
         "--allow-remote-connections",
         action="store_true",
@@ -519,6 +528,8 @@ def main():
     if not options.allow_remote_connections:
         m5.listenersLoopbackOnly()
 
+    event.setMainQueueCalendar(options.event_queue == "calendar")
+
     for when in options.debug_break:
         debug.schedBreak(int(when))
 
@@ -104,6 +104,17 @@ class System(SimObject):
         "shmem segment file upon destruction. This is used only if "
         "shared_backstore is non-empty.",
     )
+    sparse_memory_checkpoints = Param.Bool(
+        True,
+        "Checkpoint memories in the sparse, chunked format, which skips "
+        "zero pages and is written and read by several host threads. "
+        "Checkpoints in the gzip format are still restored.",
+    )
+    memory_checkpoint_threads = Param.Unsigned(
+        0,
+        "Host threads compressing and decompressing memory checkpoints, "
+        "0 for all the host cores",
+    )
 
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
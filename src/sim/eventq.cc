@@ -30,6 +30,7 @@
 
 #include "sim/eventq.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <mutex>
@@ -37,6 +38,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
@@ -58,18 +60,37 @@ std::vector<EventQueue *> mainEventQueue;
 __thread EventQueue *_curEventQueue = NULL;
 bool inParallelMode = false;
 
+namespace
+{
+
+/** Backend of the main event queues */
+bool mainQueueCalendar = false;
+
+} // anonymous namespace
+
 EventQueue *
 getEventQueue(uint32_t index)
 {
     while (numMainEventQueues <= index) {
+        mainEventQueue.push_back(new EventQueue(
+            csprintf("MainEventQueue-%d", numMainEventQueues),
+            numMainEventQueues));
         numMainEventQueues++;
-        mainEventQueue.push_back(
-            new EventQueue(csprintf("MainEventQueue-%d", index)));
+        mainEventQueue.back()->setCalendar(mainQueueCalendar);
     }
 
     return mainEventQueue[index];
 }
 
+void
+setMainQueueCalendar(bool enable)
+{
+    mainQueueCalendar = enable;
+    for (uint32_t i = 0; i < numMainEventQueues; ++i) {
+        mainEventQueue[i]->setCalendar(enable);
+    }
+}
+
 #ifndef NDEBUG
 Counter Event::instanceCounter = 0;
 #endif
@@ -111,6 +132,11 @@ Event::insertBefore(Event *event, Event *curr)
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        calendarInsert(event);
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
@@ -170,6 +196,11 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        calendarRemove(event);
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -202,7 +233,17 @@ EventQueue::serviceOne()
     Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
-    if (next) {
+    if (calendar) {
+        // the head is the first bin of its bucket
+        Event *&bucket = buckets[bucketOf(event->when())];
+        assert(bucket == event);
+        bucket = Event::removeItem(event, event);
+        if (next) {
+            head = next;
+        } else {
+            calendarBinRemoved(event->when());
+        }
+    } else if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
 
@@ -295,15 +336,11 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
-            Event *nextInBin = nextBin;
+        for (Event *nextInBin : bins()) {
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -316,11 +353,35 @@ EventQueue::debugVerify() const
     std::unordered_map<long, bool> map;
 
     Tick time = 0;
-    short priority = 0;
+    Event::Priority priority = Event::Minimum_Pri;
+
+    if (calendar) {
+        size_t num_bins = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            for (Event *bin = buckets[i]; bin; bin = bin->nextBin) {
+                if (bucketOf(bin->when()) != i) {
+                    cprintf("event in the wrong bucket!");
+                    bin->dump();
+                    return false;
+                } else if (bin->nextBin && *bin->nextBin <= *bin) {
+                    cprintf("bucket not sorted!");
+                    bin->dump();
+                    return false;
+                } else if (*bin < *head) {
+                    cprintf("event before the head!");
+                    bin->dump();
+                    return false;
+                }
+                num_bins++;
+            }
+        }
+        if (num_bins != numBins) {
+            cprintf("%d bins in the buckets, expected %d", num_bins, numBins);
+            return false;
+        }
+    }
 
-    Event *nextBin = head;
-    while (nextBin) {
-        Event *nextInBin = nextBin;
+    for (Event *nextInBin : bins()) {
         while (nextInBin) {
             if (nextInBin->when() < time) {
                 cprintf("time goes backwards!");
@@ -345,8 +406,6 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
@@ -355,9 +414,204 @@ EventQueue::debugVerify() const
 Event*
 EventQueue::replaceHead(Event* s)
 {
-    Event* t = head;
-    head = s;
-    return t;
+    if (!calendar) {
+        Event* t = head;
+        head = s;
+        return t;
+    }
+
+    // hand the bins over as the list of the default backend
+    std::vector<Event *> old_bins = bins();
+    std::vector<Event *> new_bins;
+    for (Event *bin = s; bin; bin = bin->nextBin) {
+        new_bins.push_back(bin);
+    }
+    for (size_t i = 0; i < old_bins.size(); ++i) {
+        old_bins[i]->nextBin =
+            i + 1 < old_bins.size() ? old_bins[i + 1] : nullptr;
+    }
+    calendarBuild(new_bins, buckets.size());
+    return old_bins.empty() ? nullptr : old_bins.front();
+}
+
+std::vector<Event *>
+EventQueue::bins() const
+{
+    std::vector<Event *> sorted_bins;
+    if (!calendar) {
+        for (Event *bin = head; bin; bin = bin->nextBin) {
+            sorted_bins.push_back(bin);
+        }
+        return sorted_bins;
+    }
+
+    sorted_bins.reserve(numBins);
+    for (Event *bucket : buckets) {
+        for (Event *bin = bucket; bin; bin = bin->nextBin) {
+            sorted_bins.push_back(bin);
+        }
+    }
+    std::sort(sorted_bins.begin(), sorted_bins.end(),
+              [](const Event *l, const Event *r) { return *l < *r; });
+    return sorted_bins;
+}
+
+void
+EventQueue::setCalendar(bool enable)
+{
+    if (enable == calendar) {
+        return;
+    }
+
+    std::vector<Event *> sorted_bins = bins();
+    calendar = enable;
+    if (calendar) {
+        calendarBuild(sorted_bins, std::max(MinBuckets,
+            size_t(1) << ceilLog2(std::max<size_t>(sorted_bins.size(), 1))));
+    } else {
+        for (size_t i = 0; i < sorted_bins.size(); ++i) {
+            sorted_bins[i]->nextBin =
+                i + 1 < sorted_bins.size() ? sorted_bins[i + 1] : nullptr;
+        }
+        head = sorted_bins.empty() ? nullptr : sorted_bins.front();
+        buckets.clear();
+        numBins = 0;
+    }
+}
+
+void
+EventQueue::calendarInsert(Event *event)
+{
+    // the same as insert() in the list of the bucket
+    Event *&bucket = buckets[bucketOf(event->when())];
+    if (!bucket || *event <= *bucket) {
+        bucket = Event::insertBefore(event, bucket);
+    } else {
+        Event *prev = bucket;
+        Event *curr = bucket->nextBin;
+        while (curr && *curr < *event) {
+            prev = curr;
+            curr = curr->nextBin;
+        }
+        prev->nextBin = Event::insertBefore(event, curr);
+    }
+
+    // an event on top of the head's bin is serviced first as well
+    if (!head || *event <= *head) {
+        head = event;
+    }
+
+    if (!event->nextInBin && ++numBins > 2 * buckets.size()) {
+        calendarBuild(bins(), 2 * buckets.size());
+    }
+}
+
+void
+EventQueue::calendarRemove(Event *event)
+{
+    Event *&bucket = buckets[bucketOf(event->when())];
+    if (!bucket)
+        panic("event not found!");
+
+    Event *top;
+    if (*bucket == *event) {
+        top = bucket;
+        bucket = Event::removeItem(event, bucket);
+    } else {
+        Event *prev = bucket;
+        Event *curr = bucket->nextBin;
+        while (curr && *curr < *event) {
+            prev = curr;
+            curr = curr->nextBin;
+        }
+
+        if (!curr || *curr != *event)
+            panic("event not found!");
+
+        top = curr;
+        prev->nextBin = Event::removeItem(event, curr);
+    }
+
+    if (top == event && !event->nextInBin) {
+        if (event == head) {
+            calendarBinRemoved(event->when());
+        } else {
+            numBins--;
+        }
+    } else if (event == head) {
+        head = event->nextInBin;
+    }
+}
+
+void
+EventQueue::calendarBinRemoved(Tick when)
+{
+    numBins--;
+    if (buckets.size() > MinBuckets && numBins < buckets.size() / 2) {
+        calendarBuild(bins(), buckets.size() / 2);
+    } else {
+        calendarFindHead(when);
+    }
+}
+
+void
+EventQueue::calendarFindHead(Tick when)
+{
+    if (numBins == 0) {
+        head = nullptr;
+        return;
+    }
+
+    // the first bin of a bucket is its earliest, so the first one in
+    // its day is the earliest of the queue
+    Tick day = when >> calendarShift;
+    for (size_t i = 0; i < buckets.size(); ++i, ++day) {
+        Event *first = buckets[day & (buckets.size() - 1)];
+        if (first && (first->when() >> calendarShift) == day) {
+            head = first;
+            return;
+        }
+    }
+
+    // every bin is at least a year away, the buckets are too narrow
+    calendarBuild(bins(), buckets.size());
+}
+
+void
+EventQueue::calendarBuild(const std::vector<Event *> &sorted_bins,
+                          size_t num_buckets)
+{
+    // the median of the gaps between the first times is robust to the
+    // few events scheduled far ahead, e.g. to dump the statistics
+    std::vector<Tick> gaps;
+    for (size_t i = 1; i < sorted_bins.size() && gaps.size() < 64; ++i) {
+        Tick gap = sorted_bins[i]->when() - sorted_bins[i - 1]->when();
+        if (gap != 0) {
+            gaps.push_back(gap);
+        }
+    }
+    if (!gaps.empty()) {
+        std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2,
+                         gaps.end());
+        Tick width = gaps[gaps.size() / 2];
+        calendarShift = std::min(
+            ceilLog2(std::min<Tick>(width, MaxTick / 3) * 3), 62);
+    }
+
+    buckets.assign(num_buckets, nullptr);
+    std::vector<Event *> tails(num_buckets, nullptr);
+    for (Event *bin : sorted_bins) {
+        size_t i = bucketOf(bin->when());
+        bin->nextBin = nullptr;
+        if (tails[i]) {
+            tails[i]->nextBin = bin;
+        } else {
+            buckets[i] = bin;
+        }
+        tails[i] = bin;
+    }
+    numBins = sorted_bins.size();
+    head = sorted_bins.empty() ? nullptr : sorted_bins.front();
 }
 
 void
@@ -415,8 +669,9 @@ Event::dump() const
     }
 }
 
-EventQueue::EventQueue(const std::string &n)
-    : objName(n), head(NULL), _curTick(0)
+EventQueue::EventQueue(const std::string &n, uint32_t index)
+    : objName(n), index(index), head(NULL), _curTick(0), calendar(false),
+      calendarShift(10), numBins(0)
 {
 }
 
@@ -43,9 +43,11 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/debug.hh"
 #include "base/flags.hh"
+#include "base/logging.hh"
 #include "base/types.hh"
 #include "base/uncontended_mutex.hh"
 #include "debug/Event.hh"
@@ -625,9 +627,61 @@ class EventQueue
     friend void curEventQueue(EventQueue *);
 
     std::string objName;
+    /** Index of a main event queue, see getEventQueue() */
+    const uint32_t index;
     Event *head;
     Tick _curTick;
 
+    /**
+     * Calendar queue backend, see setCalendar(). The bins are spread
+     * over buckets of 2^calendarShift ticks by their time, and each
+     * bucket is a list of bins chained by nextBin and sorted like the
+     * single list of the default backend. head is the first event to
+     * service with either backend, so both service the events in the
+     * same order.
+     */
+    bool calendar;
+    std::vector<Event *> buckets;
+    unsigned calendarShift;
+    /** Bins in the buckets */
+    size_t numBins;
+
+    /** Fewest buckets of the calendar */
+    static constexpr size_t MinBuckets = 16;
+
+    size_t
+    bucketOf(Tick when) const
+    {
+        return (when >> calendarShift) & (buckets.size() - 1);
+    }
+
+    /**
+     * The top events of the bins, in the order they are serviced. They
+     * are the events of the bin list of the default backend, and are
+     * sorted from the buckets of the calendar.
+     */
+    std::vector<Event *> bins() const;
+
+    void calendarInsert(Event *event);
+    void calendarRemove(Event *event);
+
+    /** Remove the bin of the head when its last event is serviced */
+    void calendarBinRemoved(Tick when);
+
+    /**
+     * Find the new head, the first bin of the first non-empty day from
+     * the day of when, which is before every queued event. Rebuilds
+     * the calendar if no bin is less than a year of buckets away.
+     */
+    void calendarFindHead(Tick when);
+
+    /**
+     * Link sorted bins into num_buckets buckets, which are three times
+     * as wide as the median gap between the first bins.
+     */
+    void calendarBuild(const std::vector<Event *> &sorted_bins,
+                       size_t num_buckets);
+
     //! Mutex to protect async queue.
     UncontendedMutex async_queue_mutex;
 
@@ -742,10 +796,56 @@ class EventQueue
         EventQueue &eq;
     };
 
+    class ScopedEntry
+    {
+      public:
+        /**
+         * Temporarily execute in a different event queue while keeping
+         * the current one locked.
+         *
+         * Unlike ScopedMigration, no other thread can enter the current
+         * queue meanwhile, so the caller may be in the middle of an
+         * operation, e.g. a crossbar of the shared memory system
+         * delivering an express snoop to the caches of a core. To
+         * avoid deadlocks, a thread must only enter queues of a higher
+         * index than the ones it holds: the shared queue 0 enters the
+         * core queues, and never the opposite.
+         *
+         * ScopedEntry does nothing if both eqs are the same
+         *
+         * @ingroup api_eventq
+         */
+        ScopedEntry(EventQueue *_new_eq)
+            : new_eq(*_new_eq), old_eq(*curEventQueue()),
+              doEnter(&new_eq != &old_eq)
+        {
+            if (doEnter) {
+                panic_if(new_eq.getIndex() <= old_eq.getIndex(),
+                         "%s enters %s of a lower index.", old_eq.name(),
+                         new_eq.name());
+                new_eq.lock();
+                curEventQueue(&new_eq);
+            }
+        }
+
+        ~ScopedEntry()
+        {
+            if (doEnter) {
+                curEventQueue(&old_eq);
+                new_eq.unlock();
+            }
+        }
+
+      private:
+        EventQueue &new_eq;
+        EventQueue &old_eq;
+        bool doEnter;
+    };
+
     /**
      * @ingroup api_eventq
      */
-    EventQueue(const std::string &n);
+    EventQueue(const std::string &n, uint32_t index=0);
 
     /**
      * @ingroup api_eventq
@@ -755,6 +855,8 @@ class EventQueue
     void name(const std::string &st) { objName = st; }
     /** @}*/ //end of api_eventq group
 
+    uint32_t getIndex() const { return index; }
+
     /**
      * Schedule the given event on this queue. Safe to call from any thread.
      *
@@ -939,6 +1041,17 @@ class EventQueue
      */
     Event* replaceHead(Event* s);
 
+    /**
+     * Select the calendar queue backend, or the default one, a list of
+     * bins sorted by time and priority. Insertion walks the list of
+     * bins in the default backend, and the list of one bucket in the
+     * calendar, which scales better with thousands of pending events.
+     * Both service events in the same order. The queued events are
+     * moved to the new backend.
+     */
+    void setCalendar(bool enable);
+    bool isCalendar() const { return calendar; }
+
     /**@{*/
     /**
      * Provide an interface for locking/unlocking the event queue.
@@ -984,6 +1097,12 @@ curEventQueue(EventQueue *q)
 
 void dumpMainQueue();
 
+/**
+ * Select the backend of the main event queues, including the ones
+ * created later, see EventQueue::setCalendar().
+ */
+void setMainQueueCalendar(bool enable);
+
 class EventManager
 {
   protected:
@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sim/eventq.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** Logs the order it is serviced in */
+class LogEvent : public Event
+{
+  public:
+    int id;
+    std::vector<std::pair<int, Tick>> *log;
+
+    LogEvent(int _id, Priority prio,
+             std::vector<std::pair<int, Tick>> *_log)
+        : Event(prio), id(_id), log(_log)
+    {}
+
+    void process() override { log->emplace_back(id, when()); }
+};
+
+/**
+ * Schedule, deschedule, reschedule and service events at random, with
+ * many events in the same bins, and return the order they are serviced
+ * in. The same seed gives the same operations if the queue services
+ * the events in the same order.
+ */
+std::vector<std::pair<int, Tick>>
+randomTrace(bool calendar, unsigned seed, int ops, bool toggle = false)
+{
+    std::vector<std::pair<int, Tick>> log;
+    std::vector<std::unique_ptr<LogEvent>> events;
+    EventQueue eq("eq");
+    eq.setCalendar(calendar);
+
+    std::mt19937 rng(seed);
+    const Event::Priority prios[] = {
+        Event::Minimum_Pri, Event::Default_Pri, Event::CPU_Tick_Pri,
+        Event::Maximum_Pri };
+    for (int i = 0; i < 512; i++) {
+        events.emplace_back(new LogEvent(i, prios[rng() % 4], &log));
+    }
+
+    auto delay = [&]() -> Tick {
+        switch (rng() % 8) {
+          case 0: return 0;
+          case 1: return 1;
+          case 7: return 1000000 + rng() % 100000000;
+          default: return 500 * (rng() % 64);
+        }
+    };
+
+    for (int op = 0; op < ops; op++) {
+        LogEvent *event = events[rng() % events.size()].get();
+        switch (rng() % 5) {
+          case 0:
+          case 1:
+            if (!event->scheduled()) {
+                eq.schedule(event, eq.getCurTick() + delay());
+            }
+            break;
+          case 2:
+            if (event->scheduled()) {
+                eq.deschedule(event);
+            }
+            break;
+          case 3:
+            eq.reschedule(event, eq.getCurTick() + delay(), true);
+            break;
+          default:
+            if (!eq.empty()) {
+                eq.serviceOne();
+            }
+            break;
+        }
+        if (toggle && op % 1000 == 0) {
+            eq.setCalendar(!eq.isCalendar());
+        }
+        if (op % 997 == 0) {
+            EXPECT_TRUE(eq.debugVerify());
+        }
+    }
+    while (!eq.empty()) {
+        eq.serviceOne();
+    }
+    return log;
+}
+
+} // anonymous namespace
+
+/** Events of the same time and priority are serviced last in first out */
+TEST(EventQueueTest, SameBinOrder)
+{
+    for (bool calendar : {false, true}) {
+        std::vector<std::pair<int, Tick>> log;
+        LogEvent a(0, Event::Default_Pri, &log);
+        LogEvent b(1, Event::Default_Pri, &log);
+        LogEvent c(2, Event::Minimum_Pri, &log);
+        LogEvent d(3, Event::Default_Pri, &log);
+        EventQueue eq("eq");
+        eq.setCalendar(calendar);
+        eq.schedule(&a, 100);
+        eq.schedule(&b, 100);
+        eq.schedule(&c, 100);
+        eq.schedule(&d, 50);
+        while (!eq.empty()) {
+            eq.serviceOne();
+        }
+        std::vector<std::pair<int, Tick>> expected = {
+            {3, 50}, {2, 100}, {1, 100}, {0, 100} };
+        EXPECT_EQ(log, expected);
+    }
+}
+
+/** The calendar services events in the same order as the list */
+TEST(EventQueueTest, CalendarSameOrder)
+{
+    for (unsigned seed = 0; seed < 8; seed++) {
+        auto list = randomTrace(false, seed, 20000);
+        EXPECT_EQ(list, randomTrace(true, seed, 20000));
+        EXPECT_EQ(list, randomTrace(true, seed, 20000, true));
+    }
+}
+
+/** The head can be swapped out and back, as Ruby does to warm up */
+TEST(EventQueueTest, CalendarReplaceHead)
+{
+    std::vector<std::pair<int, Tick>> log;
+    LogEvent a(0, Event::Default_Pri, &log);
+    LogEvent b(1, Event::Default_Pri, &log);
+    LogEvent c(2, Event::Default_Pri, &log);
+    EventQueue eq("eq");
+    eq.setCalendar(true);
+    eq.schedule(&a, 100);
+    eq.schedule(&b, 1000000000);
+
+    Event *saved = eq.replaceHead(nullptr);
+    EXPECT_TRUE(eq.empty());
+    eq.schedule(&c, 10);
+    eq.serviceOne();
+    EXPECT_TRUE(eq.empty());
+
+    eq.replaceHead(saved);
+    EXPECT_TRUE(eq.debugVerify());
+    while (!eq.empty()) {
+        eq.serviceOne();
+    }
+    std::vector<std::pair<int, Tick>> expected = {
+        {2, 10}, {0, 100}, {1, 1000000000} };
+    EXPECT_EQ(log, expected);
+}
+
+namespace
+{
+
+class BenchEvent : public Event
+{
+  public:
+    void process() override {}
+};
+
+/**
+ * Service time of a workload with both backends. The workload is a
+ * trace of a simulation run with --debug-flags=Event given in the
+ * EVENTQ_TRACE environment variable, or else a synthetic multicore
+ * pattern: cores and caches ticking every cycle, and thousands of
+ * memory responses pending tens of ns ahead.
+ */
+template <typename Workload>
+void
+benchmark(const char *name, Workload &&workload)
+{
+    for (bool calendar : {false, true}) {
+        EventQueue eq("eq");
+        eq.setCalendar(calendar);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ops = workload(eq);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << name << (calendar ? " calendar: " : " list: ")
+                  << elapsed.count() * 1e9 / ops << " ns/op, " << ops
+                  << " ops" << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+TEST(EventQueueBench, DISABLED_Synthetic)
+{
+    const int cores = 16;
+    const int pending = 4096;
+    const Tick cycle = 400;
+    const uint64_t ops = 20000000;
+
+    benchmark("synthetic", [&](EventQueue &eq) {
+        std::mt19937 rng(1);
+        uint64_t done = 0;
+        std::vector<std::unique_ptr<EventFunctionWrapper>> ticks, mem;
+
+        // cores and caches tick every cycle, at two priorities
+        for (int i = 0; i < cores * 4; i++) {
+            EventFunctionWrapper *event = new EventFunctionWrapper(
+                [&, i]() {
+                    done++;
+                    eq.schedule(ticks[i].get(), eq.getCurTick() + cycle);
+                }, "tick", false,
+                i % 2 ? Event::CPU_Tick_Pri : Event::Default_Pri);
+            ticks.emplace_back(event);
+            eq.schedule(event, cycle);
+        }
+        // responses come back 20 to 220 cycles later, and some are
+        // squashed and reissued
+        auto latency = [&]() { return cycle * (20 + rng() % 200); };
+        for (int i = 0; i < pending; i++) {
+            EventFunctionWrapper *event = new EventFunctionWrapper(
+                [&, i]() {
+                    done++;
+                    eq.schedule(mem[i].get(), eq.getCurTick() + latency());
+                    if (rng() % 16 == 0) {
+                        eq.reschedule(mem[rng() % pending].get(),
+                                      eq.getCurTick() + latency(), true);
+                    }
+                }, "mem");
+            mem.emplace_back(event);
+            eq.schedule(event, latency());
+        }
+
+        while (done < ops) {
+            eq.serviceOne();
+        }
+        while (!eq.empty()) {
+            eq.deschedule(eq.getHead());
+        }
+        return done;
+    });
+}
+
+TEST(EventQueueBench, DISABLED_Trace)
+{
+    const char *path = std::getenv("EVENTQ_TRACE");
+    if (!path) {
+        GTEST_SKIP() << "EVENTQ_TRACE is not set";
+    }
+
+    // lines are "<tick>: <object>: <description> <instance> <action> @
+    // <when>", priorities are not traced
+    struct Op { int event; char action; Tick when; };
+    std::vector<Op> trace;
+    std::unordered_map<std::string, int> instances;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream words(line);
+        std::vector<std::string> tokens;
+        for (std::string word; words >> word;) {
+            tokens.push_back(word);
+        }
+        if (tokens.size() < 4 || tokens[tokens.size() - 2] != "@") {
+            continue;
+        }
+        const std::string &action = tokens[tokens.size() - 3];
+        if (action != "scheduled" && action != "rescheduled" &&
+            action != "descheduled" && action != "executed") {
+            continue;
+        }
+        auto it = instances.emplace(tokens[tokens.size() - 4],
+                                    instances.size()).first;
+        trace.push_back({it->second, action == "rescheduled" ? 'r' :
+                         action[0], std::stoull(tokens.back())});
+    }
+    ASSERT_FALSE(trace.empty());
+
+    benchmark("trace", [&](EventQueue &eq) {
+        std::vector<std::unique_ptr<BenchEvent>> events;
+        for (size_t i = 0; i < instances.size(); i++) {
+            events.emplace_back(new BenchEvent());
+        }
+        for (const Op &op : trace) {
+            BenchEvent *event = events[op.event].get();
+            switch (op.action) {
+              case 's':
+              case 'r':
+                eq.reschedule(event, std::max(op.when, eq.getCurTick()),
+                              true);
+                break;
+              case 'd':
+                if (event->scheduled()) {
+                    eq.deschedule(event);
+                }
+                break;
+              default:
+                if (!eq.empty()) {
+                    eq.serviceOne();
+                }
+                break;
+            }
+        }
+        while (!eq.empty()) {
+            eq.deschedule(eq.getHead());
+        }
+        return trace.size();
+    });
+}